@@ -3080,6 +3080,10 @@ void LiveUI::UpdateRendererInspectionModal()
          ImGui::Text("Max: %4.1fms (over last second), %4.1fms", 1e-3 * m_player->m_script_max, 1e-3 * g_frameProfiler.GetMax(FrameProfiler::PROFILE_SCRIPT)); ImGui::TableNextRow();
          PROF_ROW("> Misc", FrameProfiler::PROFILE_MISC); ImGui::TableNextRow();
          PROF_ROW("> Sleep", FrameProfiler::PROFILE_SLEEP); ImGui::TableNextRow();
+         PROF_ROW("> Audio", FrameProfiler::PROFILE_AUDIO); ImGui::TableNextColumn();
+         ImGui::Text("Plays: %u (%4.1f average), Voices: %u (%u max), Stolen: %u (%u max)", g_frameProfiler.GetPrev(FrameProfiler::PROFILE_AUDIO_PLAYS), g_frameProfiler.GetAvg(FrameProfiler::PROFILE_AUDIO_PLAYS),
+            g_frameProfiler.GetPrev(FrameProfiler::PROFILE_AUDIO_VOICES), g_frameProfiler.GetMax(FrameProfiler::PROFILE_AUDIO_VOICES),
+            g_frameProfiler.GetPrev(FrameProfiler::PROFILE_AUDIO_STEALS), g_frameProfiler.GetMax(FrameProfiler::PROFILE_AUDIO_STEALS)); ImGui::TableNextRow();
          #ifdef DEBUG
          PROF_ROW("> Debug #1", FrameProfiler::PROFILE_CUSTOM1); ImGui::TableNextRow();
          PROF_ROW("> Debug #2", FrameProfiler::PROFILE_CUSTOM2); ImGui::TableNextRow();
@@ -3110,6 +3114,10 @@ void LiveUI::UpdateRendererInspectionModal()
          ImGui::TableNextColumn(); ImGui::Text("%s", info);
          PROF_ROW("Input to Script lag", FrameProfiler::PROFILE_INPUT_POLL_PERIOD, "")
          PROF_ROW("Input to Present lag", FrameProfiler::PROFILE_INPUT_TO_PRESENT, "Use PresentMon for Present to Display lag")
+         if (g_pvp->m_ps.GetMixer())
+         {
+            PROF_ROW("Sound Play to Output lag", FrameProfiler::PROFILE_AUDIO_LATENCY, "Software mixer, includes output buffering")
+         }
          #undef PROF_ROW
          ImGui::EndTable();
          ImGui::NewLine();
@@ -3118,6 +3126,19 @@ void LiveUI::UpdateRendererInspectionModal()
 	   ImGui::Text("Press F11 to reset min/max/average timings");
 	   if (ImGui::IsKeyPressed(dikToImGuiKeys[m_player->m_rgKeys[eFrameCount]]))
 		   m_player->InitFPS();
+
+      // Capture next frame to a file, replaying it to get per pass/command GPU timings
+      static int capture_replays = 10;
+      ImGui::SetNextItemWidth(100.f * m_dpi);
+      if (ImGui::InputInt("Replays", &capture_replays))
+         capture_replays = clamp(capture_replays, 1, 1000);
+      ImGui::SameLine();
+      if (ImGui::Button("Capture Frame"))
+      {
+         const string dir = g_pvp->m_szMyPrefPath + "Cache" + PATH_SEPARATOR_CHAR + m_table->m_szTitle + PATH_SEPARATOR_CHAR;
+         std::filesystem::create_directories(std::filesystem::path(dir));
+         m_rd->CaptureNextFrame(dir + "frame_capture.txt", capture_replays);
+      }
 	   
       // Other detailed information
       ImGui::Text("%s", m_player->GetPerfInfo().c_str());
@@ -3833,19 +3833,13 @@ bool Collection::LoadToken(const int id, BiffReader * const pbr)
       WCHAR wzT[MAXNAMEBUFFER*2];
       pbr->GetWideString(wzT, MAXNAMEBUFFER*2); //!! rather truncate for these special cases for the comparison below?
 
-      for (size_t i = 0; i < ppt->m_vedit.size(); ++i)
+      IEditable * const pedit = ppt->GetElementByName(MakeString(wzT).c_str());
+      IScriptable * const piscript = pedit ? pedit->GetScriptable() : nullptr;
+      if (piscript) // skip decals
       {
-         IScriptable * const piscript = ppt->m_vedit[i]->GetScriptable();
-         if (piscript) // skip decals
-         {
-            if (!WideStrCmp(piscript->m_wzName, wzT))
-            {
-               piscript->GetISelect()->GetIEditable()->m_vCollection.push_back(this);
-               piscript->GetISelect()->GetIEditable()->m_viCollection.push_back(m_visel.size());
-               m_visel.push_back(piscript->GetISelect());
-               return true;
-            }
-         }
+         piscript->GetISelect()->GetIEditable()->m_vCollection.push_back(this);
+         piscript->GetISelect()->GetIEditable()->m_viCollection.push_back(m_visel.size());
+         m_visel.push_back(piscript->GetISelect());
       }
       break;
    }
@@ -209,6 +209,7 @@ void DrawingOrderDialog::UpdateDrawingOrder(IEditable *ptr, bool up)
          ListView_SetItemState(hOrderList, idx - 1, LVIS_FOCUSED, LVIS_FOCUSED);
          ::SetFocus(hOrderList);
          pt->SetNonUndoableDirty(eSaveDirty);
+         pt->InvalidateElementNameMap(); // drawing order changes the first part found for duplicate names
          if (m_drawingOrderSelect)
          {
             ISelect * const psel = pt->m_vmultisel.ElementAt(idx);
@@ -252,6 +253,7 @@ void DrawingOrderDialog::UpdateDrawingOrder(IEditable *ptr, bool up)
    else
    {
       pt->SetNonUndoableDirty(eSaveDirty);
+      pt->InvalidateElementNameMap();
       if (m_drawingOrderSelect)
       {
          if (idx < pt->m_vmultisel.size() - 1)
@@ -6,6 +6,7 @@
 #define AFX_DRAGPOINT_H__E0C074C9_5BF2_4F8C_8012_76082BAC2203__INCLUDED_
 
 #include "resource.h"       // main symbols
+#include <mutex>
 
 class IHaveDragPoints;
 
@@ -152,6 +153,36 @@ public:
 protected:
    template <typename T>
    void GetRgVertex(vector<T> &vv, const bool loop = true, const float accuracy = 4.f) const // 4 = maximum precision that we allow for
+   {
+      CurveCache<T> &cache = GetCurveCache((const T *)nullptr);
+      const std::lock_guard<std::mutex> lock(cache.m_mutex);
+      if (!cache.IsValidFor(m_vdpoint))
+      {
+         cache.m_controlPoints.clear();
+         for (const CComObject<DragPoint> *const pdp : m_vdpoint)
+            cache.m_controlPoints.push_back({ pdp->m_v, pdp->m_smooth, pdp->m_slingshot });
+         cache.m_entries.clear();
+      }
+      for (const typename CurveCache<T>::Entry &entry : cache.m_entries)
+         if (entry.m_loop == loop && entry.m_accuracy == accuracy)
+         {
+            vv.insert(vv.end(), entry.m_vertices.begin(), entry.m_vertices.end());
+            return;
+         }
+
+      if (cache.m_entries.size() >= CURVE_CACHE_SIZE)
+         cache.m_entries.erase(cache.m_entries.begin());
+      cache.m_entries.push_back({ loop, accuracy });
+      vector<T> &tessellation = cache.m_entries.back().m_vertices;
+      TessellateCurve(tessellation, loop, accuracy);
+      vv.insert(vv.end(), tessellation.begin(), tessellation.end());
+   }
+
+   vector< CComObject<DragPoint>* > m_vdpoint;
+
+private:
+   template <typename T>
+   void TessellateCurve(vector<T> &vv, const bool loop, const float accuracy) const
    {
       static const int Dim = T::Dim;    // for now, this is always 2 or 3
 
@@ -208,7 +239,52 @@ protected:
       }
    }
 
-   vector< CComObject<DragPoint>* > m_vdpoint;
+   // The tessellated curves are requested many times for the same control points (hit shapes, mesh generation, bounds, surface
+   // heights, editor paint), so keep the last ones, validated against a copy of the control points they were computed from.
+   // Locked since surface heights may be queried from the concurrent hit shape generation.
+   static constexpr size_t CURVE_CACHE_SIZE = 4; // different accuracies/loop modes kept per vertex type
+
+   struct CurveControlPoint
+   {
+      Vertex3Ds m_v;
+      bool m_smooth;
+      bool m_slingshot;
+   };
+
+   template <typename T>
+   struct CurveCache
+   {
+      struct Entry
+      {
+         bool m_loop;
+         float m_accuracy;
+         vector<T> m_vertices;
+      };
+
+      bool IsValidFor(const vector< CComObject<DragPoint>* > &vdpoint) const
+      {
+         if (m_controlPoints.size() != vdpoint.size())
+            return false;
+         for (size_t i = 0; i < vdpoint.size(); i++)
+         {
+            const CurveControlPoint &cp = m_controlPoints[i];
+            const DragPoint *const pdp = vdpoint[i];
+            if (cp.m_v.x != pdp->m_v.x || cp.m_v.y != pdp->m_v.y || cp.m_v.z != pdp->m_v.z || cp.m_smooth != pdp->m_smooth || cp.m_slingshot != pdp->m_slingshot)
+               return false;
+         }
+         return true;
+      }
+
+      std::mutex m_mutex;
+      vector<CurveControlPoint> m_controlPoints;
+      vector<Entry> m_entries;
+   };
+
+   CurveCache<RenderVertex> &GetCurveCache(const RenderVertex *) const { return m_curveCache2D; }
+   CurveCache<RenderVertex3D> &GetCurveCache(const RenderVertex3D *) const { return m_curveCache3D; }
+
+   mutable CurveCache<RenderVertex> m_curveCache2D;
+   mutable CurveCache<RenderVertex3D> m_curveCache3D;
 };
 
 //
@@ -84,7 +84,7 @@ public:
       {
          if (*pp != nullptr)
          {
-            g_frameProfiler.EnterScriptSection(dispid);
+            g_frameProfiler.EnterScriptSection(dispid, pT->m_wzName);
             IDispatch* const pDispatch = reinterpret_cast<IDispatch*>(*pp);
             pDispatch->Invoke(dispid, IID_NULL, LOCALE_USER_DEFAULT, DISPATCH_METHOD, pdispparams, nullptr, nullptr, nullptr);
             g_frameProfiler.ExitScriptSection();
@@ -26,6 +26,7 @@ void IEditable::ClearForOverwrite()
 void IEditable::Delete()
 {
    RemoveFromVectorSingle(GetPTable()->m_vedit, (IEditable *)this);
+   GetPTable()->InvalidateElementNameMap();
    MarkForDelete();
 
    if (GetScriptable())
@@ -41,6 +42,7 @@ void IEditable::Delete()
 void IEditable::Uncreate()
 {
    RemoveFromVectorSingle(GetPTable()->m_vedit, (IEditable *)this);
+   GetPTable()->InvalidateElementNameMap();
    if (GetScriptable())
       GetPTable()->m_pcv->RemoveItem(GetScriptable());
 }
@@ -53,28 +55,13 @@ HRESULT IEditable::put_TimerEnabled(VARIANT_BOOL newVal, BOOL *pte)
 
    if (val != *pte && m_phittimer)
    {
-       // to avoid problems with timers dis/enabling themselves, store all the changes in a list
-       bool found = false;
-       for (size_t i = 0; i < g_pplayer->m_changed_vht.size(); ++i)
-           if (g_pplayer->m_changed_vht[i].m_timer == m_phittimer)
-           {
-               g_pplayer->m_changed_vht[i].m_enabled = !!val;
-               found = true;
-               break;
-           }
-
-       if (!found)
-       {
-         TimerOnOff too;
-         too.m_enabled = !!val;
-         too.m_timer = m_phittimer;
-         g_pplayer->m_changed_vht.push_back(too);
-       }
-
        if (val)
            m_phittimer->m_nextfire = g_pplayer->m_time_msec + m_phittimer->m_interval;
        else
-           m_phittimer->m_nextfire = 0xFFFFFFFF; // fakes the disabling of the timer, until it will be catched by the cleanup via m_changed_vht
+           m_phittimer->m_nextfire = 0xFFFFFFFF; // fakes the disabling of the timer, until the change is applied by the scheduler
+
+       // to avoid problems with timers dis/enabling themselves, the change is only applied before the next timer update
+       g_pplayer->m_timers.SetEnabled(m_phittimer, !!val);
    }
 
    *pte = val;
@@ -94,6 +81,7 @@ HRESULT IEditable::put_TimerInterval(long newVal, int *pti)
    {
       m_phittimer->m_interval = newVal >= 0 ? max(newVal, (long)MAX_TIMER_MSEC_INTERVAL) : max(-2l, newVal);
       m_phittimer->m_nextfire = g_pplayer->m_time_msec + m_phittimer->m_interval;
+      g_pplayer->m_timers.Reschedule(m_phittimer);
    }
 
    STOPUNDO
@@ -232,6 +220,7 @@ void IEditable::SetName(const string& name)
     // first update name in the codeview before updating it in the element itself
     pt->m_pcv->ReplaceName(GetScriptable(), namePtr);
     lstrcpynW(GetScriptable()->m_wzName, namePtr, sizeof(GetScriptable()->m_wzName)/sizeof(GetScriptable()->m_wzName[0]));
+    pt->InvalidateElementNameMap();
     g_pvp->GetLayersListDialog()->UpdateElement(this);
     g_pvp->SetPropSel(GetPTable()->m_vmultisel);
 
@@ -148,6 +148,7 @@ void ISelect::DoCommand(int icmd, int x, int y)
       PinTable * const ptable = GetPTable();
       RemoveFromVectorSingle(ptable->m_vedit, piedit);
       ptable->m_vedit.push_back(piedit);
+      ptable->InvalidateElementNameMap();
       ptable->SetDirtyDraw();
       break;
    }
@@ -156,6 +157,7 @@ void ISelect::DoCommand(int icmd, int x, int y)
       PinTable * const ptable = GetPTable();
       RemoveFromVectorSingle(ptable->m_vedit, piedit);
       ptable->m_vedit.insert(ptable->m_vedit.begin(), piedit);
+      ptable->InvalidateElementNameMap();
       ptable->SetDirtyDraw();
       break;
    }
@@ -172,6 +172,7 @@ static const string defaultPathSearch[]     = { string(), "user"s +PATH_SEPARATO
 #include "audio/wavread.h"
 
 #include "audio/pinsound.h"
+#include "audio/audiomixer.h"
 #include "pinbinary.h"
 
 #include "extern.h"
@@ -180,6 +181,7 @@ static const string defaultPathSearch[]     = { string(), "user"s +PATH_SEPARATO
 #include "parts/pintable.h"
 
 #include "mesh.h"
+#include "physics/physicsarena.h"
 #include "physics/collide.h"
 #include "pin3d.h"
 
@@ -191,6 +193,7 @@ static const string defaultPathSearch[]     = { string(), "user"s +PATH_SEPARATO
 #include "parts/ball.h"
 
 #include "physics/collideex.h"
+#include "physics/hitmesh.h"
 #include "physics/hitball.h"
 #include "physics/hittimer.h"
 #include "physics/hitable.h"
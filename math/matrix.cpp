@@ -60,6 +60,103 @@ void Matrix3D::Invert()
    memcpy(&m[0][0], &mat3D.m[0][0], 16 * sizeof(float));
 }
 
+#ifdef ENABLE_SSE_OPTIMIZATIONS
+#define MM_SPLAT(v, i) _mm_shuffle_ps((v), (v), _MM_SHUFFLE((i), (i), (i), (i)))
+#endif
+
+void Matrix3D::TransformVertices(const Vertex3D_NoTex2* const __restrict inVerts, Vertex3D_NoTex2* const __restrict outVerts, const int count) const
+{
+#ifdef ENABLE_SSE_OPTIMIZATIONS
+   const __m128 row0 = _mm_loadu_ps(&_11);
+   const __m128 row1 = _mm_loadu_ps(&_21);
+   const __m128 row2 = _mm_loadu_ps(&_31);
+   const __m128 row3 = _mm_loadu_ps(&_41);
+   for (int i = 0; i < count; ++i)
+   {
+      const __m128 lo = _mm_loadu_ps(&inVerts[i].x);  // x, y, z, nx
+      const __m128 hi = _mm_loadu_ps(&inVerts[i].ny); // ny, nz, tu, tv
+      const __m128 p = _mm_add_ps(_mm_add_ps(_mm_mul_ps(row0, MM_SPLAT(lo, 0)), _mm_mul_ps(row1, MM_SPLAT(lo, 1))), _mm_add_ps(_mm_mul_ps(row2, MM_SPLAT(lo, 2)), row3));
+      const __m128 n = _mm_add_ps(_mm_add_ps(_mm_mul_ps(row0, MM_SPLAT(lo, 3)), _mm_mul_ps(row1, MM_SPLAT(hi, 0))), _mm_mul_ps(row2, MM_SPLAT(hi, 1)));
+      const __m128 pzn = _mm_shuffle_ps(p, n, _MM_SHUFFLE(0, 0, 2, 2)); // pz, pz, nx, nx
+      _mm_storeu_ps(&outVerts[i].x, _mm_shuffle_ps(p, pzn, _MM_SHUFFLE(2, 0, 1, 0)));   // px, py, pz, nx
+      _mm_storeu_ps(&outVerts[i].ny, _mm_shuffle_ps(n, hi, _MM_SHUFFLE(3, 2, 2, 1)));   // ny, nz, tu, tv
+   }
+#else
+   for (int i = 0; i < count; ++i)
+   {
+      const float x = inVerts[i].x;
+      const float y = inVerts[i].y;
+      const float z = inVerts[i].z;
+      const float nx = inVerts[i].nx;
+      const float ny = inVerts[i].ny;
+      const float nz = inVerts[i].nz;
+      outVerts[i].x = _11 * x + _21 * y + _31 * z + _41;
+      outVerts[i].y = _12 * x + _22 * y + _32 * z + _42;
+      outVerts[i].z = _13 * x + _23 * y + _33 * z + _43;
+      outVerts[i].nx = _11 * nx + _21 * ny + _31 * nz;
+      outVerts[i].ny = _12 * nx + _22 * ny + _32 * nz;
+      outVerts[i].nz = _13 * nx + _23 * ny + _33 * nz;
+      outVerts[i].tu = inVerts[i].tu;
+      outVerts[i].tv = inVerts[i].tv;
+   }
+#endif
+}
+
+void Matrix3D::TransformPositions(const Vertex3D_NoTex2* const __restrict inVerts, Vertex3D_NoTex2* const __restrict outVerts, const int count) const
+{
+#ifdef ENABLE_SSE_OPTIMIZATIONS
+   const __m128 row0 = _mm_loadu_ps(&_11);
+   const __m128 row1 = _mm_loadu_ps(&_21);
+   const __m128 row2 = _mm_loadu_ps(&_31);
+   const __m128 row3 = _mm_loadu_ps(&_41);
+   for (int i = 0; i < count; ++i)
+   {
+      const __m128 v = _mm_loadu_ps(&inVerts[i].x);
+      const __m128 p = _mm_add_ps(_mm_add_ps(_mm_mul_ps(row0, MM_SPLAT(v, 0)), _mm_mul_ps(row1, MM_SPLAT(v, 1))), _mm_add_ps(_mm_mul_ps(row2, MM_SPLAT(v, 2)), row3));
+      // the output may be a (write only) mapped vertex buffer, so do not touch the normal
+      _mm_storel_pi((__m64*)&outVerts[i].x, p);
+      _mm_store_ss(&outVerts[i].z, _mm_movehl_ps(p, p));
+   }
+#else
+   for (int i = 0; i < count; ++i)
+   {
+      const float x = inVerts[i].x;
+      const float y = inVerts[i].y;
+      const float z = inVerts[i].z;
+      outVerts[i].x = _11 * x + _21 * y + _31 * z + _41;
+      outVerts[i].y = _12 * x + _22 * y + _32 * z + _42;
+      outVerts[i].z = _13 * x + _23 * y + _33 * z + _43;
+   }
+#endif
+}
+
+void Matrix3D::TransformNormals(const Vertex3D_NoTex2* const __restrict inVerts, Vertex3D_NoTex2* const __restrict outVerts, const int count) const
+{
+#ifdef ENABLE_SSE_OPTIMIZATIONS
+   const __m128 row0 = _mm_loadu_ps(&_11);
+   const __m128 row1 = _mm_loadu_ps(&_21);
+   const __m128 row2 = _mm_loadu_ps(&_31);
+   for (int i = 0; i < count; ++i)
+   {
+      const __m128 v = _mm_loadu_ps(&inVerts[i].nx); // nx, ny, nz, tu
+      const __m128 n = _mm_add_ps(_mm_add_ps(_mm_mul_ps(row0, MM_SPLAT(v, 0)), _mm_mul_ps(row1, MM_SPLAT(v, 1))), _mm_mul_ps(row2, MM_SPLAT(v, 2)));
+      // the output may be a (write only) mapped vertex buffer, so do not touch the position or texture coordinates
+      _mm_storel_pi((__m64*)&outVerts[i].nx, n);
+      _mm_store_ss(&outVerts[i].nz, _mm_movehl_ps(n, n));
+   }
+#else
+   for (int i = 0; i < count; ++i)
+   {
+      const float nx = inVerts[i].nx;
+      const float ny = inVerts[i].ny;
+      const float nz = inVerts[i].nz;
+      outVerts[i].nx = _11 * nx + _21 * ny + _31 * nz;
+      outVerts[i].ny = _12 * nx + _22 * ny + _32 * nz;
+      outVerts[i].nz = _13 * nx + _23 * ny + _33 * nz;
+   }
+#endif
+}
+
 void RotateAround(const Vertex3Ds &pvAxis, Vertex3D_NoTex2 * const pvPoint, const int count, const float angle)
 {
    Matrix3 mat;
@@ -124,6 +221,39 @@ Vertex3Ds RotateAround(const Vertex3Ds &pvAxis, const Vertex2D &pvPoint, const f
       matrix[2][0] * pvPoint.x + matrix[2][1] * pvPoint.y);
 }
 
+void NormalizeNormals(Vertex3D_NoTex2 * const pvPoint, const size_t count)
+{
+   size_t i = 0;
+#ifdef ENABLE_SSE_OPTIMIZATIONS
+   // 4 normals at once, transposed to nx/ny/nz/tu registers (tu is passed through unchanged)
+   const __m128 one = _mm_set1_ps(1.0f);
+   for (; i + 4 <= count; i += 4)
+   {
+      __m128 nx = _mm_loadu_ps(&pvPoint[i    ].nx);
+      __m128 ny = _mm_loadu_ps(&pvPoint[i + 1].nx);
+      __m128 nz = _mm_loadu_ps(&pvPoint[i + 2].nx);
+      __m128 tu = _mm_loadu_ps(&pvPoint[i + 3].nx);
+      _MM_TRANSPOSE4_PS(nx, ny, nz, tu);
+      const __m128 oneoverlength = _mm_div_ps(one, _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), _mm_mul_ps(nz, nz))));
+      nx = _mm_mul_ps(nx, oneoverlength);
+      ny = _mm_mul_ps(ny, oneoverlength);
+      nz = _mm_mul_ps(nz, oneoverlength);
+      _MM_TRANSPOSE4_PS(nx, ny, nz, tu);
+      _mm_storeu_ps(&pvPoint[i    ].nx, nx);
+      _mm_storeu_ps(&pvPoint[i + 1].nx, ny);
+      _mm_storeu_ps(&pvPoint[i + 2].nx, nz);
+      _mm_storeu_ps(&pvPoint[i + 3].nx, tu);
+   }
+#endif
+   for (; i < count; ++i)
+   {
+      const float oneoverlength = 1.0f / sqrtf(pvPoint[i].nx*pvPoint[i].nx + pvPoint[i].ny*pvPoint[i].ny + pvPoint[i].nz*pvPoint[i].nz);
+      pvPoint[i].nx *= oneoverlength;
+      pvPoint[i].ny *= oneoverlength;
+      pvPoint[i].nz *= oneoverlength;
+   }
+}
+
 //D3D Matrices ----------------------------------------------------------------------------------------------------------------
 
 #ifdef ENABLE_SDL
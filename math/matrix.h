@@ -903,52 +903,10 @@ public:
       v.z = _13 * x + _23 * y + _33 * z + _43;
    }
 
-   void TransformVertices(const Vertex3D_NoTex2* const __restrict inVerts, Vertex3D_NoTex2* const __restrict outVerts, const int count) const
-   {
-      for (int i = 0; i < count; ++i)
-      {
-         const float x = inVerts[i].x;
-         const float y = inVerts[i].y;
-         const float z = inVerts[i].z;
-         const float nx = inVerts[i].nx;
-         const float ny = inVerts[i].ny;
-         const float nz = inVerts[i].nz;
-         outVerts[i].x = _11 * x + _21 * y + _31 * z + _41;
-         outVerts[i].y = _12 * x + _22 * y + _32 * z + _42;
-         outVerts[i].z = _13 * x + _23 * y + _33 * z + _43;
-         outVerts[i].nx = _11 * nx + _21 * ny + _31 * nz;
-         outVerts[i].ny = _12 * nx + _22 * ny + _32 * nz;
-         outVerts[i].nz = _13 * nx + _23 * ny + _33 * nz;
-         outVerts[i].tu = inVerts[i].tu;
-         outVerts[i].tv = inVerts[i].tv;
-      }
-   }
-
-   void TransformPositions(const Vertex3D_NoTex2* const __restrict inVerts, Vertex3D_NoTex2* const __restrict outVerts, const int count) const
-   {
-      for (int i = 0; i < count; ++i)
-      {
-         const float x = inVerts[i].x;
-         const float y = inVerts[i].y;
-         const float z = inVerts[i].z;
-         outVerts[i].x = _11 * x + _21 * y + _31 * z + _41;
-         outVerts[i].y = _12 * x + _22 * y + _32 * z + _42;
-         outVerts[i].z = _13 * x + _23 * y + _33 * z + _43;
-      }
-   }
-
-   void TransformNormals(const Vertex3D_NoTex2* const __restrict inVerts, Vertex3D_NoTex2* const __restrict outVerts, const int count) const
-   {
-      for (int i = 0; i < count; ++i)
-      {
-         const float nx = inVerts[i].nx;
-         const float ny = inVerts[i].ny;
-         const float nz = inVerts[i].nz;
-         outVerts[i].nx = _11 * nx + _21 * ny + _31 * nz;
-         outVerts[i].ny = _12 * nx + _22 * ny + _32 * nz;
-         outVerts[i].nz = _13 * nx + _23 * ny + _33 * nz;
-      }
-   }
+   // batch transforms of vertex arrays (SSE, or NEON through sse2neon), affine only, i.e. no w divide
+   void TransformVertices(const Vertex3D_NoTex2* const __restrict inVerts, Vertex3D_NoTex2* const __restrict outVerts, const int count) const; // positions and normals, copies texture coordinates
+   void TransformPositions(const Vertex3D_NoTex2* const __restrict inVerts, Vertex3D_NoTex2* const __restrict outVerts, const int count) const; // only writes positions
+   void TransformNormals(const Vertex3D_NoTex2* const __restrict inVerts, Vertex3D_NoTex2* const __restrict outVerts, const int count) const; // only writes normals (not normalized)
 
    template <class T> void TransformVertices(const T* const __restrict rgv, const WORD* const __restrict rgi, const int count, Vertex2D* const __restrict rgvout, const RECT& viewPort) const
    {
@@ -353,6 +353,7 @@ inline Vertex3Ds GetRotatedAxis(const float angle, const Vertex3Ds &axis, const
 
 void RotateAround(const Vertex3Ds &pvAxis, Vertex3D_NoTex2 * const pvPoint, int count, float angle);
 void RotateAround(const Vertex3Ds &pvAxis, Vertex3Ds * const pvPoint, int count, float angle);
+void NormalizeNormals(Vertex3D_NoTex2 * const pvPoint, const size_t count); // batch normalize (SSE, or NEON through sse2neon)
 Vertex3Ds RotateAround(const Vertex3Ds &pvAxis, const Vertex2D &pvPoint, float angle);
 
 // uniformly distributed vector over sphere
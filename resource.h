@@ -938,6 +938,7 @@
 #define IDC_PLUNGERRETRACT              592
 #define IDC_DMD_SOURCE                  593
 #define IDC_IMPORT_NO_FORSYTH           593
+#define IDC_IMPORT_QUANTIZE             929
 #define IDC_SHARPEN_COMBO               594
 #define IDC_GET_INPLAYSTATE             595
 #define IDC_TURN_VR_ON                  597
@@ -1343,6 +1344,7 @@
 #define ID_TABLE_RENDERPROBEMANAGER     4027
 #define ID_TABLE_LIVEEDIT               4028
 #define ID_TABLE_LOCK                   4029
+#define ID_TABLE_OPTIMIZEPRIMITIVES     4030
 #define IDC_ENABLE_EMREEL_CHECK         13432
 #define IDC_ENABLE_DECAL_CHECK          13433
 #define IDC_BG_TEST_DESKTOP_CHECK       13434
@@ -1458,8 +1460,8 @@
 #ifdef APSTUDIO_INVOKED
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NEXT_RESOURCE_VALUE        677
-#define _APS_NEXT_COMMAND_VALUE         4030
-#define _APS_NEXT_CONTROL_VALUE         929
+#define _APS_NEXT_COMMAND_VALUE         4031
+#define _APS_NEXT_CONTROL_VALUE         930
 #define _APS_NEXT_SYMED_VALUE           188
 #endif
 #endif
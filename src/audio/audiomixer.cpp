@@ -0,0 +1,416 @@
+// Not using the precompiled header, so that the mixer can be built on its own (see audiomixer_bench.cpp)
+#include "audiomixer.h"
+
+#include <cstdint>
+#include <cstring>
+
+static constexpr double pi = 3.1415926535897932384626433832795;
+
+///////////////////////////////////////////////////////////////////////////////
+// Samples
+
+bool AudioMixerSample::ConvertPCM(const void* const data, const unsigned int size, const unsigned int nChannels, const unsigned int sampleRate, const unsigned int bitsPerSample, const bool isFloat,
+   const unsigned int outSampleRate, std::vector<float>& out)
+{
+   if (nChannels < 1 || nChannels > 2 || sampleRate == 0 || outSampleRate == 0 || (isFloat && bitsPerSample != 32) || (bitsPerSample != 8 && bitsPerSample != 16 && bitsPerSample != 24 && bitsPerSample != 32))
+      return false;
+
+   const unsigned int bps = bitsPerSample / 8;
+   const unsigned int nFrames = size / (bps * nChannels);
+   const unsigned int nSamples = nFrames * nChannels;
+   std::vector<float> converted;
+   std::vector<float>& pcm = (sampleRate == outSampleRate) ? out : converted;
+   pcm.resize(nSamples);
+   const uint8_t* const __restrict src = (const uint8_t*)data;
+   float* const __restrict dst = pcm.data();
+   if (isFloat)
+      memcpy(dst, src, nSamples * sizeof(float));
+   else if (bitsPerSample == 8) // unsigned
+      for (unsigned int i = 0; i < nSamples; i++)
+         dst[i] = (float)((int)src[i] - 128) * (float)(1.0 / 128.0);
+   else if (bitsPerSample == 16)
+      for (unsigned int i = 0; i < nSamples; i++)
+         dst[i] = (float)*(const int16_t*)(src + i * 2) * (float)(1.0 / 32768.0);
+   else if (bitsPerSample == 24)
+      for (unsigned int i = 0; i < nSamples; i++)
+         dst[i] = (float)((int)((unsigned int)src[i * 3] << 8 | (unsigned int)src[i * 3 + 1] << 16 | (unsigned int)src[i * 3 + 2] << 24) >> 8) * (float)(1.0 / 8388608.0);
+   else
+      for (unsigned int i = 0; i < nSamples; i++)
+         dst[i] = (float)((double)*(const int32_t*)(src + i * 4) * (1.0 / 2147483648.0));
+
+   if (sampleRate != outSampleRate && nFrames > 0)
+   {
+      // Linear resampling to the output rate
+      const unsigned int nOutFrames = (unsigned int)(((unsigned long long)nFrames * outSampleRate + sampleRate - 1) / sampleRate);
+      out.resize(nOutFrames * nChannels);
+      const double step = (double)sampleRate / (double)outSampleRate;
+      for (unsigned int i = 0; i < nOutFrames; i++)
+      {
+         const double pos = (double)i * step;
+         const unsigned int i0 = std::min((unsigned int)pos, nFrames - 1);
+         const unsigned int i1 = std::min(i0 + 1, nFrames - 1);
+         const float t = (float)(pos - (double)i0);
+         for (unsigned int c = 0; c < nChannels; c++)
+            out[i * nChannels + c] = converted[i0 * nChannels + c] + t * (converted[i1 * nChannels + c] - converted[i0 * nChannels + c]);
+      }
+   }
+   return true;
+}
+
+std::shared_ptr<AudioMixerSample> AudioMixerSample::Create(std::vector<float>&& pcm, const unsigned int nChannels, const unsigned int sampleRate)
+{
+   std::shared_ptr<AudioMixerSample> sample = std::make_shared<AudioMixerSample>();
+   const std::shared_ptr<std::vector<float>> storage = std::make_shared<std::vector<float>>(std::move(pcm));
+   sample->m_data = storage->data();
+   sample->m_storage = storage;
+   sample->m_nChannels = nChannels;
+   sample->m_sampleRate = sampleRate;
+   sample->m_nFrames = (unsigned int)(storage->size() / nChannels);
+   return sample;
+}
+
+size_t AudioMixerSample::PackInArena(const std::vector<std::shared_ptr<AudioMixerSample>>& samples)
+{
+   size_t size = 0;
+   for (const std::shared_ptr<AudioMixerSample>& sample : samples)
+      size += sample->m_nFrames * sample->m_nChannels;
+   const std::shared_ptr<std::vector<float>> arena = std::make_shared<std::vector<float>>(size);
+   float* data = arena->data();
+   for (const std::shared_ptr<AudioMixerSample>& sample : samples)
+   {
+      const size_t nSamples = sample->m_nFrames * sample->m_nChannels;
+      memcpy(data, sample->m_data, nSamples * sizeof(float));
+      sample->m_data = data;
+      sample->m_storage = arena;
+      data += nSamples;
+   }
+   return size * sizeof(float);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Sinks
+
+void NullAudioMixerSink::Write(const float* const samples, const unsigned int nFrames)
+{
+   if (!m_realtime)
+      return;
+   if (m_writtenFrames == 0)
+      m_start = std::chrono::steady_clock::now();
+   m_writtenFrames += nFrames;
+   std::this_thread::sleep_until(m_start + std::chrono::microseconds(m_writtenFrames * 1000000ull / m_sampleRate));
+}
+
+FileAudioMixerSink::FileAudioMixerSink(const std::string& path, const unsigned int nChannels, const unsigned int sampleRate)
+   : m_nChannels(nChannels)
+   , m_sampleRate(sampleRate)
+{
+#ifdef _MSC_VER
+   if (fopen_s(&m_file, path.c_str(), "wb") != 0)
+      m_file = nullptr;
+#else
+   m_file = fopen(path.c_str(), "wb");
+#endif
+   if (m_file != nullptr)
+      WriteHeader();
+}
+
+FileAudioMixerSink::~FileAudioMixerSink()
+{
+   if (m_file == nullptr)
+      return;
+   // Update header with final data size
+   fseek(m_file, 0, SEEK_SET);
+   WriteHeader();
+   fclose(m_file);
+}
+
+void FileAudioMixerSink::WriteHeader()
+{
+   const uint32_t riffSize = 4 + 8 + 16 + 8 + m_dataSize;
+   const uint32_t fmtSize = 16;
+   const uint16_t format = 3; // WAVE_FORMAT_IEEE_FLOAT
+   const uint16_t nChannels = (uint16_t)m_nChannels;
+   const uint32_t sampleRate = m_sampleRate;
+   const uint32_t byteRate = m_sampleRate * m_nChannels * (uint32_t)sizeof(float);
+   const uint16_t blockAlign = (uint16_t)(m_nChannels * sizeof(float));
+   const uint16_t bitsPerSample = 32;
+   fwrite("RIFF", 1, 4, m_file);
+   fwrite(&riffSize, 4, 1, m_file);
+   fwrite("WAVEfmt ", 1, 8, m_file);
+   fwrite(&fmtSize, 4, 1, m_file);
+   fwrite(&format, 2, 1, m_file);
+   fwrite(&nChannels, 2, 1, m_file);
+   fwrite(&sampleRate, 4, 1, m_file);
+   fwrite(&byteRate, 4, 1, m_file);
+   fwrite(&blockAlign, 2, 1, m_file);
+   fwrite(&bitsPerSample, 2, 1, m_file);
+   fwrite("data", 1, 4, m_file);
+   fwrite(&m_dataSize, 4, 1, m_file);
+}
+
+void FileAudioMixerSink::Write(const float* const samples, const unsigned int nFrames)
+{
+   if (m_file == nullptr)
+      return;
+   fwrite(samples, sizeof(float) * m_nChannels, nFrames, m_file);
+   m_dataSize += nFrames * m_nChannels * (unsigned int)sizeof(float);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Mixer
+
+AudioMixer::AudioMixer(const SoundConfigTypes soundMode, const unsigned int nChannels, const unsigned int sampleRate, const unsigned int nVoices)
+   : m_soundMode(soundMode)
+   , m_nChannels(std::clamp(nChannels, 1u, MAX_CHANNELS))
+   , m_sampleRate(sampleRate)
+{
+   m_voices.resize(std::max(nVoices, 1u));
+}
+
+AudioMixer::~AudioMixer()
+{
+   StopThread();
+}
+
+void AudioMixer::StartThread(std::unique_ptr<AudioMixerSink> sink, const unsigned int blockFrames)
+{
+   StopThread();
+   m_sink = std::move(sink);
+   m_outputLatency = (unsigned int)((unsigned long long)blockFrames * 1000000ull / m_sampleRate);
+   m_threadRunning = true;
+   m_thread = std::thread([this, blockFrames]()
+   {
+      std::vector<float> buffer(blockFrames * m_nChannels);
+      while (m_threadRunning)
+      {
+         Render(buffer.data(), blockFrames);
+         m_sink->Write(buffer.data(), blockFrames);
+      }
+   });
+}
+
+void AudioMixer::StopThread()
+{
+   if (!m_thread.joinable())
+      return;
+   m_threadRunning = false;
+   m_thread.join();
+   m_sink = nullptr;
+}
+
+void AudioMixer::PushCommand(const Command& cmd)
+{
+   if (!m_commands.Push(cmd))
+      m_nDroppedCommands++;
+}
+
+void AudioMixer::Play(const void* const tag, const std::shared_ptr<AudioMixerSample>& sample, const float volume, const float pitchRatio, const float pan, const float front_rear_fade, const bool loop, const bool usesame, const bool restart)
+{
+   if (sample == nullptr || sample->m_nFrames == 0)
+      return;
+   Command cmd;
+   cmd.m_type = Command::PLAY;
+   cmd.m_tag = tag;
+   cmd.m_sample = sample;
+   cmd.m_volume = volume;
+   cmd.m_pitchRatio = pitchRatio;
+   cmd.m_pan = pan;
+   cmd.m_fade = front_rear_fade;
+   cmd.m_loop = loop;
+   cmd.m_usesame = usesame;
+   cmd.m_restart = restart;
+   cmd.m_timestamp = std::chrono::steady_clock::now();
+   PushCommand(cmd);
+}
+
+void AudioMixer::Stop(const void* const tag)
+{
+   Command cmd;
+   cmd.m_type = Command::STOP;
+   cmd.m_tag = tag;
+   PushCommand(cmd);
+}
+
+void AudioMixer::StopAll()
+{
+   Command cmd;
+   cmd.m_type = Command::STOP_ALL;
+   PushCommand(cmd);
+}
+
+void AudioMixer::ProcessCommand(Command& cmd)
+{
+   switch (cmd.m_type)
+   {
+   case Command::PLAY:
+   {
+      const unsigned int latency = std::max(1u, (unsigned int)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - cmd.m_timestamp).count() + m_outputLatency.load(std::memory_order_relaxed));
+      unsigned int prevLatency = m_maxPlayLatency.load(std::memory_order_relaxed);
+      while (latency > prevLatency && !m_maxPlayLatency.compare_exchange_weak(prevLatency, latency, std::memory_order_relaxed)) { }
+      // Like the legacy sound copies, 'usesame' updates the voice already playing this sound (if any) instead of starting a new one
+      if (cmd.m_usesame)
+      {
+         for (Voice& voice : m_voices)
+         {
+            if (voice.m_sample != nullptr && voice.m_tag == cmd.m_tag)
+            {
+               SetupVoice(voice, cmd);
+               if (cmd.m_restart)
+                  voice.m_position = 0.;
+               return;
+            }
+         }
+      }
+      Voice* const voice = AllocateVoice();
+      voice->m_tag = cmd.m_tag;
+      voice->m_sample = std::move(cmd.m_sample);
+      voice->m_position = 0.;
+      voice->m_startIndex = m_playIndex++;
+      SetupVoice(*voice, cmd);
+      break;
+   }
+
+   case Command::STOP:
+      for (Voice& voice : m_voices)
+         if (voice.m_tag == cmd.m_tag)
+            voice.m_sample = nullptr;
+      break;
+
+   case Command::STOP_ALL:
+      for (Voice& voice : m_voices)
+         voice.m_sample = nullptr;
+      break;
+   }
+}
+
+AudioMixer::Voice* AudioMixer::AllocateVoice()
+{
+   // Use a free voice if any, otherwise steal the least audible one, favoring one shot sounds, then older ones
+   Voice* best = nullptr;
+   for (Voice& voice : m_voices)
+   {
+      if (voice.m_sample == nullptr)
+         return &voice;
+      if (best == nullptr
+         || (best->m_loop && !voice.m_loop)
+         || (best->m_loop == voice.m_loop && (voice.m_volume < best->m_volume || (voice.m_volume == best->m_volume && (int)(voice.m_startIndex - best->m_startIndex) < 0))))
+         best = &voice;
+   }
+   m_nStolenVoices++;
+   return best;
+}
+
+void AudioMixer::SetupVoice(Voice& voice, const Command& cmd) const
+{
+   voice.m_volume = sqrtf(std::clamp(cmd.m_volume * (float)(1.0 / 100.), 0.f, 1.f)); // to match VP legacy (BASS)
+   voice.m_step = (double)voice.m_sample->m_sampleRate * (double)std::max(cmd.m_pitchRatio, 0.f) / (double)m_sampleRate;
+   voice.m_loop = cmd.m_loop;
+   ComputeGains(cmd.m_pan, cmd.m_fade, voice.m_gains);
+   for (unsigned int i = 0; i < m_nChannels; i++)
+      voice.m_gains[i] *= voice.m_volume;
+}
+
+void AudioMixer::ComputeGains(const float pan, const float front_rear_fade, float* const gains) const
+{
+   for (unsigned int i = 0; i < MAX_CHANNELS; i++)
+      gains[i] = 0.f;
+
+   if (m_soundMode == SNDCFG_SND3D2CH || m_nChannels < 6)
+   {
+      // Stereo balance: the side opposite to the pan gets attenuated
+      if (m_nChannels == 1)
+         gains[0] = 1.f;
+      else
+      {
+         const float p = std::clamp(pan, -1.f, 1.f);
+         gains[0] = std::min(1.f - p, 1.f);
+         gains[1] = std::min(1.f + p, 1.f);
+      }
+      return;
+   }
+
+   // Same 3D positions as the ones used for BASS, x is left/right, z is rear/front (each roughly in -3..3)
+   float x, z;
+   switch (m_soundMode)
+   {
+   case SNDCFG_SND3DALLREAR: x = PanTo3D(pan); z = -PanTo3D(1.0f); break;
+   case SNDCFG_SND3DFRONTISFRONT: x = PanTo3D(pan); z = PanTo3D(front_rear_fade); break;
+   case SNDCFG_SND3DFRONTISREAR: x = PanTo3D(pan); z = -PanTo3D(front_rear_fade); break;
+   case SNDCFG_SND3D6CH: x = PanTo3D(pan); z = -((PanTo3D(front_rear_fade) + 3.0f) / 2.0f); break;
+   case SNDCFG_SND3DSSF: default: x = PanSSF(pan); z = FadeSSF(front_rear_fade); break;
+   }
+
+   // Map the position to the 4 corner speakers using constant power panning on both axis
+   const float lr = (std::clamp(x * (float)(1.0 / 3.0), -1.f, 1.f) + 1.f) * (float)(pi / 4.0);
+   const float fr = (std::clamp(z * (float)(1.0 / 3.0), -1.f, 1.f) + 1.f) * (float)(pi / 4.0);
+   const float left = cosf(lr), right = sinf(lr);
+   const float front = sinf(fr), rear = cosf(fr);
+   gains[0] = left * front;
+   gains[1] = right * front;
+   gains[4] = left * rear;
+   gains[5] = right * rear;
+}
+
+void AudioMixer::MixVoice(Voice& voice, float* const output, const unsigned int nFrames)
+{
+   const AudioMixerSample* const sample = voice.m_sample.get();
+   const float* const __restrict data = sample->m_data;
+   const unsigned int nSrcFrames = sample->m_nFrames;
+   const bool stereo = sample->m_nChannels == 2;
+   // Stereo samples keep their channels when the output is also stereo, they are down mixed to mono for 3D positioning (like BASS does)
+   const bool keepStereo = stereo && m_nChannels == 2;
+   float* __restrict out = output;
+   double pos = voice.m_position;
+   for (unsigned int i = 0; i < nFrames; i++, out += m_nChannels)
+   {
+      if (pos >= (double)nSrcFrames)
+      {
+         if (!voice.m_loop)
+         {
+            voice.m_sample = nullptr;
+            return;
+         }
+         pos = fmod(pos, (double)nSrcFrames);
+      }
+      // Linear interpolation between the 2 nearest sample frames
+      const unsigned int i0 = (unsigned int)pos;
+      const unsigned int i1 = (i0 + 1 < nSrcFrames) ? i0 + 1 : (voice.m_loop ? 0 : i0);
+      const float t = (float)(pos - (double)i0);
+      if (keepStereo)
+      {
+         out[0] += voice.m_gains[0] * (data[i0 * 2] + t * (data[i1 * 2] - data[i0 * 2]));
+         out[1] += voice.m_gains[1] * (data[i0 * 2 + 1] + t * (data[i1 * 2 + 1] - data[i0 * 2 + 1]));
+      }
+      else
+      {
+         const float s = stereo ? 0.5f * (data[i0 * 2] + data[i0 * 2 + 1] + t * (data[i1 * 2] + data[i1 * 2 + 1] - data[i0 * 2] - data[i0 * 2 + 1]))
+                                : data[i0] + t * (data[i1] - data[i0]);
+         for (unsigned int c = 0; c < m_nChannels; c++)
+            out[c] += voice.m_gains[c] * s;
+      }
+      pos += voice.m_step;
+   }
+   voice.m_position = pos;
+}
+
+void AudioMixer::Render(float* const output, const unsigned int nFrames)
+{
+   Command cmd;
+   while (m_commands.Pop(cmd))
+      ProcessCommand(cmd);
+
+   memset(output, 0, nFrames * m_nChannels * sizeof(float));
+   unsigned int nActiveVoices = 0;
+   for (Voice& voice : m_voices)
+   {
+      if (voice.m_sample == nullptr)
+         continue;
+      MixVoice(voice, output, nFrames);
+      nActiveVoices++;
+   }
+
+   m_nActiveVoices.store(nActiveVoices, std::memory_order_relaxed);
+   m_nMixedFrames.fetch_add(nFrames, std::memory_order_relaxed);
+}
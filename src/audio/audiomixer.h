@@ -0,0 +1,207 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "soundpan.h"
+
+// Software audio mixer
+// ====================
+//
+// Table sounds are decoded once to float PCM samples, then mixed in process by a fixed pool of voices instead of
+// having each play call do several driver round-trips (volume, frequency, position, status, play) on the game thread.
+//
+// The game thread only pushes small commands to a lock-free single producer/single consumer ring. The mixer side
+// (either the mixer thread feeding a push sink like the null/file sinks, or the audio device pulling data through
+// a callback) drains these commands, then mixes the active voices, applying the 2CH/3D/SSF speaker mapping.
+//
+// The mixer itself only depends on the standard library, so it can be run and benchmarked headless (see audiomixer_bench.cpp).
+
+// Single producer/single consumer lock-free ring buffer
+template <class T, unsigned int Capacity> class SPSCRing final
+{
+public:
+   static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+   // Producer side, fails if the ring is full
+   bool Push(const T& item)
+   {
+      const unsigned int head = m_head.load(std::memory_order_relaxed);
+      if (head - m_tail.load(std::memory_order_acquire) == Capacity)
+         return false;
+      m_items[head & (Capacity - 1)] = item;
+      m_head.store(head + 1, std::memory_order_release);
+      return true;
+   }
+
+   // Consumer side, fails if the ring is empty
+   bool Pop(T& item)
+   {
+      const unsigned int tail = m_tail.load(std::memory_order_relaxed);
+      if (m_head.load(std::memory_order_acquire) == tail)
+         return false;
+      item = std::move(m_items[tail & (Capacity - 1)]);
+      m_items[tail & (Capacity - 1)] = T();
+      m_tail.store(tail + 1, std::memory_order_release);
+      return true;
+   }
+
+private:
+   T m_items[Capacity];
+   alignas(64) std::atomic<unsigned int> m_head { 0 };
+   alignas(64) std::atomic<unsigned int> m_tail { 0 };
+};
+
+// Decoded sound, as interleaved float PCM
+struct AudioMixerSample final
+{
+   const float* m_data = nullptr; // Samples, stored either in their own storage or in an arena shared with other samples
+   std::shared_ptr<const std::vector<float>> m_storage;
+   unsigned int m_nChannels = 1; // 1 or 2
+   unsigned int m_sampleRate = 44100;
+   unsigned int m_nFrames = 0;
+
+   // Convert 8/16/24/32 bits integer or 32 bits float PCM data to float PCM, resampled to the given rate, returns false for unsupported formats
+   static bool ConvertPCM(const void* const data, const unsigned int size, const unsigned int nChannels, const unsigned int sampleRate, const unsigned int bitsPerSample, const bool isFloat,
+      const unsigned int outSampleRate, std::vector<float>& out);
+
+   static std::shared_ptr<AudioMixerSample> Create(std::vector<float>&& pcm, const unsigned int nChannels, const unsigned int sampleRate);
+
+   // Move the data of the given samples to a single contiguous arena, returns the arena size in bytes. Samples must not be played while packing them.
+   static size_t PackInArena(const std::vector<std::shared_ptr<AudioMixerSample>>& samples);
+};
+
+// Output of the mixer thread
+class AudioMixerSink
+{
+public:
+   virtual ~AudioMixerSink() = default;
+   virtual void Write(const float* const samples, const unsigned int nFrames) = 0; // interleaved samples, using the mixer channel count
+};
+
+// Discard mixed samples, either as fast as possible (for benchmarking) or paced at the output sample rate
+class NullAudioMixerSink final : public AudioMixerSink
+{
+public:
+   NullAudioMixerSink(const unsigned int sampleRate, const bool realtime) : m_sampleRate(sampleRate), m_realtime(realtime) { }
+   void Write(const float* const samples, const unsigned int nFrames) override;
+
+private:
+   const unsigned int m_sampleRate;
+   const bool m_realtime;
+   unsigned long long m_writtenFrames = 0;
+   std::chrono::steady_clock::time_point m_start;
+};
+
+// Write mixed samples to a 32 bits float WAV file
+class FileAudioMixerSink final : public AudioMixerSink
+{
+public:
+   FileAudioMixerSink(const std::string& path, const unsigned int nChannels, const unsigned int sampleRate);
+   ~FileAudioMixerSink() override;
+   bool IsOpen() const { return m_file != nullptr; }
+   void Write(const float* const samples, const unsigned int nFrames) override;
+
+private:
+   void WriteHeader();
+
+   FILE* m_file = nullptr;
+   const unsigned int m_nChannels;
+   const unsigned int m_sampleRate;
+   unsigned int m_dataSize = 0;
+};
+
+class AudioMixer final
+{
+public:
+   static constexpr unsigned int MAX_CHANNELS = 6; // Speaker layout of 6 channels output is FL, FR, C, LFE, RL, RR
+
+   AudioMixer(const SoundConfigTypes soundMode, const unsigned int nChannels, const unsigned int sampleRate, const unsigned int nVoices);
+   ~AudioMixer();
+
+   unsigned int GetChannelCount() const { return m_nChannels; }
+   unsigned int GetSampleRate() const { return m_sampleRate; }
+
+   // Game thread API (single producer). Voices are identified by a tag (the played sound) to implement 'usesame' and stop requests.
+   // Volume is in the 0..100 VP range, pitch is given as a frequency ratio, pan and front/rear fade are in the -1..1 VP range.
+   void Play(const void* const tag, const std::shared_ptr<AudioMixerSample>& sample, const float volume, const float pitchRatio, const float pan, const float front_rear_fade, const bool loop, const bool usesame, const bool restart);
+   void Stop(const void* const tag);
+   void StopAll();
+
+   // Mixer side API (single consumer): process pending commands, then mix the given number of frames
+   void Render(float* const output, const unsigned int nFrames);
+
+   // Run a mixer thread that feeds the given sink by blocks of the given size
+   void StartThread(std::unique_ptr<AudioMixerSink> sink, const unsigned int blockFrames);
+   void StopThread();
+
+   // Statistics (can be read from any thread)
+   unsigned int GetActiveVoiceCount() const { return m_nActiveVoices.load(std::memory_order_relaxed); }
+   unsigned int GetStolenVoiceCount() const { return m_nStolenVoices.load(std::memory_order_relaxed); }
+   unsigned int GetDroppedCommandCount() const { return m_nDroppedCommands.load(std::memory_order_relaxed); }
+   unsigned long long GetMixedFrameCount() const { return m_nMixedFrames.load(std::memory_order_relaxed); }
+
+   // Play call to output latency, measured when the mixer picks up the play request, plus the output buffering delay (in microseconds).
+   // Returns the worst latency of the play requests processed since the previous call, or 0 if none.
+   unsigned int TakeMaxPlayLatency() { return m_maxPlayLatency.exchange(0, std::memory_order_relaxed); }
+   void SetOutputLatency(const unsigned int latency) { m_outputLatency = latency; }
+
+private:
+   struct Command
+   {
+      enum Type { PLAY, STOP, STOP_ALL } m_type = STOP_ALL;
+      const void* m_tag = nullptr;
+      std::shared_ptr<AudioMixerSample> m_sample;
+      float m_volume = 0.f;
+      float m_pitchRatio = 1.f;
+      float m_pan = 0.f;
+      float m_fade = 0.f;
+      bool m_loop = false;
+      bool m_usesame = false;
+      bool m_restart = false;
+      std::chrono::steady_clock::time_point m_timestamp; // Time of the play call, used to measure latency
+   };
+
+   struct Voice
+   {
+      const void* m_tag = nullptr;
+      std::shared_ptr<AudioMixerSample> m_sample; // nullptr if voice is free
+      double m_position = 0.; // in sample frames
+      double m_step = 1.; // in sample frames per output frame
+      float m_gains[MAX_CHANNELS];
+      float m_volume = 0.f;
+      bool m_loop = false;
+      unsigned int m_startIndex = 0; // Play order, used to steal the oldest voices first
+   };
+
+   void PushCommand(const Command& cmd);
+   void ProcessCommand(Command& cmd);
+   Voice* AllocateVoice();
+   void SetupVoice(Voice& voice, const Command& cmd) const;
+   void ComputeGains(const float pan, const float front_rear_fade, float* const gains) const;
+   void MixVoice(Voice& voice, float* const output, const unsigned int nFrames);
+
+   const SoundConfigTypes m_soundMode;
+   const unsigned int m_nChannels;
+   const unsigned int m_sampleRate;
+
+   SPSCRing<Command, 1024> m_commands;
+   std::vector<Voice> m_voices;
+   unsigned int m_playIndex = 0;
+
+   std::thread m_thread;
+   std::atomic<bool> m_threadRunning { false };
+   std::unique_ptr<AudioMixerSink> m_sink;
+
+   std::atomic<unsigned int> m_nActiveVoices { 0 };
+   std::atomic<unsigned int> m_nStolenVoices { 0 };
+   std::atomic<unsigned int> m_nDroppedCommands { 0 };
+   std::atomic<unsigned long long> m_nMixedFrames { 0 };
+   std::atomic<unsigned int> m_maxPlayLatency { 0 };
+   std::atomic<unsigned int> m_outputLatency { 0 };
+};
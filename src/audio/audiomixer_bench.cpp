@@ -0,0 +1,59 @@
+// Standalone benchmark of the software audio mixer, not part of the player build
+//
+// Build and run (any platform with a C++20 compiler), for example:
+//    g++ -O2 -std=c++20 -pthread src/audio/audiomixer.cpp src/audio/audiomixer_bench.cpp -o audiomixer_bench
+//    ./audiomixer_bench [voices] [seconds]
+//
+// The mixer thread feeds a non realtime NullAudioMixerSink (so it mixes as fast as possible) while the main thread plays sounds
+// like a busy table would, then the mixing throughput is reported as a multiple of realtime.
+
+#include "audiomixer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+static std::shared_ptr<AudioMixerSample> CreateTone(const float frequency, const float length, const unsigned int nChannels, const unsigned int sampleRate)
+{
+   std::vector<float> pcm((size_t)(length * (float)sampleRate) * nChannels);
+   for (size_t i = 0; i < pcm.size(); i++)
+      pcm[i] = 0.5f * sinf((float)(i / nChannels) * frequency * (float)(2.0 * 3.1415926535897932384626433832795) / (float)sampleRate);
+   return AudioMixerSample::Create(std::move(pcm), nChannels, sampleRate);
+}
+
+int main(int argc, char* argv[])
+{
+   const unsigned int nVoices = argc > 1 ? (unsigned int)std::max(atoi(argv[1]), 1) : 64;
+   const double duration = argc > 2 ? std::max(atof(argv[2]), 0.1) : 5.0;
+   const unsigned int sampleRate = 48000;
+
+   std::vector<std::shared_ptr<AudioMixerSample>> samples;
+   for (unsigned int i = 0; i < 32; i++)
+      samples.push_back(CreateTone(200.f + 50.f * (float)i, 0.1f + 0.05f * (float)(i % 8), 1 + i % 2, i % 3 == 0 ? 44100 : sampleRate));
+   const size_t arenaSize = AudioMixerSample::PackInArena(samples);
+
+   AudioMixer mixer(SNDCFG_SND3DSSF, 6, sampleRate, nVoices);
+   mixer.StartThread(std::make_unique<NullAudioMixerSink>(sampleRate, false), 512);
+
+   // Play a sound every 0.5ms, with varying volume, pitch and position, some of them looping
+   const auto start = std::chrono::steady_clock::now();
+   unsigned int nPlays = 0, maxLatency = 0;
+   while (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < duration)
+   {
+      const std::shared_ptr<AudioMixerSample>& sample = samples[nPlays % samples.size()];
+      const float pos = (float)(nPlays % 21) * 0.1f - 1.f;
+      mixer.Play(sample.get(), sample, 20.f + (float)(nPlays % 80), 0.8f + 0.02f * (float)(nPlays % 20), pos, -pos, nPlays % 50 == 0, nPlays % 4 == 0, false);
+      nPlays++;
+      maxLatency = std::max(maxLatency, mixer.TakeMaxPlayLatency());
+      std::this_thread::sleep_for(std::chrono::microseconds(500));
+   }
+   mixer.StopAll();
+   mixer.StopThread();
+   const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+   const double mixed = (double)mixer.GetMixedFrameCount() / (double)sampleRate;
+   printf("Mixer: %u voices, %u channels at %u Hz, %zu KB of samples\n", nVoices, mixer.GetChannelCount(), sampleRate, arenaSize / 1024);
+   printf("Mixed %.1fs of audio in %.1fs (%.1fx realtime)\n", mixed, elapsed, mixed / elapsed);
+   printf("%u plays, %u stolen voices, %u dropped commands, %.2fms max play latency\n", nPlays, mixer.GetStolenVoiceCount(), mixer.GetDroppedCommandCount(), maxLatency * 1e-3);
+   return 0;
+}
@@ -1,5 +1,8 @@
 #include "stdafx.h"
 
+static const Settings::IntSetting s_musicReadAheadSetting = Settings::RegisterIntSetting(Settings::Player, "MusicReadAhead"s, 2000); // in ms
+static const Settings::IntSetting s_streamBufferSetting = Settings::RegisterIntSetting(Settings::Player, "StreamBufferLength"s, 100); // in ms
+
 /*static*/ float convert2decibelvolume(const float volume) // 0..100 -> DSBVOLUME_MIN..DSBVOLUME_MAX (-10000..0) (db/log scale)
 {
    const float totalvolume = max(min(volume, 100.0f), 0.0f);
@@ -7,6 +10,28 @@
    return decibelvolume;
 }
 
+size_t AudioRingBuffer::Write(const void* const data, const size_t size)
+{
+   const size_t toWrite = min(size, GetFree());
+   const size_t writePos = (m_readPos + m_size) % m_data.size();
+   const size_t first = min(toWrite, m_data.size() - writePos);
+   memcpy(m_data.data() + writePos, data, first);
+   memcpy(m_data.data(), (const BYTE*)data + first, toWrite - first);
+   m_size += toWrite;
+   return toWrite;
+}
+
+size_t AudioRingBuffer::Read(void* const data, const size_t size)
+{
+   const size_t toRead = min(size, m_size);
+   const size_t first = min(toRead, m_data.size() - m_readPos);
+   memcpy(data, m_data.data() + m_readPos, first);
+   memcpy((BYTE*)data + first, m_data.data(), toRead - first);
+   m_readPos = (m_readPos + toRead) % m_data.size();
+   m_size -= toRead;
+   return toRead;
+}
+
 AudioPlayer::AudioPlayer()
 {
    m_stream = 0;
@@ -14,38 +39,84 @@ AudioPlayer::AudioPlayer()
 
 AudioPlayer::~AudioPlayer()
 {
-   if (m_stream)
+   MusicClose();
+}
+
+void AudioPlayer::SelectDevice() const
+{
+   if (g_pvp->m_ps.bass_BG_idx != -1 && g_pvp->m_ps.bass_STD_idx != g_pvp->m_ps.bass_BG_idx) BASS_SetDevice(g_pvp->m_ps.bass_BG_idx);
+}
+
+DWORD CALLBACK AudioPlayer::OutputStreamProc(HSTREAM handle, void* buffer, DWORD length, void* user)
+{
+   return static_cast<AudioPlayer*>(user)->ReadOutput(buffer, length);
+}
+
+// Called from the BASS update thread to feed the output stream
+DWORD AudioPlayer::ReadOutput(void* const buffer, const DWORD length)
+{
+   std::lock_guard<std::mutex> lock(m_bufferMutex);
+   if (m_buffering)
    {
-      if(g_pvp->m_ps.bass_BG_idx != -1 && g_pvp->m_ps.bass_STD_idx != g_pvp->m_ps.bass_BG_idx) BASS_SetDevice(g_pvp->m_ps.bass_BG_idx);
-      BASS_ChannelStop(m_stream);
-      BASS_StreamFree(m_stream);
+      // Wait for the buffer to be filled up to the prebuffer level before (re)starting output, leaving the stream stalled meanwhile
+      if (m_buffer.GetSize() < m_prebufferSize && !m_decodeDone)
+         return 0;
+      m_buffering = false;
    }
+   const DWORD read = (DWORD)m_buffer.Read(buffer, length);
+   m_bufferCondition.notify_one();
+   if (read < length)
+   {
+      if (m_decodeDone)
+         return read | BASS_STREAMPROC_END;
+      m_nUnderruns++;
+      m_buffering = true;
+   }
+   return read;
 }
 
 void AudioPlayer::MusicPause()
 {
+   UpdateMusicStream();
+   m_paused = true;
    if (m_stream)
    {
-      if(g_pvp->m_ps.bass_BG_idx != -1 && g_pvp->m_ps.bass_STD_idx != g_pvp->m_ps.bass_BG_idx) BASS_SetDevice(g_pvp->m_ps.bass_BG_idx);
+      SelectDevice();
       BASS_ChannelPause(m_stream);
    }
 }
 
 void AudioPlayer::MusicUnpause()
 {
-   if (m_stream)
+   UpdateMusicStream();
+   m_paused = false;
+   if (m_stream && m_playRequested)
    {
-      if (g_pvp->m_ps.bass_BG_idx != -1 && g_pvp->m_ps.bass_STD_idx != g_pvp->m_ps.bass_BG_idx) BASS_SetDevice(g_pvp->m_ps.bass_BG_idx);
+      SelectDevice();
       BASS_ChannelPlay(m_stream, 0);
    }
 }
 
 bool AudioPlayer::MusicActive()
 {
+   switch (m_musicState)
+   {
+   case MS_LOADING:
+      return true; // File is still being opened by the read-ahead thread
+
+   case MS_FAILED:
+      return false; // Error was logged when it happened, see MusicFailed()
+
+   default:
+      UpdateMusicStream();
+      break;
+   }
+
    if (m_stream)
    {
-      if (g_pvp->m_ps.bass_BG_idx != -1 && g_pvp->m_ps.bass_STD_idx != g_pvp->m_ps.bass_BG_idx) BASS_SetDevice(g_pvp->m_ps.bass_BG_idx);
-      return (BASS_ChannelIsActive(m_stream) == BASS_ACTIVE_PLAYING);
+      SelectDevice();
+      const DWORD active = BASS_ChannelIsActive(m_stream);
+      return (active == BASS_ACTIVE_PLAYING) || (active == BASS_ACTIVE_STALLED); // Stalled if the read-ahead thread did not keep up
    }
    else
       return false;
@@ -62,11 +133,12 @@ bool AudioPlayer::MusicActive()
 
 bool AudioPlayer::MusicInit(const string& szFileName, const float volume)
 {
-   if (g_pvp->m_ps.bass_BG_idx != -1 && g_pvp->m_ps.bass_STD_idx != g_pvp->m_ps.bass_BG_idx) BASS_SetDevice(g_pvp->m_ps.bass_BG_idx);
+   MusicClose();
 
+   // Only check for the file existence here, opening and decoding is performed by the read-ahead thread
+   string fileName;
    for (int i = 0; i < 5; ++i)
    {
-      string fileName;
       switch (i)
       {
       case 0: fileName = szFileName; break;
@@ -75,57 +147,175 @@ bool AudioPlayer::MusicInit(const string& szFileName, const float volume)
       case 3: fileName = g_pvp->m_currentTablePath + "music" + PATH_SEPARATOR_CHAR + szFileName; break;
       case 4: fileName = PATH_MUSIC + szFileName; break;
       }
-      m_stream = BASS_StreamCreateFile(FALSE, fileName.c_str(), 0, 0, /*BASS_SAMPLE_LOOP*/0); //!! ?
-      if (m_stream != 0)
+      if (FileExists(fileName))
          break;
+      fileName.clear();
    }
 
-   if (m_stream == 0)
+   if (fileName.empty())
    {
-      const int code = BASS_ErrorGetCode();
+      const int code = BASS_ERROR_FILEOPEN;
       string bla;
       BASS_ErrorMapCode(code, bla);
       g_pvp->MessageBox(("BASS music/sound library cannot load \"" + szFileName + "\" (error " + std::to_string(code) + ": " + bla + ')').c_str(), "Error", MB_ICONERROR);
       return false;
    }
 
-   BASS_ChannelSetAttribute(m_stream, BASS_ATTRIB_VOL, volume);
-   BASS_ChannelPlay(m_stream, 0);
+   m_volume = volume;
+   m_playRequested = true;
+   OpenMusic(fileName);
 
    return true;
 }
 
 void AudioPlayer::MusicVolume(const float volume)
 {
+   UpdateMusicStream();
+   m_volume = volume;
    if (m_stream)
    {
-      if(g_pvp->m_ps.bass_BG_idx != -1 && g_pvp->m_ps.bass_STD_idx != g_pvp->m_ps.bass_BG_idx) BASS_SetDevice(g_pvp->m_ps.bass_BG_idx);
+      SelectDevice();
       BASS_ChannelSetAttribute(m_stream, BASS_ATTRIB_VOL, volume);
    }
 }
 
 bool AudioPlayer::SetMusicFile(const string& szFileName)
 {
-   if (m_stream)
-      MusicClose();
-
-   m_stream = BASS_StreamCreateFile(FALSE, szFileName.c_str(), 0, 0, 0);
+   MusicClose();
 
-   if (m_stream == 0) {
-      const int code = BASS_ErrorGetCode();
+   if (!FileExists(szFileName)) {
+      const int code = BASS_ERROR_FILEOPEN;
       string message;
       BASS_ErrorMapCode(code, message);
       g_pvp->MessageBox(("BASS music/sound library cannot load \"" + szFileName + "\" (error " + std::to_string(code) + ": " + message + ')').c_str(), "Error", MB_ICONERROR);
       return false;
    }
 
+   m_playRequested = false;
+   OpenMusic(szFileName);
+
    return true;
 }
 
+void AudioPlayer::OpenMusic(const string& fileName)
+{
+   m_musicName = fileName;
+   m_bufferLength = (unsigned int)clamp(g_pvp->m_settings.GetValue(s_musicReadAheadSetting), 100, 60000);
+   m_musicState = MS_LOADING;
+   m_decodeThread = std::thread(&AudioPlayer::DecodeThread, this, fileName);
+}
+
+// Create the output stream once the read-ahead thread has opened the music file (and therefore knows its format)
+void AudioPlayer::UpdateMusicStream()
+{
+   if (m_stream || m_musicState != MS_READY)
+      return;
+
+   SelectDevice();
+   m_stream = BASS_StreamCreate(m_musicFrequency, m_musicChannels, BASS_SAMPLE_FLOAT, OutputStreamProc, this);
+   if (m_stream == 0)
+   {
+      SetMusicFailed(BASS_ErrorGetCode());
+      return;
+   }
+
+   BASS_ChannelSetAttribute(m_stream, BASS_ATTRIB_VOL, m_volume);
+   if (m_playRequested && !m_paused)
+      BASS_ChannelPlay(m_stream, 0);
+}
+
+// Called from the game thread or the read-ahead thread
+void AudioPlayer::SetMusicFailed(const int code)
+{
+   string message;
+   BASS_ErrorMapCode(code, message);
+   PLOGE << "BASS music/sound library cannot load \"" << m_musicName << "\" (error " << code << ": " << message << ')';
+   m_musicError = code;
+   m_musicState = MS_FAILED;
+}
+
+void AudioPlayer::DecodeThread(const string fileName)
+{
+   SelectDevice();
+   const HSTREAM decoder = BASS_StreamCreateFile(FALSE, fileName.c_str(), 0, 0, BASS_STREAM_DECODE | BASS_SAMPLE_FLOAT);
+   if (decoder == 0)
+   {
+      SetMusicFailed(BASS_ErrorGetCode());
+      return;
+   }
+
+   BASS_CHANNELINFO info;
+   if (!BASS_ChannelGetInfo(decoder, &info) || info.freq == 0 || info.chans == 0)
+   {
+      SetMusicFailed(BASS_ErrorGetCode());
+      BASS_StreamFree(decoder);
+      return;
+   }
+   m_musicFrequency = info.freq;
+   m_musicChannels = info.chans;
+   const DWORD bytesPerFrame = info.chans * (DWORD)sizeof(float);
+   vector<BYTE> chunk((info.freq / 50) * bytesPerFrame); // Decode by 20ms chunks
+   {
+      std::lock_guard<std::mutex> lock(m_bufferMutex);
+      m_bytesPerFrame = bytesPerFrame;
+      m_buffer.Resize(max((size_t)(((unsigned long long)info.freq * m_bufferLength) / 1000) * bytesPerFrame, 2 * chunk.size()));
+      m_prebufferSize = m_buffer.GetCapacity() / 2;
+      m_buffering = true;
+      m_decodeDone = false;
+   }
+   m_musicState = MS_READY;
+
+   std::unique_lock<std::mutex> lock(m_bufferMutex);
+   while (!m_exitDecode)
+   {
+      if (m_seekRequest >= 0.)
+      {
+         BASS_ChannelSetPosition(decoder, BASS_ChannelSeconds2Bytes(decoder, m_seekRequest), BASS_POS_BYTE);
+         m_seekRequest = -1.;
+         m_buffer.Clear();
+         m_buffering = true;
+         m_decodeDone = false;
+         continue;
+      }
+      if (m_decodeDone || m_buffer.GetFree() < chunk.size())
+      {
+         m_bufferCondition.wait(lock);
+         continue;
+      }
+      lock.unlock();
+      const DWORD read = BASS_ChannelGetData(decoder, chunk.data(), (DWORD)chunk.size());
+      lock.lock();
+      if (m_seekRequest >= 0.) // Discard data decoded before a seek request
+         continue;
+      if (read == (DWORD)-1) // End of file (or decoding error)
+         m_decodeDone = true;
+      else
+         m_buffer.Write(chunk.data(), read - read % bytesPerFrame);
+   }
+   lock.unlock();
+
+   BASS_StreamFree(decoder);
+}
+
+void AudioPlayer::StopDecodeThread()
+{
+   if (!m_decodeThread.joinable())
+      return;
+   {
+      std::lock_guard<std::mutex> lock(m_bufferMutex);
+      m_exitDecode = true;
+   }
+   m_bufferCondition.notify_all();
+   m_decodeThread.join();
+   m_exitDecode = false;
+}
+
 void AudioPlayer::MusicPlay()
 {
-   if (m_stream) {
-      if(g_pvp->m_ps.bass_BG_idx != -1 && g_pvp->m_ps.bass_STD_idx != g_pvp->m_ps.bass_BG_idx) BASS_SetDevice(g_pvp->m_ps.bass_BG_idx);
+   UpdateMusicStream();
+   m_playRequested = true;
+   if (m_stream && !m_paused) {
+      SelectDevice();
 
       BASS_ChannelPlay(m_stream, 0);
    }
@@ -133,8 +323,10 @@ void AudioPlayer::MusicPlay()
 
 void AudioPlayer::MusicStop()
 {
+   UpdateMusicStream();
+   m_playRequested = false;
    if (m_stream) {
-      if(g_pvp->m_ps.bass_BG_idx != -1 && g_pvp->m_ps.bass_STD_idx != g_pvp->m_ps.bass_BG_idx) BASS_SetDevice(g_pvp->m_ps.bass_BG_idx);
+      SelectDevice();
 
       BASS_ChannelStop(m_stream);
    }
@@ -143,40 +335,77 @@ void AudioPlayer::MusicStop()
 void AudioPlayer::MusicClose()
 {
    if (m_stream) {
-      if (g_pvp->m_ps.bass_BG_idx != -1 && g_pvp->m_ps.bass_STD_idx != g_pvp->m_ps.bass_BG_idx) BASS_SetDevice(g_pvp->m_ps.bass_BG_idx);
+      SelectDevice();
 
       BASS_ChannelStop(m_stream);
       BASS_StreamFree(m_stream);
 
       m_stream = 0;
    }
+
+   StopDecodeThread();
+
+   if (m_nUnderruns > 0 || m_nOverruns > 0)
+      PLOGI << "Audio stream closed with " << GetUnderrunCount() << " buffer underruns and " << GetOverrunCount() << " overruns";
+
+   m_musicState = MS_NONE;
+   m_positionBase = 0.;
+   m_seekRequest = -1.;
+   m_decodeDone = false;
+   m_buffering = true;
+   m_buffer.Clear();
+   m_nUnderruns = 0;
+   m_nOverruns = 0;
 }
 
 double AudioPlayer::GetMusicPosition()
 {
+   UpdateMusicStream();
    if (m_stream) {
-      if(g_pvp->m_ps.bass_BG_idx != -1 && g_pvp->m_ps.bass_STD_idx != g_pvp->m_ps.bass_BG_idx) BASS_SetDevice(g_pvp->m_ps.bass_BG_idx);
+      SelectDevice();
 
-      return BASS_ChannelBytes2Seconds(m_stream, BASS_ChannelGetPosition(m_stream, BASS_POS_BYTE));
+      return m_positionBase + BASS_ChannelBytes2Seconds(m_stream, BASS_ChannelGetPosition(m_stream, BASS_POS_BYTE));
    }
 
-   return -1;
+   return m_musicState == MS_LOADING ? m_positionBase : -1;
 }
 
 void AudioPlayer::SetMusicPosition(double seconds)
 {
+   UpdateMusicStream();
+   if (m_musicState != MS_LOADING && m_musicState != MS_READY)
+      return;
+
+   // Positions are tracked relative to the output stream, the read-ahead thread performs the seek and flushes its buffer
+   m_positionBase = seconds;
    if (m_stream) {
-      if(g_pvp->m_ps.bass_BG_idx != -1 && g_pvp->m_ps.bass_STD_idx != g_pvp->m_ps.bass_BG_idx) BASS_SetDevice(g_pvp->m_ps.bass_BG_idx);
+      SelectDevice();
 
-      BASS_ChannelSetPosition(m_stream, BASS_ChannelSeconds2Bytes(m_stream, seconds), BASS_POS_BYTE);
+      m_positionBase -= BASS_ChannelBytes2Seconds(m_stream, BASS_ChannelGetPosition(m_stream, BASS_POS_BYTE));
+   }
+   {
+      std::lock_guard<std::mutex> lock(m_bufferMutex);
+      m_seekRequest = max(seconds, 0.);
    }
+   m_bufferCondition.notify_all();
 }
 
 bool AudioPlayer::StreamInit(DWORD frequency, int channels, const float volume)
 {
-   if (g_pvp->m_ps.bass_BG_idx != -1 && g_pvp->m_ps.bass_STD_idx != g_pvp->m_ps.bass_BG_idx) BASS_SetDevice(g_pvp->m_ps.bass_BG_idx);
+   SelectDevice();
+
+   // Buffer pushed stream data, to absorb irregular updates of the producer
+   m_bufferLength = (unsigned int)clamp(g_pvp->m_settings.GetValue(s_streamBufferSetting), 10, 5000);
+   {
+      std::lock_guard<std::mutex> lock(m_bufferMutex);
+      m_bytesPerFrame = channels * (DWORD)sizeof(short);
+      m_buffer.Resize((size_t)(((unsigned long long)frequency * m_bufferLength) / 1000) * m_bytesPerFrame);
+      m_prebufferSize = m_buffer.GetCapacity() / 2;
+      m_buffering = true;
+      m_decodeDone = false;
+   }
 
-   m_stream = BASS_StreamCreate( frequency, channels, 0, STREAMPROC_PUSH, 0 );
+   m_stream = BASS_StreamCreate( frequency, channels, 0, OutputStreamProc, this );
 
    if (m_stream == 0) {
       const int code = BASS_ErrorGetCode();
@@ -186,16 +415,25 @@ bool AudioPlayer::StreamInit(DWORD frequency, int channels, const float volume)
       return false;
    }
 
+   m_volume = volume;
+   m_playRequested = true;
    BASS_ChannelSetAttribute(m_stream, BASS_ATTRIB_VOL, volume);
    BASS_ChannelPlay(m_stream, 0);
 
    return true;
 }
 
-void AudioPlayer::StreamUpdate(void* buffer, DWORD length) 
+void AudioPlayer::StreamUpdate(void* buffer, DWORD length)
 {
-   if (m_stream)
-      BASS_StreamPutData(m_stream, buffer, length);
+   if (m_stream == 0)
+      return;
+
+   std::lock_guard<std::mutex> lock(m_bufferMutex);
+   size_t toWrite = min((size_t)length, m_buffer.GetFree());
+   toWrite -= toWrite % m_bytesPerFrame;
+   m_buffer.Write(buffer, toWrite);
+   if (toWrite < length)
+      m_nOverruns++;
 }
 
 void AudioPlayer::StreamVolume(const float volume)
@@ -2,6 +2,36 @@
 
 #include "bass.h"
 
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Bounded byte ring buffer, between a producer (music decoder thread or PinMAME stream updates) and the audio output callback.
+// Not thread safe by itself, accesses are guarded by the owning AudioPlayer.
+class AudioRingBuffer final
+{
+public:
+   void Resize(const size_t capacity) { m_data.resize(capacity); Clear(); }
+   void Clear() { m_readPos = 0; m_size = 0; }
+   size_t GetSize() const { return m_size; }
+   size_t GetCapacity() const { return m_data.size(); }
+   size_t GetFree() const { return m_data.size() - m_size; }
+
+   size_t Write(const void* const data, const size_t size); // Returns the number of bytes actually written
+   size_t Read(void* const data, const size_t size); // Returns the number of bytes actually read
+
+private:
+   vector<BYTE> m_data;
+   size_t m_readPos = 0;
+   size_t m_size = 0;
+};
+
+// Music and stream player
+//
+// Audio is not directly decoded by the output stream: file music is opened and decoded by a read-ahead thread, and PinMAME/ROM
+// streams are pushed by the game thread, both filling a bounded ring buffer that the output stream drains. This way, opening
+// a large music file never stalls the game thread, and short hiccups of the producer are absorbed by the buffer.
 class AudioPlayer final
 {
 public:
@@ -11,6 +41,7 @@ public:
    bool MusicInit(const string& szFileName, const float volume);
 
    bool MusicActive();
+   bool MusicFailed() const { return m_musicState == MS_FAILED; } // Music could not be opened or decoded by the read-ahead thread (error is logged)
 
    //void MusicEnd();
 
@@ -31,6 +62,47 @@ public:
    void StreamUpdate(void* buffer, DWORD length);
    void StreamVolume(const float volume);
 
+   // Buffer statistics
+   unsigned int GetUnderrunCount() const { return m_nUnderruns.load(std::memory_order_relaxed); } // Output needed data while the buffer was empty
+   unsigned int GetOverrunCount() const { return m_nOverruns.load(std::memory_order_relaxed); } // Stream data dropped since the buffer was full
+
 private:
-   HSTREAM m_stream;
+   enum MusicState { MS_NONE, MS_LOADING, MS_READY, MS_FAILED };
+
+   void SelectDevice() const;
+   void OpenMusic(const string& fileName);
+   void UpdateMusicStream();
+   void SetMusicFailed(const int code);
+   void DecodeThread(const string fileName);
+   void StopDecodeThread();
+   DWORD ReadOutput(void* const buffer, const DWORD length);
+   static DWORD CALLBACK OutputStreamProc(HSTREAM handle, void* buffer, DWORD length, void* user);
+
+   HSTREAM m_stream; // Output stream, only accessed from the game thread
+   float m_volume = 1.f;
+   bool m_playRequested = false;
+   bool m_paused = false;
+   double m_positionBase = 0.; // Music position (in seconds) when the output stream position was 0
+
+   // Music read-ahead
+   string m_musicName;
+   std::thread m_decodeThread;
+   std::atomic<MusicState> m_musicState { MS_NONE };
+   std::atomic<int> m_musicError { 0 };
+   DWORD m_musicFrequency = 0;
+   DWORD m_musicChannels = 0;
+   bool m_exitDecode = false;
+   double m_seekRequest = -1.;
+   bool m_decodeDone = false;
+
+   // Buffer shared between the producer (decoder thread or game thread) and the output callback
+   std::mutex m_bufferMutex;
+   std::condition_variable m_bufferCondition;
+   AudioRingBuffer m_buffer;
+   DWORD m_bytesPerFrame = 1;
+   unsigned int m_bufferLength = 0; // Buffer depth in ms
+   size_t m_prebufferSize = 0; // Amount of data to buffer before (re)starting output
+   bool m_buffering = true;
+   std::atomic<unsigned int> m_nUnderruns { 0 };
+   std::atomic<unsigned int> m_nOverruns { 0 };
 };
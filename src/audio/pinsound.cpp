@@ -1,7 +1,10 @@
 #include "stdafx.h"
+#include "ThreadPool.h"
 
 float convert2decibelvolume(const float volume);
 
+static const Settings::IntSetting s_sound3DSetting = Settings::RegisterIntSetting(Settings::Player, "Sound3D"s, (int)SNDCFG_SND3D2CH);
+
 void BASS_ErrorMapCode(const int code, string& text)
 {
 	switch (code)
@@ -114,7 +117,7 @@ HRESULT PinSound::ReInitialize()
 
    if(!IsWav())
    {
-	   const SoundConfigTypes SoundMode3D = (m_outputTarget == SNDOUT_BACKGLASS) ? SNDCFG_SND3D2CH : (SoundConfigTypes)g_pvp->m_settings.LoadValueWithDefault(Settings::Player, "Sound3D"s, (int)SNDCFG_SND3D2CH);
+	   const SoundConfigTypes SoundMode3D = (m_outputTarget == SNDOUT_BACKGLASS) ? SNDCFG_SND3D2CH : (SoundConfigTypes)g_pvp->m_settings.GetValue(s_sound3DSetting);
 
 	   SetBassDevice();
 	   m_BASSstream = BASS_StreamCreateFile(
@@ -150,7 +153,7 @@ HRESULT PinSound::ReInitialize()
       return E_FAIL;
    }
 
-   const SoundConfigTypes SoundMode3D = (m_outputTarget == SNDOUT_BACKGLASS) ? SNDCFG_SND3D2CH : (SoundConfigTypes)g_pvp->m_settings.LoadValueWithDefault(Settings::Player, "Sound3D"s, (int)SNDCFG_SND3D2CH);
+   const SoundConfigTypes SoundMode3D = (m_outputTarget == SNDOUT_BACKGLASS) ? SNDCFG_SND3D2CH : (SoundConfigTypes)g_pvp->m_settings.GetValue(s_sound3DSetting);
 
    WAVEFORMATEX wfx = m_wfx;  // Use a copy as we might be modifying it
    // Remark from MSDN: "If wFormatTag = WAVE_FORMAT_PCM or wFormatTag = WAVE_FORMAT_IEEE_FLOAT, set cbSize to zero"
@@ -268,40 +271,40 @@ void PinSound::Play(const float volume, const float randompitch, const int pitch
          BASS_ChannelSetAttribute(m_BASSstream, BASS_ATTRIB_FREQ, freq);
       }
 
-      const SoundConfigTypes SoundMode3D = (m_outputTarget == SNDOUT_BACKGLASS) ? SNDCFG_SND3D2CH : (SoundConfigTypes)g_pvp->m_settings.LoadValueWithDefault(Settings::Player, "Sound3D"s, (int)SNDCFG_SND3D2CH);
+      const SoundConfigTypes SoundMode3D = (m_outputTarget == SNDOUT_BACKGLASS) ? SNDCFG_SND3D2CH : (SoundConfigTypes)g_pvp->m_settings.GetValue(s_sound3DSetting);
       switch (SoundMode3D)
       {
       case SNDCFG_SND3DALLREAR:
       {
-         const BASS_3DVECTOR v(PinDirectSound::PanTo3D(pan), 0.0f, -PinDirectSound::PanTo3D(1.0f));
+         const BASS_3DVECTOR v(PanTo3D(pan), 0.0f, -PanTo3D(1.0f));
          BASS_ChannelSet3DPosition(m_BASSstream, &v, nullptr, nullptr);
          BASS_Apply3D();
          break;
       }
       case SNDCFG_SND3DFRONTISFRONT:
       {
-         const BASS_3DVECTOR v(PinDirectSound::PanTo3D(pan), 0.0f, PinDirectSound::PanTo3D(front_rear_fade));
+         const BASS_3DVECTOR v(PanTo3D(pan), 0.0f, PanTo3D(front_rear_fade));
          BASS_ChannelSet3DPosition(m_BASSstream, &v, nullptr, nullptr);
          BASS_Apply3D();
          break;
       }
       case SNDCFG_SND3DFRONTISREAR:
       {
-         const BASS_3DVECTOR v(PinDirectSound::PanTo3D(pan), 0.0f, -PinDirectSound::PanTo3D(front_rear_fade));
+         const BASS_3DVECTOR v(PanTo3D(pan), 0.0f, -PanTo3D(front_rear_fade));
          BASS_ChannelSet3DPosition(m_BASSstream, &v, nullptr, nullptr);
          BASS_Apply3D();
          break;
       }
       case SNDCFG_SND3D6CH:
       {
-         const BASS_3DVECTOR v(PinDirectSound::PanTo3D(pan), 0.0f, -((PinDirectSound::PanTo3D(front_rear_fade) + 3.0f) / 2.0f));
+         const BASS_3DVECTOR v(PanTo3D(pan), 0.0f, -((PanTo3D(front_rear_fade) + 3.0f) / 2.0f));
          BASS_ChannelSet3DPosition(m_BASSstream, &v, nullptr, nullptr);
          BASS_Apply3D();
          break;
       }
       case SNDCFG_SND3DSSF:
       {
-         const BASS_3DVECTOR v(PinDirectSound::PanSSF(pan), 0.0f, PinDirectSound::FadeSSF(front_rear_fade));
+         const BASS_3DVECTOR v(PanSSF(pan), 0.0f, FadeSSF(front_rear_fade));
          BASS_ChannelSet3DPosition(m_BASSstream, &v, nullptr, nullptr);
          BASS_Apply3D();
          break;
@@ -329,8 +332,69 @@ void PinSound::Play(const float volume, const float randompitch, const int pitch
    }
 }
 
+bool PinSound::DecodeForMixer(const unsigned int sampleRate, const float maxLength, vector<float>& pcm, unsigned int& nChannels)
+{
+   if (m_pdata == nullptr)
+      return false;
+
+   if (IsWav())
+   {
+      if ((m_wfx.wFormatTag != WAVE_FORMAT_PCM && m_wfx.wFormatTag != WAVE_FORMAT_IEEE_FLOAT) || m_wfx.nAvgBytesPerSec == 0 || (float)m_cdata > maxLength * (float)m_wfx.nAvgBytesPerSec)
+         return false;
+      nChannels = m_wfx.nChannels;
+      return AudioMixerSample::ConvertPCM(m_pdata, m_cdata, m_wfx.nChannels, m_wfx.nSamplesPerSec, m_wfx.wBitsPerSample, m_wfx.wFormatTag == WAVE_FORMAT_IEEE_FLOAT, sampleRate, pcm);
+   }
+
+   // Decode the whole file to float PCM using BASS
+   bool success = false;
+   SetBassDevice();
+   const HSTREAM decoder = BASS_StreamCreateFile(TRUE, m_pdata, 0, m_cdata, BASS_STREAM_DECODE | BASS_SAMPLE_FLOAT);
+   if (decoder)
+   {
+      BASS_CHANNELINFO info;
+      const QWORD length = BASS_ChannelGetLength(decoder, BASS_POS_BYTE);
+      if (BASS_ChannelGetInfo(decoder, &info) && length != (QWORD)-1 && length > 0 && BASS_ChannelBytes2Seconds(decoder, length) <= (double)maxLength)
+      {
+         vector<float> decoded((size_t)(length / sizeof(float)));
+         const DWORD read = BASS_ChannelGetData(decoder, decoded.data(), (DWORD)(decoded.size() * sizeof(float)));
+         if (read != (DWORD)-1)
+         {
+            nChannels = info.chans;
+            success = AudioMixerSample::ConvertPCM(decoded.data(), read, info.chans, info.freq, 32, true, sampleRate, pcm);
+         }
+      }
+      BASS_StreamFree(decoder);
+   }
+   return success;
+}
+
+void PinSound::SetMixerSample(const std::shared_ptr<AudioMixerSample>& sample)
+{
+   m_mixerSample = sample;
+   m_mixerUnsupported = (sample == nullptr);
+}
+
+std::shared_ptr<AudioMixerSample> PinSound::GetMixerSample()
+{
+   const AudioMixer* const mixer = g_pvp->m_ps.GetMixer();
+   if (m_mixerSample != nullptr || m_mixerUnsupported || mixer == nullptr)
+      return m_mixerSample;
+
+   // Sound was not decoded at load time (sound added after load, or table loaded before the mixer was enabled)
+   vector<float> pcm;
+   unsigned int nChannels;
+   if (DecodeForMixer(mixer->GetSampleRate(), g_pvp->m_ps.GetMixerStreamLength(), pcm, nChannels))
+      SetMixerSample(AudioMixerSample::Create(std::move(pcm), nChannels, mixer->GetSampleRate()));
+   else
+      SetMixerSample(nullptr);
+   return m_mixerSample;
+}
+
 void PinSound::Stop()
 {
+   if (g_pvp->m_ps.GetMixer())
+      g_pvp->m_ps.GetMixer()->Stop(this);
+
    if (IsWav())
       StopInternal();
    else
@@ -402,7 +466,7 @@ void PinDirectSound::InitDirectSound(const HWND hwnd, const bool IsBackglass)
       return;// hr;
    }
 
-   const SoundConfigTypes SoundMode3D = (SoundConfigTypes)g_pvp->m_settings.LoadValueWithDefault(Settings::Player, "Sound3D"s, (int)SNDCFG_SND3D2CH);
+   const SoundConfigTypes SoundMode3D = (SoundConfigTypes)g_pvp->m_settings.GetValue(s_sound3DSetting);
 
    // Get the primary buffer 
    DSBUFFERDESC dsbd = {};
@@ -462,7 +526,7 @@ void AudioMusicPlayer::InitPinDirectSound(const Settings& settings, const HWND h
 {
    const int DSidx1 = settings.LoadValueWithDefault(Settings::Player, "SoundDevice"s, 0);
    const int DSidx2 = settings.LoadValueWithDefault(Settings::Player, "SoundDeviceBG"s, 0);
-   const SoundConfigTypes SoundMode3D = (SoundConfigTypes)settings.LoadValueWithDefault(Settings::Player, "Sound3D"s, (int)SNDCFG_SND3D2CH);
+   const SoundConfigTypes SoundMode3D = (SoundConfigTypes)settings.GetValue(s_sound3DSetting);
 
    //---- Initialize BASS Audio Library
 
@@ -539,6 +603,175 @@ void AudioMusicPlayer::InitPinDirectSound(const Settings& settings, const HWND h
       m_pbackglassds = new PinDirectSound();
       m_pbackglassds->InitDirectSound(hwnd, true);
    }
+
+   InitMixer(settings);
+}
+
+static DWORD CALLBACK MixerStreamProc(HSTREAM handle, void* buffer, DWORD length, void* user)
+{
+   AudioMixer* const mixer = static_cast<AudioMixer*>(user);
+   mixer->Render(static_cast<float*>(buffer), length / (mixer->GetChannelCount() * (DWORD)sizeof(float)));
+   return length;
+}
+
+void AudioMusicPlayer::InitMixer(const Settings& settings)
+{
+   ReleaseMixer();
+
+   // 0 = disabled, 1 = audio device output, 2 = null output (discarded, for benchmarking), 3 = WAV file output
+   const int mixerMode = settings.LoadValueWithDefault(Settings::Player, "SoundMixer"s, 0);
+   if (mixerMode <= 0)
+      return;
+   const SoundConfigTypes SoundMode3D = (SoundConfigTypes)settings.GetValue(s_sound3DSetting);
+   const unsigned int nVoices = (unsigned int)clamp(settings.LoadValueWithDefault(Settings::Player, "SoundMixerVoices"s, 64), 1, 1024);
+   const unsigned int nChannels = (SoundMode3D == SNDCFG_SND3D2CH) ? 2 : 6;
+   constexpr unsigned int sampleRate = 44100;
+   m_mixerStreamLength = settings.LoadValueWithDefault(Settings::Player, "SoundMixerStreamLength"s, 10.f);
+   m_mixer = new AudioMixer(SoundMode3D, nChannels, sampleRate, nVoices);
+   m_mixerStolenVoices = 0;
+   switch (mixerMode)
+   {
+   case 1:
+      if (bass_STD_idx != -1 && bass_STD_idx != bass_BG_idx) BASS_SetDevice(bass_STD_idx);
+      m_mixerStream = BASS_StreamCreate(sampleRate, nChannels, BASS_SAMPLE_FLOAT, MixerStreamProc, m_mixer);
+      if (m_mixerStream == 0)
+      {
+         const int code = BASS_ErrorGetCode();
+         string bla;
+         BASS_ErrorMapCode(code, bla);
+         PLOGE << "Failed to create software mixer output stream, error " << code << ": " << bla;
+         delete m_mixer;
+         m_mixer = nullptr;
+         return;
+      }
+      BASS_ChannelPlay(m_mixerStream, FALSE);
+      {
+         // Mixed samples are appended to the stream playback buffer, so they are heard after the buffer length and the device latency
+         BASS_INFO info;
+         const DWORD deviceLatency = BASS_GetInfo(&info) ? info.latency : 0;
+         m_mixer->SetOutputLatency((unsigned int)(BASS_GetConfig(BASS_CONFIG_BUFFER) + deviceLatency) * 1000u);
+      }
+      break;
+   case 2:
+      m_mixer->StartThread(std::make_unique<NullAudioMixerSink>(sampleRate, true), 512);
+      break;
+   default:
+   {
+      const string path = g_pvp->m_szMyPrefPath + "SoundMixer.wav";
+      std::unique_ptr<FileAudioMixerSink> sink = std::make_unique<FileAudioMixerSink>(path, nChannels, sampleRate);
+      if (!sink->IsOpen())
+         PLOGE << "Failed to create audio output file: " << path;
+      m_mixer->StartThread(std::move(sink), 512);
+      break;
+   }
+   }
+   PLOGI << "Software sound mixer initialized [" << nChannels << " channels, " << nVoices << " voices]";
+}
+
+void AudioMusicPlayer::ReleaseMixer()
+{
+   if (m_mixerStream)
+   {
+      if (bass_STD_idx != -1 && bass_STD_idx != bass_BG_idx) BASS_SetDevice(bass_STD_idx);
+      BASS_StreamFree(m_mixerStream);
+      m_mixerStream = 0;
+   }
+   delete m_mixer;
+   m_mixer = nullptr;
+}
+
+void AudioMusicPlayer::PreloadMixerSamples(const vector<PinSound*>& sounds)
+{
+   if (m_mixer == nullptr || sounds.empty())
+      return;
+
+   const unsigned long long start = usec();
+   const unsigned int sampleRate = m_mixer->GetSampleRate();
+   struct DecodedSound
+   {
+      vector<float> pcm;
+      unsigned int nChannels = 0;
+      bool success = false;
+   };
+   vector<DecodedSound> decoded(sounds.size());
+   std::atomic<unsigned long long> decodeTime { 0 };
+   {
+      ThreadPool pool(g_pvp->m_logicalNumberOfProcessors);
+      for (size_t i = 0; i < sounds.size(); i++)
+      {
+         if (sounds[i]->GetOutputTarget() != SNDOUT_TABLE) // Only table sounds are played by the mixer
+            continue;
+         pool.enqueue([i, sampleRate, &sounds, &decoded, &decodeTime, this] {
+            const unsigned long long decodeStart = usec();
+            decoded[i].success = sounds[i]->DecodeForMixer(sampleRate, m_mixerStreamLength, decoded[i].pcm, decoded[i].nChannels);
+            decodeTime += usec() - decodeStart;
+         });
+      }
+      pool.wait_until_nothing_in_flight();
+   }
+
+   // Gather all decoded sounds in a single arena to avoid fragmentation and improve memory locality
+   vector<std::shared_ptr<AudioMixerSample>> samples;
+   samples.reserve(sounds.size());
+   unsigned int nStreamed = 0;
+   for (size_t i = 0; i < sounds.size(); i++)
+   {
+      if (sounds[i]->GetOutputTarget() != SNDOUT_TABLE)
+         continue;
+      if (decoded[i].success)
+      {
+         samples.push_back(AudioMixerSample::Create(std::move(decoded[i].pcm), decoded[i].nChannels, sampleRate));
+         sounds[i]->SetMixerSample(samples.back());
+      }
+      else
+      {
+         sounds[i]->SetMixerSample(nullptr);
+         nStreamed++;
+      }
+   }
+   const size_t arenaSize = AudioMixerSample::PackInArena(samples);
+
+   PLOGI << "Sounds decoded for software mixer: " << samples.size() << " sounds, " << (arenaSize / 1024) << "KiB at " << sampleRate << "Hz, "
+         << nStreamed << " sounds left streaming, " << ((usec() - start) / 1000) << "ms (" << (decodeTime / 1000) << "ms decoding)"; // For profiling
+}
+
+void AudioMusicPlayer::UpdateFrameProfiler()
+{
+   if (m_mixer == nullptr)
+      return;
+   g_frameProfiler.SetCounter(FrameProfiler::PROFILE_AUDIO_VOICES, m_mixer->GetActiveVoiceCount());
+   const unsigned int stolenVoices = m_mixer->GetStolenVoiceCount();
+   g_frameProfiler.SetCounter(FrameProfiler::PROFILE_AUDIO_STEALS, stolenVoices - m_mixerStolenVoices);
+   m_mixerStolenVoices = stolenVoices;
+   const unsigned int latency = m_mixer->TakeMaxPlayLatency();
+   if (latency > 0)
+      g_frameProfiler.OnSoundLatency(latency);
+}
+
+void AudioMusicPlayer::StopMixerVoices()
+{
+   if (m_mixer)
+      m_mixer->StopAll();
+}
+
+bool AudioMusicPlayer::PlayMixer(PinSound * const pps, const float volume, const float randompitch, const int pitch, const float pan, const float front_rear_fade, const int flags, const bool usesame, const bool restart)
+{
+   const std::shared_ptr<AudioMixerSample> sample = pps->GetMixerSample();
+   if (sample == nullptr) // Unsupported format, use the legacy playback
+      return false;
+
+   // Same pitch computation as the BASS playback
+   const float baseFreq = (float)sample->m_sampleRate;
+   float freq = baseFreq + (float)pitch;
+   if (randompitch > 0.f)
+   {
+      const float rndh = rand_mt_01();
+      const float rndl = rand_mt_01();
+      freq += (freq * randompitch * rndh * rndh) - (freq * randompitch * rndl * rndl * 0.5f);
+   }
+
+   m_mixer->Play(pps, sample, volume, freq / baseFreq, pan, front_rear_fade, (flags & DSBPLAY_LOOPING) != 0, usesame, restart);
+   return true;
 }
 
 PinSound *AudioMusicPlayer::LoadFile(const string& strFileName)
@@ -562,7 +795,7 @@ PinSound *AudioMusicPlayer::LoadFile(const string& strFileName)
 		   return nullptr;
 	   }
 
-	   const SoundConfigTypes SoundMode3D = (SoundConfigTypes)g_pvp->m_settings.LoadValueWithDefault(Settings::Player, "Sound3D"s, (int)SNDCFG_SND3D2CH);
+	   const SoundConfigTypes SoundMode3D = (SoundConfigTypes)g_pvp->m_settings.GetValue(s_sound3DSetting);
 
 	   // Set up the direct sound buffer, and only request the flags needed
 	   // since each requires some overhead and limits if the buffer can
@@ -647,7 +880,7 @@ PinSound *AudioMusicPlayer::LoadFile(const string& strFileName)
 	   fread_s(pps->m_pdata, pps->m_cdata, 1, pps->m_cdata, f);
 	   fclose(f);
 
-	   const SoundConfigTypes SoundMode3D = (pps->GetOutputTarget() == SNDOUT_BACKGLASS) ? SNDCFG_SND3D2CH : (SoundConfigTypes)g_pvp->m_settings.LoadValueWithDefault(Settings::Player, "Sound3D"s, (int)SNDCFG_SND3D2CH);
+	   const SoundConfigTypes SoundMode3D = (pps->GetOutputTarget() == SNDOUT_BACKGLASS) ? SNDCFG_SND3D2CH : (SoundConfigTypes)g_pvp->m_settings.GetValue(s_sound3DSetting);
 
 	   pps->SetBassDevice();
 	   pps->m_BASSstream = BASS_StreamCreateFile(
@@ -676,179 +909,6 @@ PinSound *AudioMusicPlayer::LoadFile(const string& strFileName)
    return pps;
 }
 
-// The existing pan value in PlaySound function takes a -1 to 1 value, however it's extremely non-linear.
-// -0.1 is very obviously to the left.  Table scripts like the ball rolling script seem to use x^10 to map
-// linear positions, so we'll use that and reverse it.   Also multiplying by 3 since that seems to be the
-// the total distance necessary to fully pan away from one side at the center of the room.
-
-float PinDirectSound::PanTo3D(float input)
-{
-	// DirectSound's position command does weird things at exactly 0. 
-	if (fabsf(input) < 0.0001f)
-		input = (input < 0.0f) ? -0.0001f : 0.0001f;
-	if (input < 0.0f)
-	{
-		return -powf(-max(input, -1.0f), (float)(1.0 / 10.0)) * 3.0f;
-	}
-	else
-	{
-		return powf(min(input, 1.0f), (float)(1.0 / 10.0)) * 3.0f;
-	}
-}
-
-// This is a replacement function for PanTo3D() for sound effect panning (audio x-axis).
-// It performs the same calculations but maps the resulting values to an area of the 3D 
-// sound stage that has the expected panning effect for this application. It is written 
-// in a long form to facilitate tweaking the formulas.  *njk*
-
-float PinDirectSound::PanSSF(float pan)
-{
-	// This math could probably be simplified but it is kept in long form
-	// to aide in fine tuning and clarity of function.
-
-	// Clip the pan input range to -1.0 to 1.0
-	float x = clamp(pan, -1.f, 1.f);
-
-	// Rescale pan range from an exponential [-1,0] and [0,1] to a linear [-1.0, 1.0]
-	// Do not avoid values close to zero like PanTo3D() does as that
-	// prevents the middle range of the exponential curves converting back to 
-	// a linear scale (which would leave a gap in the center of the range).
-	// This basically undoes the Pan() fading function in the table scripts.
-
-	x = (x < 0.0f) ? -powf(-x, 0.1f) : powf(x, 0.1f);
-
-	// Increase the pan range from [-1.0, 1.0] to [-3.0, 3.0] to improve the surround sound fade effect
-
-	x *= 3.0f;
-
-	// BASS pan effect is much better than VPX 10.6/DirectSound3d but it
-	// could still stand a little enhancement to exaggerate the effect.
-	// The effect goal is to place slingshot effects almost entirely left/right
-	// and flipper effects in the cross fade region (louder on their corresponding
-	// sides but still audible on the opposite side..)
-
-	// Rescale [-3.0,0.0) to [-3.00,-2.00] and [0,3.0] to [2.00,3.00]
-
-	// Reminder: Linear Conversion Formula [o1,o2] to [n1,n2]
-	// x' = ( (x - o1) / (o2 - o1) ) * (n2 - n1) + n1
-	//
-	// We retain the full formulas below to make it easier to tweak the values.
-	// The compiler will optimize away the excess math.
-
-	if (x >= 0.0f)
-		x = ((x -  0.0f) / (3.0f -  0.0f)) * ( 3.0f -  2.0f) +  2.0f;
-	else
-		x = ((x - -3.0f) / (0.0f - -3.0f)) * (-2.0f - -3.0f) + -2.0f;
-
-	// Clip the pan output range to 3.0 to -3.0
-	//
-	// This probably can never happen but is here in case the formulas above
-	// change or there is a rounding issue.
-
-	if (x > 3.0f)
-		x = 3.0f;
-	else if (x < -3.0f)
-		x = -3.0f;
-
-	// If the final value is sufficiently close to zero it causes sound to come from
-	// all speakers and lose it's positional effect. We scale well away from zero
-	// above but will keep this check to document the effect or catch the condition
-	// if the formula above is later changed to one that can result in x = 0.0.
-
-	// NOTE: This no longer seems to be the case with VPX 10.7/BASS
-
-	// HOWEVER: Weird things still happen NEAR 0.0 or if both x and z are at 0.0.
-	//          So we keep the fix here with wider margins to prevent that case.
-	//          The current formula won't produce values in this weird range.
-
-	if (fabsf(x) < 0.1f)
-		x = (x < 0.0f) ? -0.1f : 0.1f;
-
-	return x;
-}
-
-// This is a replacement function for PanTo3D() for sound effect fading (audio z-axis).
-// It performs the same calculations but maps the resulting values to 
-// an area of the 3D sound stage that has the expected fading
-// effect for this application. It is written in a long form to facilitate tweaking the 
-// values (which turned out to be more straightforward than originally coded). *njk*
-
-float PinDirectSound::FadeSSF(float front_rear_fade)
-{
-	float z = 0.0f;
-
-	// Clip the fade input range to -1.0 to 1.0
-
-	if (front_rear_fade < -1.0f)
-		z = -1.0f;
-	else if (front_rear_fade > 1.0f)
-		z = 1.0f;
-	else
-		z = front_rear_fade;
-
-	// Rescale fade range from an exponential [0,-1] and [0,1] to a linear [-1.0, 1.0]
-	// Do not avoid values close to zero like PanTo3D() does at this point as that
-	// prevents the middle range of the exponential curves converting back to 
-	// a linear scale (which would leave a gap in the center of the range).
-	// This basically undoes the AudioFade() fading function in the table scripts.	
-
-	z = (z < 0.0f) ? -powf(-z, 0.1f) : powf(z, 0.1f);
-
-	// Increase the fade range from [-1.0, 1.0] to [-3.0, 3.0] to improve the surround sound fade effect
-
-	z *= 3.0f;
-
-	// Rescale fade range from [-3.0,3.0] to [0.0,-2.5] in an attempt to remove all sound from
-	// the surround sound front (backbox) speakers and place them close to the surround sound
-	// side (cabinet rear) speakers.
-	//
-	// Reminder: Linear Conversion Formula [o1,o2] to [n1,n2]
-	// z' = ( (z - o1) / (o2 - o1) ) * (n2 - n1) + n1
-	//
-	// We retain the full formulas below to make it easier to tweak the values.
-	// The compiler will optimize away the excess math.
-
-	// Rescale to -2.5 instead of -3.0 to further push sound away from rear channels
-	z = ((z - -3.0f) / (3.0f - -3.0f)) * (-2.5f - 0.0f) + 0.0f;
-
-	// With BASS the above scaling is sufficient to keep the playfield sounds out of 
-	// the backbox. However playfield sounds are heavily weighted to the rear channels. 
-	// For BASS we do a simple scale of the top third [0,-1.0] BY 0.10 to favor
-	// the side channels. This is better than we could do in VPX 10.6 where z just
-	// had to be set to 0.0 as there was no fade range that didn't leak to the backbox
-	// as well.
-	
-	if (z > -1.0f)
-		z = z / 10.0f;
-
-	// Clip the fade output range to 0.0 to -3.0
-	//
-	// This probably can never happen but is here in case the formulas above
-	// change or there is a rounding issue. A result even slightly greater
-	// than zero can bleed to the backbox speakers.
-
-	if (z > 0.0f)
-		z = 0.0f;
-	else if (z < -3.0f)
-		z = -3.0f;
-
-	// If the final value is sufficiently close to zero it causes sound to come from
-	// all speakers on some systems and lose it's positional effect. We do use 0.0 
-	// above and could set the safe value there. Instead will keep this check to document 
-	// the effect or catch the condition if the formula/conditions above are later changed
-
-	// NOTE: This no longer seems to be the case with VPX 10.7/BASS
-
-	// HOWEVER: Weird things still happen near 0.0 or if both x and z are at 0.0.
-	//          So we keep the fix here to prevent that case. This does push a tiny bit 
-	//          of audio to the rear channels but that is perfectly ok.
-
-	if (fabsf(z) < 0.0001f)
-		z = -0.0001f;
-	
-	return z;
-}
-
 PinDirectSoundWavCopy::PinDirectSoundWavCopy(class PinSound * const pOriginal)
 {
 	m_ppsOriginal = pOriginal;
@@ -887,24 +947,24 @@ void PinDirectSoundWavCopy::PlayInternal(const float volume, const float randomp
 		}
 	}
 
-	const SoundConfigTypes SoundMode3D = (m_ppsOriginal->GetOutputTarget() == SNDOUT_BACKGLASS) ? SNDCFG_SND3D2CH : (SoundConfigTypes)g_pvp->m_settings.LoadValueWithDefault(Settings::Player, "Sound3D"s, (int)SNDCFG_SND3D2CH);
+	const SoundConfigTypes SoundMode3D = (m_ppsOriginal->GetOutputTarget() == SNDOUT_BACKGLASS) ? SNDCFG_SND3D2CH : (SoundConfigTypes)g_pvp->m_settings.GetValue(s_sound3DSetting);
 
 	switch (SoundMode3D)
 	{
 	case SNDCFG_SND3DALLREAR:
-		m_pDS3DBuffer->SetPosition(PinDirectSound::PanTo3D(pan), 0.0f, -PinDirectSound::PanTo3D(1.0f), DS3D_IMMEDIATE);
+		m_pDS3DBuffer->SetPosition(PanTo3D(pan), 0.0f, -PanTo3D(1.0f), DS3D_IMMEDIATE);
 		break;
 	case SNDCFG_SND3DFRONTISFRONT:
-		m_pDS3DBuffer->SetPosition(PinDirectSound::PanTo3D(pan), 0.0f, PinDirectSound::PanTo3D(front_rear_fade), DS3D_IMMEDIATE);
+		m_pDS3DBuffer->SetPosition(PanTo3D(pan), 0.0f, PanTo3D(front_rear_fade), DS3D_IMMEDIATE);
 		break;
 	case SNDCFG_SND3DFRONTISREAR:
-		m_pDS3DBuffer->SetPosition(PinDirectSound::PanTo3D(pan), 0.0f, -PinDirectSound::PanTo3D(front_rear_fade), DS3D_IMMEDIATE);
+		m_pDS3DBuffer->SetPosition(PanTo3D(pan), 0.0f, -PanTo3D(front_rear_fade), DS3D_IMMEDIATE);
 		break;
 	case SNDCFG_SND3D6CH:
-		m_pDS3DBuffer->SetPosition(PinDirectSound::PanTo3D(pan), 0.0f, -((PinDirectSound::PanTo3D(front_rear_fade) + 3.0f) / 2.0f), DS3D_IMMEDIATE);
+		m_pDS3DBuffer->SetPosition(PanTo3D(pan), 0.0f, -((PanTo3D(front_rear_fade) + 3.0f) / 2.0f), DS3D_IMMEDIATE);
 		break;
 	case SNDCFG_SND3DSSF:
-		m_pDS3DBuffer->SetPosition(PinDirectSound::PanSSF(pan), 0.0f, PinDirectSound::FadeSSF(front_rear_fade), DS3D_IMMEDIATE);
+		m_pDS3DBuffer->SetPosition(PanSSF(pan), 0.0f, FadeSSF(front_rear_fade), DS3D_IMMEDIATE);
 		break;
 	case SNDCFG_SND3D2CH:
 	default:
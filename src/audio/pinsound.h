@@ -6,6 +6,7 @@
 #define AFX_PINSOUND_H__61491D0B_9950_480C_B453_911B3A2CDB8E__INCLUDED_
 
 #include "core/Settings.h"
+#include "audio/soundpan.h"
 
 void BASS_ErrorMapCode(const int code, string& text);
 
@@ -27,9 +28,10 @@ typedef vector<DSAudioDevice*> DSAudioDevices;
 
 BOOL CALLBACK DSEnumCallBack(LPGUID guid, LPCSTR desc, LPCSTR mod, LPVOID list);
 
+class AudioMixer;
+struct AudioMixerSample;
+
 enum SoundOutTypes : char { SNDOUT_TABLE = 0, SNDOUT_BACKGLASS = 1 };
-enum SoundConfigTypes : int { SNDCFG_SND3D2CH = 0, SNDCFG_SND3DALLREAR = 1, SNDCFG_SND3DFRONTISREAR = 2, 
-                              SNDCFG_SND3DFRONTISFRONT = 3, SNDCFG_SND3D6CH = 4, SNDCFG_SND3DSSF = 5};
 
 // Surround modes
 // ==============
@@ -106,6 +108,11 @@ public:
    void Play(const float volume, const float randompitch, const int pitch, const float pan, const float front_rear_fade, const int flags, const bool restart);
    void Stop();
 
+   // Decoded PCM data for the software mixer (decoded at load time or on first use), nullptr if the sound is played by the legacy playback (unsupported format or long sound left streaming)
+   std::shared_ptr<AudioMixerSample> GetMixerSample();
+   void SetMixerSample(const std::shared_ptr<AudioMixerSample>& sample);
+   bool DecodeForMixer(const unsigned int sampleRate, const float maxLength, vector<float>& pcm, unsigned int& nChannels);
+
    union
    {
       class PinDirectSound *m_pPinDirectSound;
@@ -136,6 +143,8 @@ public:
 
 private:
    SoundOutTypes m_outputTarget;
+   std::shared_ptr<AudioMixerSample> m_mixerSample;
+   bool m_mixerUnsupported = false;
 };
 
 
@@ -147,9 +156,6 @@ public:
    ~PinDirectSound();
 
    void InitDirectSound(const HWND hwnd, const bool IsBackglass);
-   static float PanTo3D(float input);
-   static float PanSSF(float input);
-   static float FadeSSF(float input);
 
    LPDIRECTSOUND m_pDS;
 
@@ -164,6 +170,7 @@ public:
 	AudioMusicPlayer() : m_pbackglassds(nullptr) {}
 	~AudioMusicPlayer()
 	{
+		ReleaseMixer();
 		if (m_pbackglassds != &m_pds) delete m_pbackglassds;
       BASS_Stop();
       BASS_Free();
@@ -173,6 +180,7 @@ public:
 
 	void ReInitPinDirectSound(const Settings& settings, const HWND hwnd)
 	{
+		ReleaseMixer();
 		if (m_pbackglassds != &m_pds) delete m_pbackglassds;
       BASS_Stop();
       BASS_Free();
@@ -200,12 +208,14 @@ public:
 
 	void StopCopiedWavs()
 	{
+		StopMixerVoices();
 		for (size_t i = 0; i < m_copiedwav.size(); i++)
 			m_copiedwav[i]->m_pDSBuffer->Stop();
 	}
 
 	void StopAndClearCopiedWavs()
 	{
+		StopMixerVoices();
 		for (size_t i = 0; i < m_copiedwav.size(); i++)
 		{
 			m_copiedwav[i]->m_pDSBuffer->Stop();
@@ -238,6 +248,9 @@ public:
 	{
 		const int flags = (loopcount == -1) ? DSBPLAY_LOOPING : 0;
 
+		if (m_mixer && pps->GetOutputTarget() == SNDOUT_TABLE && PlayMixer(pps, volume, randompitch, pitch, pan, front_rear_fade, flags, usesame, restart))
+			return;
+
 		if (!pps->IsWav())
 		{
 #ifdef ONLY_USE_BASS
@@ -289,7 +302,23 @@ public:
 
    int bass_STD_idx = -2, bass_BG_idx = -2;
 
+   // Software mixer, used for table sounds instead of DirectSound/BASS voices if enabled
+   AudioMixer* GetMixer() const { return m_mixer; }
+   float GetMixerStreamLength() const { return m_mixerStreamLength; }
+   void StopMixerVoices();
+   void UpdateFrameProfiler(); // Report software mixer voice/latency statistics of the ending frame
+   void PreloadMixerSamples(const vector<PinSound*>& sounds); // Decode short sounds on a thread pool to a contiguous PCM arena
+
 private:
+   void InitMixer(const Settings& settings);
+   void ReleaseMixer();
+   bool PlayMixer(PinSound * const pps, const float volume, const float randompitch, const int pitch, const float pan, const float front_rear_fade, const int flags, const bool usesame, const bool restart);
+
+	AudioMixer* m_mixer = nullptr;
+   unsigned int m_mixerStolenVoices = 0;
+	HSTREAM m_mixerStream = 0;
+	float m_mixerStreamLength = 0.f; // Sounds longer than this (in seconds) are not decoded but left streaming through the legacy playback
+
 	PinDirectSound m_pds;
 	PinDirectSound *m_pbackglassds;
 
@@ -0,0 +1,110 @@
+#include "stdafx.h"
+#include "ControllerBindings.h"
+
+DispatchControllerProvider::DispatchControllerProvider(IDispatch* const controller)
+   : m_controller(controller)
+{
+   m_controller->AddRef();
+   static wchar_t LampsName[] = L"ChangedLamps";
+   LPOLESTR lamps = LampsName;
+   if (FAILED(m_controller->GetIDsOfNames(IID_NULL, &lamps, 1, LOCALE_USER_DEFAULT, &m_changedLamps)))
+      m_changedLamps = DISPID_UNKNOWN;
+}
+
+DispatchControllerProvider::~DispatchControllerProvider()
+{
+   m_controller->Release();
+}
+
+// The property returns either nothing (no change) or a (n, 2) array of (number, state)
+void DispatchControllerProvider::GetChangedLamps(vector<Change>& changes)
+{
+   if (m_changedLamps == DISPID_UNKNOWN)
+      return;
+
+   DISPPARAMS dispparams = { nullptr, nullptr, 0, 0 };
+   VARIANT result;
+   VariantInit(&result);
+   if (FAILED(m_controller->Invoke(m_changedLamps, IID_NULL, LOCALE_USER_DEFAULT, DISPATCH_PROPERTYGET, &dispparams, &result, nullptr, nullptr)))
+      return;
+
+   SAFEARRAY * const psa = (V_VT(&result) == (VT_ARRAY | VT_VARIANT)) ? V_ARRAY(&result) : nullptr;
+   LONG lbound0, ubound0, lbound1, ubound1;
+   VARIANT *data;
+   if (psa && SafeArrayGetDim(psa) == 2
+      && SafeArrayGetLBound(psa, 1, &lbound0) == S_OK && SafeArrayGetUBound(psa, 1, &ubound0) == S_OK
+      && SafeArrayGetLBound(psa, 2, &lbound1) == S_OK && SafeArrayGetUBound(psa, 2, &ubound1) == S_OK
+      && ubound1 - lbound1 >= 1 && SUCCEEDED(SafeArrayAccessData(psa, (void **)&data)))
+   {
+      // First dimension varies fastest
+      const LONG n = ubound0 - lbound0 + 1;
+      for (LONG i = 0; i < n; ++i)
+      {
+         VARIANT number, state;
+         VariantInit(&number);
+         VariantInit(&state);
+         if (SUCCEEDED(VariantChangeType(&number, &data[i], 0, VT_I4)) && SUCCEEDED(VariantChangeType(&state, &data[n + i], 0, VT_R4)))
+            changes.push_back({ V_I4(&number), V_R4(&state) });
+      }
+      SafeArrayUnaccessData(psa);
+   }
+   VariantClear(&result);
+}
+
+//
+
+bool ControllerBindings::Bind(const int number, IEditable* const part)
+{
+   if (number < 0)
+      return false;
+   const ItemTypeEnum type = part->GetItemType();
+   if (type != eItemLight && type != eItemFlasher && type != eItemPrimitive)
+      return false;
+   if ((size_t)number >= m_lamps.size())
+      m_lamps.resize(number + 1);
+   if (FindIndexOf(m_lamps[number], part) < 0)
+      m_lamps[number].push_back(part);
+   return true;
+}
+
+void ControllerBindings::Clear()
+{
+   m_lamps.clear();
+   m_provider.reset();
+   m_localProvider.Clear();
+   m_scale = 1.f;
+}
+
+void ControllerBindings::SetProvider(ControllerStateProvider* const provider, const float scale)
+{
+   m_provider.reset(provider);
+   m_scale = scale;
+}
+
+void ControllerBindings::Apply(IEditable* const part, const float state)
+{
+   switch (part->GetItemType())
+   {
+   case eItemLight: ((Light *)part)->put_State(state); break;
+   case eItemFlasher: ((Flasher *)part)->put_IntensityScale(state); break;
+   case eItemPrimitive: ((Primitive *)part)->put_BlendDisableLighting(state); break;
+   default: break;
+   }
+}
+
+void ControllerBindings::Update()
+{
+   if (IsEmpty())
+   {
+      m_localProvider.Clear();
+      return;
+   }
+
+   ControllerStateProvider * const provider = m_provider ? m_provider.get() : &m_localProvider;
+   m_changes.clear();
+   provider->GetChangedLamps(m_changes);
+   for (const ControllerStateProvider::Change& change : m_changes)
+      if (change.m_number >= 0 && (size_t)change.m_number < m_lamps.size())
+         for (IEditable * const part : m_lamps[change.m_number])
+            Apply(part, change.m_state * m_scale);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+// Source of the lamp state changes applied by ControllerBindings
+class ControllerStateProvider
+{
+public:
+   struct Change
+   {
+      int m_number;
+      float m_state;
+   };
+
+   virtual ~ControllerStateProvider() {}
+
+   // Append the changes since the last call
+   virtual void GetChangedLamps(vector<Change>& changes) = 0;
+};
+
+// Controller object from the script (VPinMAME, B2S, ...), pulled through its ChangedLamps property
+class DispatchControllerProvider final : public ControllerStateProvider
+{
+public:
+   DispatchControllerProvider(IDispatch* const controller);
+   ~DispatchControllerProvider() override;
+
+   void GetChangedLamps(vector<Change>& changes) override;
+
+private:
+   IDispatch* const m_controller;
+   DISPID m_changedLamps = DISPID_UNKNOWN;
+};
+
+// Local stand-in for a controller, fed by the script (SimulateLamp), to test the bindings without a ROM
+class LocalControllerProvider final : public ControllerStateProvider
+{
+public:
+   void SetLamp(const int number, const float state) { m_lamps.push_back({ number, state }); }
+   void Clear() { m_lamps.clear(); }
+
+   void GetChangedLamps(vector<Change>& changes) override { changes.insert(changes.end(), m_lamps.begin(), m_lamps.end()); m_lamps.clear(); }
+
+private:
+   vector<Change> m_lamps;
+};
+
+// Lamp number to table parts (lights, flashers, primitives) bindings
+//
+// The script registers the bindings once, then the player pulls the changed states from the provider each frame and applies
+// them directly to the bound parts, instead of the script looping over the changes and setting the parts one by one through
+// IDispatch. The controller only reports each change once, so the script must not read ChangedLamps itself while bindings exist.
+// Solenoids are not supported, as scripts (e.g. core.vbs solenoid callbacks) always need to read ChangedSolenoids themselves.
+class ControllerBindings final
+{
+public:
+   bool Bind(const int number, IEditable* const part); // false if the part type can not be bound
+   void Clear();
+   bool IsEmpty() const { return m_lamps.empty(); }
+
+   void SetProvider(ControllerStateProvider* const provider, const float scale); // takes ownership, nullptr for the local stand-in
+   LocalControllerProvider& GetLocalProvider() { return m_localProvider; }
+
+   void Update(); // pull the changes and apply them to the bound parts
+
+private:
+   static void Apply(IEditable* const part, const float state);
+
+   vector<vector<IEditable*>> m_lamps; // bound parts, indexed by number
+   std::unique_ptr<ControllerStateProvider> m_provider;
+   LocalControllerProvider m_localProvider;
+   float m_scale = 1.f; // e.g. 1/255 for the 0..255 modulated states of VPinMAME
+   vector<ControllerStateProvider::Change> m_changes;
+};
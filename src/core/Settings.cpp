@@ -23,15 +23,19 @@ Settings::Section Settings::GetSection(const string& name)
    return Count;
 }
 
+unsigned int Settings::s_lastRevision = 0;
+
 Settings::Settings(const Settings* parent)
    : m_parent(parent)
 {
+   Invalidate();
 }
 
 bool Settings::LoadFromFile(const string& path, const bool createDefault)
 {
    m_modified = false;
    m_iniPath = path;
+   Invalidate();
    mINI::INIFile file(path);
    if (file.read(m_ini))
    {
@@ -174,6 +178,7 @@ void Settings::Save()
 void Settings::CopyOverrides(const Settings& settings)
 {
    assert(m_parent != nullptr); // Overrides are defined relatively to a parent
+   Invalidate();
    for (const auto& section : settings.m_ini)
    {
       for (const auto& item : section.second)
@@ -345,12 +350,20 @@ bool Settings::SaveValue(const Section section, const string &key, const DataTyp
          {
             m_modified = true;
             m_ini[regKey[section]].remove(key);
+            Invalidate();
+            NotifyChange(section, key);
          }
          return true;
       }
    }
    m_modified = true;
+   const bool changed = m_ini.get(regKey[section]).get(key) != copy;
    m_ini[regKey[section]][key] = copy;
+   if (changed)
+   {
+      Invalidate();
+      NotifyChange(section, key);
+   }
    return true;
 }
 
@@ -391,6 +404,8 @@ bool Settings::DeleteValue(const Section section, const string &key, const bool
    {
       m_modified = true;
       success &= m_ini[regKey[section]].remove(key);
+      Invalidate();
+      NotifyChange(section, key);
    }
    return success;
 }
@@ -404,10 +419,106 @@ bool Settings::DeleteSubKey(const Section section, const bool &deleteFromParent)
    {
       m_modified = true;
       success &= m_ini.remove(regKey[section]);
+      Invalidate();
    }
    return success;
 }
 
+namespace
+{
+   struct SettingHandleDef
+   {
+      Settings::Section section;
+      string key;
+      int intDefault;
+      float floatDefault;
+   };
+
+   vector<SettingHandleDef>& GetSettingHandles()
+   {
+      static vector<SettingHandleDef> handles; // Function local static since handles are registered during static initialization
+      return handles;
+   }
+
+   unsigned int RegisterSettingHandle(const Settings::Section section, const string& key, const int intDefault, const float floatDefault)
+   {
+      vector<SettingHandleDef>& handles = GetSettingHandles();
+      handles.push_back({ section, key, intDefault, floatDefault });
+      return (unsigned int)handles.size() - 1;
+   }
+}
+
+Settings::IntSetting Settings::RegisterIntSetting(const Section section, const string &key, const int def)
+{
+   return { RegisterSettingHandle(section, key, def, 0.f) };
+}
+
+Settings::FloatSetting Settings::RegisterFloatSetting(const Section section, const string &key, const float def)
+{
+   return { RegisterSettingHandle(section, key, 0, def) };
+}
+
+Settings::BoolSetting Settings::RegisterBoolSetting(const Section section, const string &key, const bool def)
+{
+   return { RegisterSettingHandle(section, key, def ? 1 : 0, 0.f) };
+}
+
+Settings::CachedValue& Settings::GetCachedValue(const unsigned int slot) const
+{
+   if (slot >= m_cache.size())
+      m_cache.resize(GetSettingHandles().size());
+   return m_cache[slot];
+}
+
+int Settings::GetValue(const IntSetting setting) const
+{
+   CachedValue& cache = GetCachedValue(setting.m_slot);
+   const unsigned int revision = GetRevision();
+   if (cache.revision != revision)
+   {
+      const SettingHandleDef& def = GetSettingHandles()[setting.m_slot];
+      cache.intValue = LoadValueWithDefault(def.section, def.key, def.intDefault);
+      cache.revision = revision;
+   }
+   return cache.intValue;
+}
+
+float Settings::GetValue(const FloatSetting setting) const
+{
+   CachedValue& cache = GetCachedValue(setting.m_slot);
+   const unsigned int revision = GetRevision();
+   if (cache.revision != revision)
+   {
+      const SettingHandleDef& def = GetSettingHandles()[setting.m_slot];
+      cache.floatValue = LoadValueWithDefault(def.section, def.key, def.floatDefault);
+      cache.revision = revision;
+   }
+   return cache.floatValue;
+}
+
+bool Settings::GetValue(const BoolSetting setting) const
+{
+   return GetValue(IntSetting { setting.m_slot }) != 0;
+}
+
+unsigned int Settings::AddChangeListener(const ChangeListener &listener)
+{
+   m_lastListenerId++;
+   m_listeners.push_back(std::make_pair(m_lastListenerId, listener));
+   return m_lastListenerId;
+}
+
+void Settings::RemoveChangeListener(const unsigned int id)
+{
+   m_listeners.erase(std::remove_if(m_listeners.begin(), m_listeners.end(), [id](const std::pair<unsigned int, ChangeListener>& item) { return item.first == id; }), m_listeners.end());
+}
+
+void Settings::NotifyChange(const Section section, const string &key) const
+{
+   for (const auto& listener : m_listeners)
+      listener.second(section, key);
+}
+
 void Settings::RegisterSetting(const Section section, const string &name, float minValue, float maxValue, float step, float defaultValue, OptionUnit unit, const vector<string> &literals)
 {
    assert(section == TableOption); // For the time being, this system is only used for custom table options (could be extend for all options to get the benefit of validation, fast access, and remove unneeded copied states...)
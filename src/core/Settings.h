@@ -1,5 +1,7 @@
 #pragma once
 
+#include <functional>
+
 #define MINI_CASE_SENSITIVE
 #include "mINI/ini.h"
 
@@ -12,7 +14,7 @@ class Settings final
 public:
    Settings(const Settings* parent = nullptr);
 
-   void SetParent(const Settings *parent) { m_parent = parent; }
+   void SetParent(const Settings *parent) { m_parent = parent; Invalidate(); }
 
    void SetIniPath(const string &path) { m_iniPath = path; }
    bool LoadFromFile(const string &path, const bool createDefault);
@@ -89,6 +91,30 @@ public:
    bool DeleteValue(const Section section, const string &key, const bool& deleteFromParent = false);
    bool DeleteSubKey(const Section section, const bool &deleteFromParent = false);
 
+   // Typed setting handles, for settings accessed on hot paths.
+   // A setting is registered once (usually as a static), resolving it to a slot. Each settings object caches the parsed value of each slot and only
+   // reloads it after a modification of itself or of one of its parents, so reading the value does not need to hash the key or parse text.
+   // GetValue updates this cache without any synchronization: like the rest of the settings, it must only be used from the main thread
+   // (worker threads, e.g. audio decoding, must be given the values they need when they are started).
+   template <typename T> struct Handle
+   {
+      unsigned int m_slot;
+   };
+   typedef Handle<int> IntSetting;
+   typedef Handle<float> FloatSetting;
+   typedef Handle<bool> BoolSetting;
+   static IntSetting RegisterIntSetting(const Section section, const string &key, const int def);
+   static FloatSetting RegisterFloatSetting(const Section section, const string &key, const float def);
+   static BoolSetting RegisterBoolSetting(const Section section, const string &key, const bool def);
+   int GetValue(const IntSetting setting) const;
+   float GetValue(const FloatSetting setting) const;
+   bool GetValue(const BoolSetting setting) const;
+
+   // Change notification, called when a value of this settings object is modified by SaveValue/DeleteValue (modifications of the parents are not notified)
+   typedef std::function<void(const Section section, const string &key)> ChangeListener;
+   unsigned int AddChangeListener(const ChangeListener &listener);
+   void RemoveChangeListener(const unsigned int id);
+
    enum OptionUnit
    {
       OT_NONE, // Display without a unit
@@ -115,6 +141,27 @@ private:
    bool LoadValue(const Section section, const string &key, DataType &type, void *pvalue, DWORD size) const;
    bool SaveValue(const Section section, const string &key, const DataType type, const void *pvalue, const DWORD size, const bool overrideMode);
 
+   void Invalidate() { m_revision = ++s_lastRevision; }
+   unsigned int GetRevision() const { return m_parent ? max(m_revision, m_parent->GetRevision()) : m_revision; }
+   void NotifyChange(const Section section, const string &key) const;
+
+   struct CachedValue
+   {
+      unsigned int revision = 0; // Revision of the settings when the value was loaded, 0 if not loaded
+      union
+      {
+         int intValue;
+         float floatValue;
+      };
+   };
+   CachedValue &GetCachedValue(const unsigned int slot) const; // main thread only (see GetValue)
+   mutable vector<CachedValue> m_cache;
+   static unsigned int s_lastRevision;
+   unsigned int m_revision;
+
+   vector<std::pair<unsigned int, ChangeListener>> m_listeners;
+   unsigned int m_lastListenerId = 0;
+
    vector<OptionDef> m_options;
 
    bool m_modified = false;
@@ -18,6 +18,8 @@
 #include "../meshes/ballMesh.h"
 #include "renderer/Shader.h"
 #include "renderer/Anaglyph.h"
+#include "ThreadPool.h"
+#include "physics/collisionmeshcache.h"
 #include "renderer/RenderCommand.h"
 #include "typedefs3D.h"
 #include "captureExt.h"
@@ -140,6 +142,7 @@ Player::Player(PinTable *const editor_table, PinTable *const live_table, const i
    m_trailForBalls = m_ptable->m_settings.LoadValueWithDefault(Settings::Player, "BallTrail"s, true);
    m_ballTrailStrength = m_ptable->m_settings.LoadValueWithDefault(Settings::Player, "BallTrailStrength"s, 0.5f);
    m_disableLightingForBalls = m_ptable->m_settings.LoadValueWithDefault(Settings::Player, "DisableLightingForBalls"s, false);
+   m_viewCulling = m_ptable->m_settings.LoadValueWithDefault(Settings::Player, "ViewCulling"s, true);
    m_stereo3D = useVR ? STEREO_VR : (StereoMode)m_ptable->m_settings.LoadValueWithDefault(Settings::Player, "Stereo3D"s, (int)STEREO_OFF);
    m_stereo3Denabled = m_ptable->m_settings.LoadValueWithDefault(Settings::Player, "Stereo3DEnabled"s, (m_stereo3D != STEREO_OFF));
    m_disableDWM = m_ptable->m_settings.LoadValueWithDefault(Settings::Player, "DisableDWM"s, false);
@@ -288,10 +291,15 @@ Player::Player(PinTable *const editor_table, PinTable *const live_table, const i
 
    c_kDNextlevels = 0;
    c_quadNextlevels = 0;
+   c_bvhObjects = 0;
+   c_bvhNodes = 0;
 
    c_traversed = 0;
    c_tested = 0;
    c_deepTested = 0;
+   c_ballQueries = 0;
+   c_maxTraversedPerBall = 0;
+   c_maxTestedPerBall = 0;
 #endif
 
    m_movedPlunger = 0;
@@ -320,6 +328,7 @@ Player::~Player()
    assert(g_pplayer == nullptr);
    m_closing = CS_CLOSED;
    m_ptable->StopPlaying();
+   delete m_animationThreadPool;
    delete m_staticPrepassRT;
    delete m_ballImage;
    delete m_decalImage;
@@ -327,6 +336,34 @@ Player::~Player()
    delete m_ptable;
 }
 
+void Player::BlendAnimatedPrimitives()
+{
+   m_blendedPrimitives.clear();
+   for (Primitive *const prim : m_animatedPrimitives)
+      if (prim->NeedsAnimationBlend())
+         m_blendedPrimitives.push_back(prim);
+
+   if (m_blendedPrimitives.size() <= 1)
+   {
+      for (Primitive *const prim : m_blendedPrimitives)
+         prim->BlendAnimation();
+      return;
+   }
+
+   // Each primitive only blends into its own CPU vertex array, the (shared) vertex buffers are then updated from the render thread when rendering the primitives
+   const size_t nWorkers = clamp((size_t)g_pvp->m_logicalNumberOfProcessors, (size_t)1, m_blendedPrimitives.size());
+   if (m_animationThreadPool == nullptr)
+      m_animationThreadPool = new ThreadPool(max(g_pvp->m_logicalNumberOfProcessors, 1));
+   std::atomic<size_t> nextPrimitive { 0 };
+   for (size_t w = 0; w < nWorkers; w++)
+      m_animationThreadPool->enqueue([this, &nextPrimitive]()
+      {
+         for (size_t i = nextPrimitive++; i < m_blendedPrimitives.size(); i = nextPrimitive++)
+            m_blendedPrimitives[i]->BlendAnimation();
+      });
+   m_animationThreadPool->wait_until_nothing_in_flight();
+}
+
 void Player::PreRegisterClass(WNDCLASS& wc)
 {
     wc.style = 0;
@@ -713,6 +750,22 @@ void Player::OnClose()
     if (m_detectScriptHang)
         g_pvp->PostWorkToWorkerThread(HANG_SNOOP_STOP, NULL);
 
+   // Script event costs per handler, for inspection with flame graph tools
+   if (g_frameProfiler.GetScriptEventProfiler().IsEnabled())
+   {
+      g_frameProfiler.GetScriptEventProfiler().LogSummary();
+      g_frameProfiler.GetScriptEventProfiler().SaveFoldedStacks(g_pvp->m_szMyPrefPath + "ScriptProfile.folded");
+   }
+
+   // Only keep the reduced collision meshes used by this table, and persist them to speed up next play
+   g_collisionMeshCache.PruneUnused();
+   if (g_collisionMeshCache.IsDirty() && (m_ptable->m_settings.LoadValueWithDefault(Settings::Player, "CacheMode"s, 1) > 0) && FileExists(m_ptable->m_szFileName))
+   {
+      const string dir = g_pvp->m_szMyPrefPath + "Cache" + PATH_SEPARATOR_CHAR + m_ptable->m_szTitle + PATH_SEPARATOR_CHAR;
+      std::filesystem::create_directories(std::filesystem::path(dir));
+      g_collisionMeshCache.Save(dir + "collision_meshes.bin");
+   }
+
    // Save list of used textures to avoid stuttering in next play
    if ((m_ptable->m_settings.LoadValueWithDefault(Settings::Player, "CacheMode"s, 1) > 0) && FileExists(m_ptable->m_szFileName))
    {
@@ -814,8 +867,13 @@ void Player::OnClose()
 
    for (auto probe : m_ptable->m_vrenderprobe)
       probe->RenderRelease();
+   for (const BulbLightBuffer &buffer : m_bulbLightBuffers)
+      delete buffer.rt;
+   m_bulbLightBuffers.clear();
    for (auto renderable : m_vhitables)
       renderable->RenderRelease();
+   m_animatedPrimitives.clear();
+   m_blendedPrimitives.clear();
    for (auto ball : m_vball)
       ball->m_pballex->RenderRelease();
    for (auto hitable : m_vhitables)
@@ -824,6 +882,7 @@ void Player::OnClose()
    if (m_implicitPlayfieldMesh)
    {
       RemoveFromVectorSingle(m_ptable->m_vedit, (IEditable *)m_implicitPlayfieldMesh);
+      m_ptable->InvalidateElementNameMap();
       m_ptable->m_pcv->RemoveItem(m_implicitPlayfieldMesh->GetScriptable());
       delete m_implicitPlayfieldMesh;
       m_implicitPlayfieldMesh = nullptr;
@@ -837,6 +896,9 @@ void Player::OnClose()
       delete m_vdebugho[i];
    m_vdebugho.clear();
 
+   // hit objects have been destroyed above, release their memory at once
+   m_physicsArena.Release();
+
    //!! cleanup the whole mem management for balls, this is a mess!
 
    // balls are added to the octree, but not the hit object vector
@@ -883,7 +945,8 @@ void Player::OnClose()
       delete m_controlclsidsafe[i];
    m_controlclsidsafe.clear();
 
-   m_changed_vht.clear();
+   m_timers.Clear();
+   m_ptable->m_controllerBindings.Clear(); // release the controller and the bound parts of the live table
 
    g_pplayer = nullptr;
 
@@ -1057,6 +1120,7 @@ void Player::InitKeys()
 
 void Player::InitDebugHitStructure()
 {
+   PhysicsArena::Scope arenaScope(&m_physicsArena);
    for (size_t i = 0; i < m_vhitables.size(); ++i)
    {
       Hitable * const ph = m_vhitables[i];
@@ -1216,6 +1280,40 @@ void Player::UpdateBallShaderMatrix()
 #endif
 }
 
+bool Player::IsCulled(Renderable *renderable)
+{
+   Vertex3Ds boundMin, boundMax;
+   if (!m_viewCulling || !renderable->GetRenderBounds(boundMin, boundMax) || boundMin.x > boundMax.x)
+      return false;
+   // The part is outside of the view frustum if all corners of its bounding box are on the outer side of one of the side or near clipping planes for all eyes
+   const int nEyes = m_pin3d.m_pd3dPrimaryDevice->m_stereo3D != STEREO_OFF ? 2 : 1;
+   for (int eye = 0; eye < nEyes; eye++)
+   {
+      const Matrix3D vp = m_pin3d.GetMVP().GetView() * m_pin3d.GetMVP().GetProj(eye);
+      unsigned int outside = 0x1F;
+      for (int i = 0; i < 8 && outside != 0; i++)
+      {
+         const float x = (i & 1) ? boundMin.x : boundMax.x;
+         const float y = (i & 2) ? boundMin.y : boundMax.y;
+         const float z = (i & 4) ? boundMin.z : boundMax.z;
+         const float xp = vp._11 * x + vp._21 * y + vp._31 * z + vp._41;
+         const float yp = vp._12 * x + vp._22 * y + vp._32 * z + vp._42;
+         const float wp = vp._14 * x + vp._24 * y + vp._34 * z + vp._44;
+         unsigned int flags = 0;
+         if (xp < -wp) flags |= 0x01;
+         if (xp > wp) flags |= 0x02;
+         if (yp < -wp) flags |= 0x04;
+         if (yp > wp) flags |= 0x08;
+         if (wp <= 0.f) flags |= 0x10;
+         outside &= flags;
+      }
+      if (outside == 0)
+         return false;
+   }
+   m_pin3d.m_pd3dPrimaryDevice->m_curCulledParts++;
+   return true;
+}
+
 HRESULT Player::Init()
 {
    TRACE_FUNCTION();
@@ -1486,11 +1584,20 @@ HRESULT Player::Init()
    m_last_frame_time_msec = 0;
 
    InitFPS();
+   // Not reset with the other profiling data (InitFPS), as the script event profile covers the whole play session
+   g_frameProfiler.GetScriptEventProfiler().Reset();
+   g_frameProfiler.GetScriptEventProfiler().Enable(m_ptable->m_settings.LoadValueWithDefault(Settings::Player, "ScriptProfiler"s, false));
    m_infoMode = IF_NONE;
    m_infoProbeIndex = 0;
 
    PLOGI << "Initializing Hitables"; // For profiling
 
+   // Reuse reduced primitive collision meshes of previous play sessions
+   const bool useCollisionMeshCache = (m_ptable->m_settings.LoadValueWithDefault(Settings::Player, "CacheMode"s, 1) > 0) && FileExists(m_ptable->m_szFileName);
+   if (useCollisionMeshCache)
+      g_collisionMeshCache.Load(g_pvp->m_szMyPrefPath + "Cache" + PATH_SEPARATOR_CHAR + m_ptable->m_szTitle + PATH_SEPARATOR_CHAR + "collision_meshes.bin");
+
+   vector<IEditable *> hitEditables;
    for (size_t i = 0; i < m_ptable->m_vedit.size(); i++)
    {
       IEditable * const pe = m_ptable->m_vedit[i];
@@ -1509,31 +1616,73 @@ HRESULT Player::Init()
             m_pEditorTable->m_progressDialog.SetName(wzDst);
          }
 #endif
-         const size_t currentsize = m_vho.size();
-         ph->GetHitShapes(m_vho);
-         const size_t newsize = m_vho.size();
-         // Save the objects the trouble of having to set the idispatch pointer themselves
-         for (size_t hitloop = currentsize; hitloop < newsize; hitloop++)
-            m_vho[hitloop]->m_pfedebug = pe->GetIFireEvents();
-
-         ph->GetTimers(m_vht);
+         hitEditables.push_back(pe);
 
          // build list of hitables
          m_vhitables.push_back(ph);
       }
    }
 
+   // Hit shapes of the parts are independent from each other, so generate them concurrently (primitives collision mesh reduction can be quite expensive),
+   // each worker allocating from its own physics arena, then merge them in the part order to keep the physics deterministic
+   {
+      vector<vector<HitObject *>> partHitObjects(m_vhitables.size());
+      const size_t nWorkers = clamp((size_t)g_pvp->m_logicalNumberOfProcessors, (size_t)1, max(m_vhitables.size(), (size_t)1));
+      const std::unique_ptr<PhysicsArena[]> workerArenas = std::make_unique<PhysicsArena[]>(nWorkers);
+      std::atomic<size_t> nextPart { 0 };
+      ThreadPool pool(nWorkers);
+      for (size_t w = 0; w < nWorkers; w++)
+         pool.enqueue([this, w, &workerArenas, &partHitObjects, &nextPart]()
+         {
+            PhysicsArena::Scope workerArenaScope(&workerArenas[w]);
+            for (size_t i = nextPart++; i < m_vhitables.size(); i = nextPart++)
+               m_vhitables[i]->GetHitShapes(partHitObjects[i]);
+         });
+      pool.wait_until_nothing_in_flight();
+      for (size_t w = 0; w < nWorkers; w++)
+         m_physicsArena.Merge(workerArenas[w]);
+
+      vector<HitTimer *> timers;
+      for (size_t i = 0; i < m_vhitables.size(); i++)
+      {
+         // Save the objects the trouble of having to set the idispatch pointer themselves
+         IFireEvents * const pfe = hitEditables[i]->GetIFireEvents();
+         for (HitObject * const pho : partHitObjects[i])
+            pho->m_pfedebug = pfe;
+         m_vho.insert(m_vho.end(), partHitObjects[i].begin(), partHitObjects[i].end());
+
+         m_vhitables[i]->GetTimers(timers);
+      }
+      for (HitTimer *const pht : timers)
+         m_timers.Add(pht);
+   }
+
+   PhysicsArena::Scope arenaScope(&m_physicsArena);
+
    m_pEditorTable->m_progressDialog.SetProgress(45);
    PLOGI << "Initializing octree"; // For profiling
 
    AddCabinetBoundingHitShapes();
 
+   PLOGI << "Hit objects created: " << m_vho.size() << " objects, " << (m_physicsArena.GetReservedSize() / 1024) << "KiB physics arena"; // For profiling
+
+#ifndef USE_EMBREE
+   m_collisionStructure = (CollisionStructure)clamp(m_ptable->m_settings.LoadValueWithDefault(Settings::Player, "CollisionStructure"s, (int)CS_QUADTREE), (int)CS_QUADTREE, (int)CS_BVH);
+#else
+   m_collisionStructure = CS_QUADTREE;
+#endif
+
    for (size_t i = 0; i < m_vho.size(); ++i)
    {
       HitObject * const pho = m_vho[i];
 
       pho->CalcHitBBox(); // maybe needed to update here, as only done lazily for some objects (i.e. balls!)
-      m_hitoctree.AddElement(pho);
+#ifndef USE_EMBREE
+      if (m_collisionStructure == CS_BVH)
+         m_hitbvh.AddElement(pho);
+      else if (m_collisionStructure == CS_QUADTREE)
+#endif
+         m_hitoctree.AddElement(pho);
 
       if (pho->GetType() == eFlipper)
          m_vFlippers.push_back((HitFlipper*)pho);
@@ -1543,11 +1692,28 @@ HRESULT Player::Init()
          m_vmover.push_back(pmo);
    }
 
-   const FRect3D tableBounds = m_ptable->GetBoundingBox();
-   m_hitoctree.Initialize(FRect(tableBounds.left,tableBounds.right,tableBounds.top,tableBounds.bottom));
+#ifndef USE_EMBREE
+   if (m_collisionStructure == CS_BVH)
+   {
+      m_hitbvh.Initialize();
+      PLOGI << "Collision structure: BVH with " << m_hitbvh.GetNodeCount() << " nodes, depth " << m_hitbvh.GetDepth();
+   }
+   else if (m_collisionStructure == CS_KDTREE)
+   {
+      m_hitkd.FillFromVector(m_vho);
+      m_hitkd.Finalize();
+      PLOGI << "Collision structure: kd-tree";
+   }
+   else
+#endif
+   {
+      const FRect3D tableBounds = m_ptable->GetBoundingBox();
+      m_hitoctree.Initialize(FRect(tableBounds.left,tableBounds.right,tableBounds.top,tableBounds.bottom));
 #if !defined(NDEBUG) && defined(PRINT_DEBUG_COLLISION_TREE)
-   m_hitoctree.DumpTree(0);
+      m_hitoctree.DumpTree(0);
 #endif
+      PLOGI << "Collision structure: quadtree";
+   }
 
    // initialize hit structure for dynamic objects
    m_hitoctree_dynamic.FillFromVector(m_vho_dynamic);
@@ -1637,6 +1803,9 @@ HRESULT Player::Init()
       probe->RenderSetup(m_pin3d.m_pd3dPrimaryDevice);
    for (Hitable* hitable : m_vhitables)
       hitable->RenderSetup(m_pin3d.m_pd3dPrimaryDevice);
+   for (IEditable *const pe : m_ptable->m_vedit)
+      if (pe->GetItemType() == eItemPrimitive && ((Primitive *)pe)->HasAnimation())
+         m_animatedPrimitives.push_back((Primitive *)pe);
 
    // Setup anisotropic filtering
    const bool forceAniso = m_ptable->m_settings.LoadValueWithDefault(Settings::Player, "ForceAnisotropicFiltering"s, true);
@@ -1871,7 +2040,8 @@ void Player::RenderStaticPrepass()
          // Render static parts
          UpdateBasicShaderMatrix();
          for (Hitable *hitable : m_vhitables)
-            hitable->Render(m_render_mask);
+            if (!IsCulled(hitable))
+               hitable->Render(m_render_mask);
 
          // Rendering is done to the static render target then accumulated to accumulationSurface
          // We use the framebuffer mirror shader which copies a weighted version of the bound texture
@@ -1991,7 +2161,8 @@ void Player::RenderStaticPrepass()
             m_ptable->m_vrenderprobe[i]->MarkDirty();
          UpdateBasicShaderMatrix();
          for (Hitable *hitable : m_vhitables)
-            hitable->Render(m_render_mask);
+            if (!IsCulled(hitable))
+               hitable->Render(m_render_mask);
          m_pin3d.m_pd3dPrimaryDevice->FlushRenderFrame();
       }
       // Copy supersampled color buffer
@@ -2597,6 +2768,18 @@ void Player::SetGravity(float slopeDeg, float strength)
    m_gravity.z = -cosf(ANGTORAD(slopeDeg)) * strength;
 }
 
+#ifndef USE_EMBREE
+void Player::HitTestStaticBall(const Ball * const pball, CollisionEvent& coll) const
+{
+   switch (m_collisionStructure)
+   {
+   case CS_BVH: m_hitbvh.HitTestBall(pball, coll); break;
+   case CS_KDTREE: m_hitkd.HitTestBall(pball, coll); break;
+   default: m_hitoctree.HitTestBall(pball, coll); break;
+   }
+}
+#endif
+
 void Player::PhysicsSimulateCycle(float dtime) // move physics forward to this time
 {
    // PLOGD << "Cycle " << dtime;
@@ -2665,16 +2848,24 @@ void Player::PhysicsSimulateCycle(float dtime) // move physics forward to this t
             DoHitTest(pball, &m_hitTopGlass, pball->m_coll);
 
 #ifndef USE_EMBREE
+#ifdef DEBUGPHYSICS
+            const U32 traversed = c_traversed, tested = c_tested;
+#endif
             if (rand_mt_01() < 0.5f) // swap order of dynamic and static obj checks randomly
             {
                m_hitoctree_dynamic.HitTestBall(pball, pball->m_coll); // dynamic objects
-               m_hitoctree.HitTestBall(pball, pball->m_coll);         // find the static hit objects hit times
+               HitTestStaticBall(pball, pball->m_coll);               // find the static hit objects hit times
             }
             else
             {
-               m_hitoctree.HitTestBall(pball, pball->m_coll);         // find the static hit objects hit times
+               HitTestStaticBall(pball, pball->m_coll);               // find the static hit objects hit times
                m_hitoctree_dynamic.HitTestBall(pball, pball->m_coll); // dynamic objects
             }
+#ifdef DEBUGPHYSICS
+            c_ballQueries++;
+            c_maxTraversedPerBall = max(c_maxTraversedPerBall, c_traversed - traversed);
+            c_maxTestedPerBall = max(c_maxTestedPerBall, c_tested - tested);
+#endif
 #endif
             const float htz = pball->m_coll.m_hittime; // this ball's hit time
             if (htz < 0.f) pball->m_coll.m_obj = nullptr; // no negative time allowed
@@ -2947,13 +3138,12 @@ void Player::UpdatePhysics()
          // If we're 3/4 of the way through the loop, fire a "controller sync" timer (timers with an interval set to -2) event so VPM can react to input.
          if (m_phys_iterations == 750 / ((int)m_fps + 1))
          {
-            for (HitTimer *const pht : m_vht)
-               if (pht->m_interval == -2)
+            m_timers.FireSync(true, [](HitTimer *const pht)
                {
                   g_frameProfiler.EnterScriptSection(DISPID_TimerEvents_Timer, pht->m_name);
                   pht->m_pfe->FireGroupEvent(DISPID_TimerEvents_Timer);
                   g_frameProfiler.ExitScriptSection(pht->m_name);
-               }
+               });
          }
          if (basetime < targettime)
          {
@@ -2985,19 +3175,7 @@ void Player::UpdatePhysics()
 
 #ifdef ACCURATETIMERS
       // do the en/disable changes for the timers that piled up
-      for(size_t i = 0; i < m_changed_vht.size(); ++i)
-          if (m_changed_vht[i].m_enabled) // add the timer?
-          {
-              if (FindIndexOf(m_vht, m_changed_vht[i].m_timer) < 0)
-                  m_vht.push_back(m_changed_vht[i].m_timer);
-          }
-          else // delete the timer?
-          {
-              const int idx = FindIndexOf(m_vht, m_changed_vht[i].m_timer);
-              if (idx >= 0)
-                  m_vht.erase(m_vht.begin() + idx);
-          }
-      m_changed_vht.clear();
+      m_timers.ApplyChanges();
 
       Ball * const old_pactiveball = m_pactiveball;
       m_pactiveball = nullptr; // No ball is the active ball for timers/key events
@@ -3006,25 +3184,22 @@ void Player::UpdatePhysics()
       {
          const unsigned int p_timeCur = (unsigned int)((m_curPhysicsFrameTime - m_StartTime_usec) / 1000); // milliseconds
 
-         for (size_t i = 0; i < m_vht.size(); i++)
+         // only the due timers are visited (min heap on their next fire time)
+         m_timers.FireDue(p_timeCur, [p_timeCur](HitTimer *const pht)
          {
-            HitTimer * const pht = m_vht[i];
-            if (pht->m_interval >= 0 && pht->m_nextfire <= p_timeCur)
-            {
-               g_frameProfiler.EnterScriptSection(DISPID_TimerEvents_Timer, pht->m_name);
-               const unsigned int curnextfire = pht->m_nextfire;
-               pht->m_pfe->FireGroupEvent(DISPID_TimerEvents_Timer);
-               // Only add interval if the next fire time hasn't changed since the event was run. 
-               // Handles corner case:
-               //Timer1.Enabled = False
-               //Timer1.Interval = 1000
-               //Timer1.Enabled = True
-               if (curnextfire == pht->m_nextfire && pht->m_interval > 0)
-                  while (pht->m_nextfire <= p_timeCur)
-                     pht->m_nextfire += pht->m_interval;
-               g_frameProfiler.ExitScriptSection(pht->m_name);
-            }
-         }
+            g_frameProfiler.EnterScriptSection(DISPID_TimerEvents_Timer, pht->m_name);
+            const unsigned int curnextfire = pht->m_nextfire;
+            pht->m_pfe->FireGroupEvent(DISPID_TimerEvents_Timer);
+            // Only add interval if the next fire time hasn't changed since the event was run. 
+            // Handles corner case:
+            //Timer1.Enabled = False
+            //Timer1.Interval = 1000
+            //Timer1.Enabled = True
+            if (curnextfire == pht->m_nextfire && pht->m_interval > 0)
+               while (pht->m_nextfire <= p_timeCur)
+                  pht->m_nextfire += pht->m_interval;
+            g_frameProfiler.ExitScriptSection(pht->m_name);
+         });
       }
 
       m_pactiveball = old_pactiveball;
@@ -3188,14 +3363,29 @@ void Player::DrawBulbLightBuffer()
    const RenderPass *initial_rt = p3dDevice->GetCurrentPass();
    static int id = 0; id++;
 
-   // switch to 'bloom' output buffer to collect all bulb lights
-   p3dDevice->SetRenderTarget("Transmitted Light " + std::to_string(id) + " Clear", p3dDevice->GetBloomBufferTexture(), false);
+   // Each bulb light render of the frame (main view, then reflection probes views) has its own buffer, kept between frames
+   // so that it is only rerendered when something changed (light intensities, view, ball shadows,...)
+   if (m_bulbLightBufferIndex >= m_bulbLightBuffers.size())
+   {
+      BulbLightBuffer buffer;
+      buffer.rt = p3dDevice->GetBloomBufferTexture()->Duplicate("Transmitted Light " + std::to_string(m_bulbLightBuffers.size()));
+      m_bulbLightBuffers.push_back(buffer);
+   }
+   BulbLightBuffer &buffer = m_bulbLightBuffers[m_bulbLightBufferIndex];
+   if (m_bulbLightBufferIndex < MAX_BULB_LIGHT_BUFFERS - 1)
+      m_bulbLightBufferIndex++;
+   RenderTarget *const bulbLightRT = buffer.rt;
+   const unsigned int revision = bulbLightRT->GetContentRevision();
+   const unsigned int mark = p3dDevice->GetRenderCommandsMark();
+
+   // switch to bulb light output buffer to collect all bulb lights
+   p3dDevice->SetRenderTarget("Transmitted Light " + std::to_string(id) + " Clear", bulbLightRT, false);
    p3dDevice->ResetRenderState();
    p3dDevice->Clear(clearType::TARGET, 0, 1.0f, 0L);
 
    // Draw bulb lights
    m_render_mask |= LIGHT_BUFFER;
-   p3dDevice->SetRenderTarget("Transmitted Light " + std::to_string(id), p3dDevice->GetBloomBufferTexture(), true, true);
+   p3dDevice->SetRenderTarget("Transmitted Light " + std::to_string(id), bulbLightRT, true, true);
    p3dDevice->SetRenderState(RenderState::ZENABLE, RenderState::RS_FALSE); // disable all z-tests as zbuffer is in different resolution
    for (Hitable *hitable : m_vhitables)
       if (hitable->HitableGetItemType() == eItemLight)
@@ -3203,13 +3393,19 @@ void Player::DrawBulbLightBuffer()
    m_render_mask &= ~LIGHT_BUFFER;
    bool hasLight = p3dDevice->GetCurrentPass()->GetCommandCount() > 0;
 
-   if (hasLight)
+   const U64 hash = p3dDevice->GetRenderCommandsHash(mark);
+   if (hash == buffer.hash)
+   { // Nothing changed since last render: discard it and reuse the previously rendered buffer
+      bulbLightRT->DiscardFrameRender(revision);
+   }
+   else if (hasLight)
    { // Only apply blur if we have actually rendered some lights
+      buffer.hash = hash;
       RenderPass* renderPass = p3dDevice->GetCurrentPass();
       p3dDevice->DrawGaussianBlur(
-         p3dDevice->GetBloomBufferTexture(), 
+         bulbLightRT, 
          p3dDevice->GetBloomTmpBufferTexture(), 
-         p3dDevice->GetBloomBufferTexture(), 19.f); // FIXME kernel size should depend on buffer resolution
+         bulbLightRT, 19.f); // FIXME kernel size should depend on buffer resolution
       RenderPass *blurPass2 = p3dDevice->GetCurrentPass();
       RenderPass *blurPass1 = blurPass2->m_dependencies[0];
       constexpr float margin = 0.05f; // margin for the blur
@@ -3219,6 +3415,8 @@ void Player::DrawBulbLightBuffer()
       blurPass1->m_areaOfInterest.w = renderPass->m_areaOfInterest.w + margin;
       blurPass2->m_areaOfInterest = blurPass1->m_areaOfInterest;
    }
+   else
+      buffer.hash = hash;
 
    // Restore state and render target
    p3dDevice->SetRenderTarget(initial_rt->m_name + '+', initial_rt->m_rt);
@@ -3229,9 +3427,9 @@ void Player::DrawBulbLightBuffer()
    #endif
    if (hasLight)
    {
-      // Declare dependency on Bulb Light buffer (actually rendered to the bloom buffer texture)
-      m_pin3d.m_pd3dPrimaryDevice->AddRenderTargetDependency(m_pin3d.m_pd3dPrimaryDevice->GetBloomBufferTexture());
-      p3dDevice->basicShader->SetTexture(SHADER_tex_base_transmission, p3dDevice->GetBloomBufferTexture()->GetColorSampler());
+      // Declare dependency on Bulb Light buffer
+      m_pin3d.m_pd3dPrimaryDevice->AddRenderTargetDependency(bulbLightRT);
+      p3dDevice->basicShader->SetTexture(SHADER_tex_base_transmission, bulbLightRT->GetColorSampler());
    } 
    else
    {
@@ -3244,9 +3442,10 @@ void Player::RenderDynamics()
    PROFILE_FUNCTION(FrameProfiler::PROFILE_GPU_COLLECT);
    TRACE_FUNCTION();
 
-   // Mark all probes to be re-rendered for this frame (only if needed, lazily rendered)
+   // Mark all probes to be re-rendered for this frame (only if needed, lazily rendered, and skipped if unchanged since their last render)
    for (size_t i = 0; i < m_ptable->m_vrenderprobe.size(); ++i)
       m_ptable->m_vrenderprobe[i]->MarkDirty();
+   m_bulbLightBufferIndex = 0;
 
    // Setup the projection matrices used for refraction
    Matrix3D matProj[2];
@@ -3290,7 +3489,8 @@ void Player::RenderDynamics()
    m_render_mask = IsUsingStaticPrepass() ? DYNAMIC_ONLY : DEFAULT;
    DrawBulbLightBuffer();
    for (Hitable *hitable : m_vhitables)
-      hitable->Render(m_render_mask);
+      if (!IsCulled(hitable))
+         hitable->Render(m_render_mask);
    for (Ball* ball : m_vball)
       ball->m_pballex->Render(m_render_mask);
    m_render_mask = DEFAULT;
@@ -3407,11 +3607,12 @@ string Player::GetPerfInfo()
    info << "Triangles: " << ((m_pin3d.m_pd3dPrimaryDevice->m_frameDrawnTriangles + 999) / 1000) << "k per frame, "
         << ((stats_drawn_static_triangles + m_pin3d.m_pd3dPrimaryDevice->m_frameDrawnTriangles + 999) / 1000) << "k overall. DayNight " << quantizeUnsignedPercent(m_globalEmissionScale)
         << "%%\n";
-   info << "Draw calls: " << m_pin3d.m_pd3dPrimaryDevice->Perf_GetNumDrawCalls() << "  (" << m_pin3d.m_pd3dPrimaryDevice->Perf_GetNumLockCalls() << " Locks)\n";
+   info << "Draw calls: " << m_pin3d.m_pd3dPrimaryDevice->Perf_GetNumDrawCalls() << "  (" << m_pin3d.m_pd3dPrimaryDevice->Perf_GetNumBatchedDrawCalls() << " Batched, " << m_pin3d.m_pd3dPrimaryDevice->Perf_GetNumLockCalls() << " Locks, "
+        << ((m_pin3d.m_pd3dPrimaryDevice->Perf_GetBufferUploadBytes() + 1023) / 1024) << "KB uploaded)\n";
    info << "State changes: " << m_pin3d.m_pd3dPrimaryDevice->Perf_GetNumStateChanges() << "\n";
    info << "Texture changes: " << m_pin3d.m_pd3dPrimaryDevice->Perf_GetNumTextureChanges() << " (" << m_pin3d.m_pd3dPrimaryDevice->Perf_GetNumTextureUploads() << " Uploads)\n";
    info << "Shader/Parameter changes: " << m_pin3d.m_pd3dPrimaryDevice->Perf_GetNumTechniqueChanges() << " / " << m_pin3d.m_pd3dPrimaryDevice->Perf_GetNumParameterChanges() << "\n";
-   info << "Objects: " << (unsigned int)m_vhitables.size() << "\n";
+   info << "Objects: " << (unsigned int)m_vhitables.size() << " (" << m_pin3d.m_pd3dPrimaryDevice->Perf_GetNumCulledParts() << " Culled renders)\n";
    info << "\n";
 
    // Physics additional information
@@ -3425,8 +3626,10 @@ string Player::GetPerfInfo()
    info << " Static:" << c_staticcnt;
 #endif
    info << " Embed:" << c_embedcnts << " TimeSearch:" << c_timesearch << "\n";
-   info << "kDObjects:" << c_kDObjects << " kD:" << c_kDNextlevels << " QuadObjects:" << c_quadObjects << " Quadtree:" << c_quadNextlevels << " Traversed:" << c_traversed
+   info << "kDObjects:" << c_kDObjects << " kD:" << c_kDNextlevels << " QuadObjects:" << c_quadObjects << " Quadtree:" << c_quadNextlevels << " BVHObjects:" << c_bvhObjects << " BVH:" << c_bvhNodes << " Traversed:" << c_traversed
         << " Tested:" << c_tested << " DeepTested:" << c_deepTested << "\n";
+   info << "Per Ball Query: " << c_ballQueries << " queries, Traversed avg:" << (c_ballQueries ? (float)c_traversed / (float)c_ballQueries : 0.f) << " max:" << c_maxTraversedPerBall
+        << " Tested avg:" << (c_ballQueries ? (float)c_tested / (float)c_ballQueries : 0.f) << " max:" << c_maxTestedPerBall << "\n";
    info << std::setprecision(1);
 #endif
 
@@ -3975,6 +4178,7 @@ void Player::OnIdle()
       {
       case 0:
       {
+         g_pvp->m_ps.UpdateFrameProfiler();
          g_frameProfiler.NewFrame(m_time_msec);
          PLOGI_IF(debugLog) << "Frame Collect [Last frame length: " << ((double)g_frameProfiler.GetPrev(FrameProfiler::PROFILE_FRAME) / 1000.0) << "ms] at " << usec();
          PrepareFrame();
@@ -4053,6 +4257,7 @@ void Player::OnIdle()
       // This also leads to filling up the GPU render queue leading to a few frame latency, depending on driver setup (hence the use of a limiter).
 
       // Collect stats from previous frame and starts profiling a new frame
+      g_pvp->m_ps.UpdateFrameProfiler();
       g_frameProfiler.NewFrame(m_time_msec);
 
       // In pause mode: input, physics, animation and audio are not processed but rendering is still performed. This allows to modify properties (transform, visibility,..) using the debugger and get direct feedback
@@ -4133,6 +4338,9 @@ void Player::PrepareFrame()
    c_traversed = 0;
    c_tested = 0;
    c_deepTested = 0;
+   c_ballQueries = 0;
+   c_maxTraversedPerBall = 0;
+   c_maxTestedPerBall = 0;
    #endif
 
    // Update all non-physics-controlled animated parts (e.g. primitives, reels, gates, lights, bumper-skirts, hittargets, etc)
@@ -4149,14 +4357,19 @@ void Player::PrepareFrame()
          }
    }
 
+   // Apply the lamp changes of the controller to the bound parts (see PinTable::BindLamp), before the timers so that scripts see the new states
+   m_ptable->m_controllerBindings.Update();
+
    // Fire all '-1' (the ones which are synced to the refresh rate) and '-2' (the ones used to sync with the controller) timers after physics and animation update but before rendering, to avoid the script being one frame late
-   for (HitTimer *const pht : m_vht)
-      if (pht->m_interval < 0)
+   m_timers.FireSync(false, [](HitTimer *const pht)
       {
          g_frameProfiler.EnterScriptSection(DISPID_TimerEvents_Timer, pht->m_name);
          pht->m_pfe->FireGroupEvent(DISPID_TimerEvents_Timer);
          g_frameProfiler.ExitScriptSection(pht->m_name);
-      }
+      });
+
+   // Blend animated primitives after the timers since they may have changed the displayed frames (ShowFrame, PlayAnim, ...)
+   BlendAnimatedPrimitives();
 
    // Kill the profiler so that it does not affect performance => FIXME move to player
    if (m_infoMode != IF_PROFILING)
@@ -4270,41 +4483,25 @@ bool Player::FinishFrame()
 
 #ifndef ACCURATETIMERS
    // do the en/disable changes for the timers that piled up
-   for (size_t i = 0; i < m_changed_vht.size(); ++i)
-       if (m_changed_vht[i].enabled) // add the timer?
-       {
-           if (FindIndexOf(m_vht, m_changed_vht[i].m_timer) < 0)
-               m_vht.push_back(m_changed_vht[i].m_timer);
-       }
-       else // delete the timer?
-       {
-           const int idx = FindIndexOf(m_vht, m_changed_vht[i].m_timer);
-           if (idx >= 0)
-               m_vht.erase(m_vht.begin() + idx);
-       }
-   m_changed_vht.clear();
+   m_timers.ApplyChanges();
 
    Ball * const old_pactiveball = m_pactiveball;
    m_pactiveball = nullptr;  // No ball is the active ball for timers/key events
 
-   for (size_t i=0;i<m_vht.size();i++)
+   m_timers.FireDue(m_time_msec, [](HitTimer *const pht)
    {
-      HitTimer * const pht = m_vht[i];
-      if (pht->m_interval >= 0 && pht->m_nextfire <= m_time_msec) 
-      {
-         g_frameProfiler.EnterScriptSection(DISPID_TimerEvents_Timer, pht->m_name);
-         const unsigned int curnextfire = pht->m_nextfire;
-         pht->m_pfe->FireGroupEvent(DISPID_TimerEvents_Timer);
-         // Only add interval if the next fire time hasn't changed since the event was run. 
-         // Handles corner case:
-         //Timer1.Enabled = False
-         //Timer1.Interval = 1000
-         //Timer1.Enabled = True
-         if (curnextfire == pht->m_nextfire)
-            pht->m_nextfire += pht->m_interval;
-         g_frameProfiler.ExitScriptSection(pht->m_name);
-      }
-   }
+      g_frameProfiler.EnterScriptSection(DISPID_TimerEvents_Timer, pht->m_name);
+      const unsigned int curnextfire = pht->m_nextfire;
+      pht->m_pfe->FireGroupEvent(DISPID_TimerEvents_Timer);
+      // Only add interval if the next fire time hasn't changed since the event was run. 
+      // Handles corner case:
+      //Timer1.Enabled = False
+      //Timer1.Interval = 1000
+      //Timer1.Enabled = True
+      if (curnextfire == pht->m_nextfire)
+         pht->m_nextfire += pht->m_interval;
+      g_frameProfiler.ExitScriptSection(pht->m_name);
+   });
 
    m_pactiveball = old_pactiveball;
 #else
@@ -4317,9 +4514,12 @@ bool Player::FinishFrame()
    {
       if (!m_audio->MusicActive())
       {
+         // Music that failed to load is dropped without MusicDone event, like when the file could not be opened by PlayMusic
+         const bool failed = m_audio->MusicFailed();
          delete m_audio;
          m_audio = nullptr;
-         m_ptable->FireVoidEvent(DISPID_GameEvents_MusicDone);
+         if (!failed)
+            m_ptable->FireVoidEvent(DISPID_GameEvents_MusicDone);
       }
    }
 
@@ -4451,7 +4651,8 @@ void Player::DrawStatics()
    const unsigned int mask = m_render_mask;
    m_render_mask |= STATIC_ONLY;
    for (Hitable *hitable : m_vhitables)
-      hitable->Render(m_render_mask);
+      if (!IsCulled(hitable))
+         hitable->Render(m_render_mask);
    m_render_mask = mask;
 }
 
@@ -4466,7 +4667,8 @@ void Player::DrawDynamics(bool onlyBalls)
       const unsigned int mask = m_render_mask;
       m_render_mask |= DYNAMIC_ONLY;
       for (Hitable *hitable : m_vhitables)
-         hitable->Render(m_render_mask);
+         if (!IsCulled(hitable))
+            hitable->Render(m_render_mask);
       m_render_mask = mask;
    }
    
@@ -4536,7 +4738,14 @@ void Player::DoDebugObjectMenu(const int x, const int y)
 
    vector<HitObject*> vhoHit;
    m_hitoctree_dynamic.HitTestXRay(&ballT, vhoHit, ballT.m_coll);
-   m_hitoctree.HitTestXRay(&ballT, vhoHit, ballT.m_coll);
+#ifndef USE_EMBREE
+   if (m_collisionStructure == CS_BVH)
+      m_hitbvh.HitTestXRay(&ballT, vhoHit, ballT.m_coll);
+   else if (m_collisionStructure == CS_KDTREE)
+      m_hitkd.HitTestXRay(&ballT, vhoHit, ballT.m_coll);
+   else
+#endif
+      m_hitoctree.HitTestXRay(&ballT, vhoHit, ballT.m_coll);
    m_debugoctree.HitTestXRay(&ballT, vhoHit, ballT.m_coll);
 
    if (vhoHit.empty())
@@ -2,11 +2,14 @@
 
 #include "physics/kdtree.h"
 #include "physics/quadtree.h"
+#include "physics/bvh.h"
 #include "Debugger.h"
 #include "typedefs3D.h"
 #include "pininput.h"
 #include "LiveUI.h"
 
+class ThreadPool;
+
 #define DEFAULT_PLAYER_WIDTH 1024
 #define DEFAULT_PLAYER_FS_WIDTH 1920
 #define DEFAULT_PLAYER_FS_REFRESHRATE 60
@@ -338,12 +341,6 @@ class NudgeFilterY : public NudgeFilter
 
 ////////////////////////////////////////////////////////////////////////////////
 
-struct TimerOnOff
-{
-   HitTimer* m_timer;
-   bool m_enabled;
-};
-
 class Player : public CWnd
 {
 public:
@@ -460,10 +457,15 @@ public:
    U32 c_kDNextlevels;
    U32 c_quadObjects;
    U32 c_quadNextlevels;
+   U32 c_bvhObjects;
+   U32 c_bvhNodes;
 
    U32 c_traversed;
    U32 c_tested;
    U32 c_deepTested;
+   U32 c_ballQueries; // number of ball queries of the collision trees, for the per ball averages of c_traversed/c_tested
+   U32 c_maxTraversedPerBall;
+   U32 c_maxTestedPerBall;
 #endif
 
    U32 m_movedPlunger; // has plunger moved, must have moved at least three times
@@ -491,10 +493,24 @@ private:
 private:
 #endif
    vector<HitObject *> m_vho;
+   PhysicsArena m_physicsArena; // memory of m_vho and m_vdebugho hit objects
 
    vector<Ball *> m_vballDelete; // Balls to free at the end of the frame
 
-   /*HitKD*/ HitQuadtree m_hitoctree;
+   // static hit objects are stored in one of these structures, selected per table in the settings
+   enum CollisionStructure
+   {
+      CS_QUADTREE,
+      CS_KDTREE,
+      CS_BVH
+   };
+   CollisionStructure m_collisionStructure;
+   HitQuadtree m_hitoctree;
+#ifndef USE_EMBREE
+   HitKD m_hitkd;
+   HitBVH m_hitbvh;
+   void HitTestStaticBall(const Ball * const pball, CollisionEvent& coll) const;
+#endif
 
    vector<HitObject *> m_vdebugho;
    HitQuadtree m_debugoctree;
@@ -547,6 +563,15 @@ private:
 
    void RenderStaticPrepass();
    void DrawBulbLightBuffer();
+   // Bulb light buffers, one per bulb light render of a frame (main view, reflection probes), kept between frames to skip unchanged renders
+   static constexpr unsigned int MAX_BULB_LIGHT_BUFFERS = 4;
+   struct BulbLightBuffer
+   {
+      RenderTarget *rt = nullptr;
+      U64 hash = 0; // Hash of the commands of the last executed render
+   };
+   vector<BulbLightBuffer> m_bulbLightBuffers;
+   unsigned int m_bulbLightBufferIndex = 0;
    void RenderDynamics();
    void PrepareVideoBuffers();
    void Bloom();
@@ -558,6 +583,11 @@ private:
 
    Vertex2D m_ScreenOffset; // for screen shake effect during nudge
 
+   void BlendAnimatedPrimitives(); // blend the animation frames of all animated primitives concurrently, before rendering them
+   vector<Primitive*> m_animatedPrimitives; // primitives with animation frames, gathered once at render setup
+   vector<Primitive*> m_blendedPrimitives; // animated primitives to blend for the current frame
+   ThreadPool *m_animationThreadPool = nullptr; // created on first use
+
 public:
    vector<Light*> m_ballReflectedLights;
    MeshBuffer *m_ballMeshBuffer = nullptr;
@@ -586,6 +616,8 @@ public:
 
    void UpdateBasicShaderMatrix(const Matrix3D &objectTrafo = Matrix3D::MatrixIdentity());
    void UpdateBallShaderMatrix();
+   bool IsCulled(Renderable *renderable); // CPU side view frustum culling of parts providing their render bounds
+   bool m_viewCulling;
 
    #ifdef ENABLE_SDL
    SDL_Window  *m_sdl_playfieldHwnd;
@@ -681,8 +713,7 @@ public:
    vector<Ball*> m_vball;
    vector<HitFlipper*> m_vFlippers;
 
-   vector<HitTimer*> m_vht;
-   vector<TimerOnOff> m_changed_vht; // stores all en/disable changes to the m_vht timer list, to avoid problems with timers dis/enabling themselves
+   TimerScheduler m_timers;
 
 #pragma region Input
 public:
@@ -1111,6 +1111,100 @@ STDMETHODIMP ScriptGlobalTable::GetBalls(LPSAFEARRAY *pVal)
    return S_OK;
 }
 
+// Columns of the array filled by GetBallStates
+enum BallStateField
+{
+   BALLSTATE_X, BALLSTATE_Y, BALLSTATE_Z,
+   BALLSTATE_VELX, BALLSTATE_VELY, BALLSTATE_VELZ,
+   BALLSTATE_ANGVELX, BALLSTATE_ANGVELY, BALLSTATE_ANGVELZ,
+   BALLSTATE_RADIUS, BALLSTATE_ID,
+   BALLSTATE_COUNT
+};
+
+// Packed state of all balls in a single call, instead of one IDispatch call per ball and property (rolling sounds, ball shadows, ...).
+// States(ball, field) is filled in place if it already holds a large enough array from a previous call, so that scripts polling the
+// balls every few milliseconds don't reallocate it. Only the first rows (returned ball count) are valid.
+STDMETHODIMP ScriptGlobalTable::GetBallStates(VARIANT *States, int *pVal)
+{
+   if (!States || !pVal || !g_pplayer)
+      return E_POINTER;
+
+   VARIANT * const pStates = (V_VT(States) == (VT_BYREF | VT_VARIANT)) ? V_VARIANTREF(States) : States;
+   const LONG nBalls = (LONG)g_pplayer->m_vball.size();
+
+   LONG nRows = 0;
+   SAFEARRAY *psa = (V_VT(pStates) == (VT_ARRAY | VT_VARIANT)) ? V_ARRAY(pStates) : nullptr;
+   if (psa)
+   {
+      LONG lbound0, ubound0, lbound1, ubound1;
+      if (SafeArrayGetDim(psa) != 2
+         || SafeArrayGetLBound(psa, 1, &lbound0) != S_OK || SafeArrayGetUBound(psa, 1, &ubound0) != S_OK
+         || SafeArrayGetLBound(psa, 2, &lbound1) != S_OK || SafeArrayGetUBound(psa, 2, &ubound1) != S_OK
+         || lbound0 != 0 || ubound0 < nBalls - 1 || lbound1 != 0 || ubound1 != BALLSTATE_COUNT - 1)
+         psa = nullptr;
+      else
+         nRows = ubound0 + 1;
+   }
+   if (psa == nullptr)
+   {
+      // Leave some room for multiball and balls created later on
+      nRows = max(nBalls, (LONG)8);
+      SAFEARRAYBOUND bounds[2] = { { (ULONG)nRows, 0 }, { (ULONG)BALLSTATE_COUNT, 0 } };
+      psa = SafeArrayCreate(VT_VARIANT, 2, bounds);
+      if (psa == nullptr)
+         return E_OUTOFMEMORY;
+      if (FAILED(VariantClear(pStates))) // e.g. fixed size array of the wrong size
+      {
+         SafeArrayDestroy(psa);
+         return E_INVALIDARG;
+      }
+      V_VT(pStates) = VT_ARRAY | VT_VARIANT;
+      V_ARRAY(pStates) = psa;
+   }
+
+   VARIANT *data;
+   if (FAILED(SafeArrayAccessData(psa, (void **)&data)))
+      return E_FAIL;
+   // First dimension varies fastest
+   const auto set = [data, nRows](const LONG ball, const BallStateField field, const float value)
+   {
+      VARIANT &v = data[field * nRows + ball];
+      if (V_VT(&v) != VT_R4)
+      {
+         VariantClear(&v);
+         V_VT(&v) = VT_R4;
+      }
+      V_R4(&v) = value;
+   };
+   for (LONG i = 0; i < nBalls; ++i)
+   {
+      const Ball * const pball = g_pplayer->m_vball[i];
+      const float invInertia = 1.0f / pball->Inertia();
+      set(i, BALLSTATE_X, pball->m_d.m_pos.x);
+      set(i, BALLSTATE_Y, pball->m_d.m_pos.y);
+      set(i, BALLSTATE_Z, pball->m_d.m_pos.z);
+      set(i, BALLSTATE_VELX, pball->m_d.m_vel.x);
+      set(i, BALLSTATE_VELY, pball->m_d.m_vel.y);
+      set(i, BALLSTATE_VELZ, pball->m_d.m_vel.z);
+      set(i, BALLSTATE_ANGVELX, pball->m_angularmomentum.x * invInertia);
+      set(i, BALLSTATE_ANGVELY, pball->m_angularmomentum.y * invInertia);
+      set(i, BALLSTATE_ANGVELZ, pball->m_angularmomentum.z * invInertia);
+      set(i, BALLSTATE_RADIUS, pball->m_d.m_radius);
+      VARIANT &id = data[BALLSTATE_ID * nRows + i];
+      if (V_VT(&id) != VT_I4)
+      {
+         VariantClear(&id);
+         V_VT(&id) = VT_I4;
+      }
+      V_I4(&id) = pball->m_id;
+   }
+   SafeArrayUnaccessData(psa);
+
+   *pVal = (int)nBalls;
+
+   return S_OK;
+}
+
 STDMETHODIMP ScriptGlobalTable::GetElements(LPSAFEARRAY *pVal)
 {
    if (!pVal || !g_pplayer)
@@ -1136,18 +1230,14 @@ STDMETHODIMP ScriptGlobalTable::GetElementByName(BSTR name, IDispatch* *pVal)
    if (!pVal || !g_pplayer)
       return E_POINTER;
 
-   for (size_t i = 0; i < m_pt->m_vedit.size(); ++i)
+   IEditable * const pie = m_pt->GetElementByName(MakeString(name).c_str());
+   if (pie)
    {
-      IEditable * const pie = m_pt->m_vedit[i];
-
-      if (wcscmp(name, pie->GetScriptable()->m_wzName) == 0)
-      {
-         IDispatch * const id = pie->GetISelect()->GetDispatch();
-         id->AddRef();
-         *pVal = id;
+      IDispatch * const id = pie->GetISelect()->GetDispatch();
+      id->AddRef();
+      *pVal = id;
 
-         return S_OK;
-      }
+      return S_OK;
    }
 
    *pVal = nullptr;
@@ -3672,6 +3762,8 @@ HRESULT PinTable::LoadGameFromFilename(const string& szFileName)
 
             PLOGI << "Sound loaded"; // For profiling
 
+            m_vpinball->m_ps.PreloadMixerSamples(m_vsound);
+
             assert(m_vimage.empty());
             m_vimage.resize(ctextures); // due to multithreaded loading do pre-allocation
             {
@@ -5219,15 +5311,24 @@ const char *PinTable::GetElementName(IEditable *pedit) const
    return nullptr;
 }
 
-IEditable *PinTable::GetElementByName(const char * const name)
+IEditable *PinTable::GetElementByName(const char * const name) const
 {
-   for (size_t i = 0; i < m_vedit.size(); i++)
+   if (m_elementNameMapDirty || m_elementNameMapSize != m_vedit.size())
    {
-      IEditable * const pedit = m_vedit[i];
-      if (strcmp(name, GetElementName(pedit)) == 0)
-         return pedit;
+      m_elementNameMap.clear();
+      m_elementNameMap.reserve(m_vedit.size());
+      for (IEditable *const pedit : m_vedit)
+      {
+         const IScriptable *const pscript = pedit->GetScriptable();
+         if (pscript) // skip decals, which have no name
+            m_elementNameMap.emplace(MakeString(pscript->m_wzName), pedit); // keeps the first part in case of duplicate names
+      }
+      m_elementNameMapSize = m_vedit.size();
+      m_elementNameMapDirty = false;
    }
-   return nullptr;
+
+   const robin_hood::unordered_map<string, IEditable *, StringHashFunctor, StringComparator>::const_iterator it = m_elementNameMap.find(name);
+   return it != m_elementNameMap.end() ? it->second : nullptr;
 }
 
 bool PinTable::FMutilSelLocked()
@@ -6280,6 +6381,7 @@ void PinTable::EndUndo()
 void PinTable::Undo()
 {
    m_undo.Undo();
+   InvalidateElementNameMap(); // names may have been restored
 
    SetDirtyDraw();
    SetMyScrollInfo();
@@ -6932,6 +7034,8 @@ STDMETHODIMP PinTable::put_Offset(float newVal)
 
 HRESULT PinTable::StopSound(BSTR Sound)
 {
+   PROFILE_FUNCTION(FrameProfiler::PROFILE_AUDIO);
+
    char szName[MAXSTRING];
    WideCharToMultiByteNull(CP_ACP, 0, Sound, -1, szName, MAXSTRING, nullptr, nullptr);
 
@@ -6960,6 +7064,9 @@ void PinTable::StopAllSounds()
 
 STDMETHODIMP PinTable::PlaySound(BSTR bstr, int loopcount, float volume, float pan, float randompitch, int pitch, VARIANT_BOOL usesame, VARIANT_BOOL restart, float front_rear_fade)
 {
+   PROFILE_FUNCTION(FrameProfiler::PROFILE_AUDIO);
+   g_frameProfiler.IncrementCounter(FrameProfiler::PROFILE_AUDIO_PLAYS);
+
    char szName[MAXSTRING];
    WideCharToMultiByteNull(CP_ACP, 0, bstr, -1, szName, MAXSTRING, nullptr, nullptr);
 
@@ -7860,6 +7967,49 @@ void PinTable::AuditTable() const
    info.DoModal();
 }
 
+void PinTable::OptimizePrimitiveMeshes()
+{
+   const int answer = m_mdiTable->MessageBox("This will reorder the triangles and vertices of all imported primitive meshes for faster rendering.\n\nDo you also want to quantize normals and texture coordinates to 16 bits (smaller table file, minor precision loss)?",
+      "Optimize Primitive Meshes", MB_YESNOCANCEL | MB_ICONQUESTION);
+   if (answer == IDCANCEL)
+      return;
+   const bool quantize = answer == IDYES;
+
+   std::stringstream ss;
+   ss << std::fixed << std::setprecision(3);
+   size_t nPrims = 0, nTris = 0;
+   double acmrBefore = 0., acmrAfter = 0.;
+   BeginUndo();
+   for (IEditable *const part : m_vedit)
+      if (part->GetItemType() == eItemPrimitive && ((Primitive *)part)->m_d.m_use3DMesh)
+      {
+         Primitive *const prim = (Primitive *)part;
+         prim->MarkForUndo();
+         MeshCacheStats before, after;
+         prim->OptimizeMesh(quantize, before, after);
+         const size_t nPrimTris = prim->m_mesh.NumIndices() / 3;
+         ss << part->GetName() << ": ACMR " << before.m_acmr << " => " << after.m_acmr << ", ATVR " << before.m_atvr << " => " << after.m_atvr << "\r\n";
+         nPrims++;
+         nTris += nPrimTris;
+         acmrBefore += before.m_acmr * (double)nPrimTris;
+         acmrAfter += after.m_acmr * (double)nPrimTris;
+      }
+   EndUndo();
+   SetDirtyDraw();
+
+   string msg = "Optimized " + std::to_string(nPrims) + " primitive meshes";
+   if (nTris > 0)
+   {
+      std::stringstream total;
+      total << std::fixed << std::setprecision(3) << ", average ACMR (transformed vertices per triangle): " << acmrBefore / (double)nTris << " => " << acmrAfter / (double)nTris;
+      msg += total.str();
+   }
+   msg += "\r\n\r\n" + ss.str();
+   PLOGI << msg;
+   InfoDialog info(msg);
+   info.DoModal();
+}
+
 void PinTable::ListCustomInfo(HWND hwndListView)
 {
    for (size_t i = 0; i < m_vCustomInfoTag.size(); i++)
@@ -10493,6 +10643,64 @@ STDMETHODIMP PinTable::put_Option(BSTR optionName, float minValue, float maxValu
    return S_OK;
 }
 
+STDMETHODIMP PinTable::BindLamp(long number, VARIANT objects)
+{
+   const VARIANT * const pObjects = (V_VT(&objects) == (VT_BYREF | VT_VARIANT)) ? V_VARIANTREF(&objects) : &objects;
+   const auto bind = [this, number](IDispatch * const pdisp)
+   {
+      if (pdisp)
+         for (IEditable * const pie : m_vedit)
+            if (pie->GetDispatch() == pdisp)
+               return m_controllerBindings.Bind(number, pie);
+      return false;
+   };
+
+   // A single part or an array of parts (like the Lights() array of core.vbs)
+   if (V_VT(pObjects) == VT_DISPATCH)
+      return bind(V_DISPATCH(pObjects)) ? S_OK : E_INVALIDARG;
+   if (V_VT(pObjects) != (VT_ARRAY | VT_VARIANT))
+      return E_INVALIDARG;
+   SAFEARRAY * const psa = V_ARRAY(pObjects);
+   LONG lbound, ubound;
+   if (SafeArrayGetDim(psa) != 1 || SafeArrayGetLBound(psa, 1, &lbound) != S_OK || SafeArrayGetUBound(psa, 1, &ubound) != S_OK)
+      return E_INVALIDARG;
+   bool allBound = true;
+   for (LONG i = lbound; i <= ubound; ++i)
+   {
+      VARIANT v;
+      VariantInit(&v);
+      SafeArrayGetElement(psa, &i, &v);
+      allBound &= V_VT(&v) == VT_DISPATCH && bind(V_DISPATCH(&v));
+      VariantClear(&v);
+   }
+   return allBound ? S_OK : E_INVALIDARG;
+}
+
+STDMETHODIMP PinTable::ClearBindings()
+{
+   m_controllerBindings.Clear();
+   return S_OK;
+}
+
+STDMETHODIMP PinTable::SetBindingController(VARIANT controller, float scale)
+{
+   const VARIANT * const pController = (V_VT(&controller) == (VT_BYREF | VT_VARIANT)) ? V_VARIANTREF(&controller) : &controller;
+   // Nothing/Empty selects the local stand-in provider (see SimulateLamp)
+   if (V_VT(pController) == VT_DISPATCH && V_DISPATCH(pController))
+      m_controllerBindings.SetProvider(new DispatchControllerProvider(V_DISPATCH(pController)), scale);
+   else if (V_VT(pController) == VT_DISPATCH || V_VT(pController) == VT_EMPTY || V_VT(pController) == VT_ERROR)
+      m_controllerBindings.SetProvider(nullptr, scale);
+   else
+      return E_INVALIDARG;
+   return S_OK;
+}
+
+STDMETHODIMP PinTable::SimulateLamp(long number, float state)
+{
+   m_controllerBindings.GetLocalProvider().SetLamp(number, state);
+   return S_OK;
+}
+
 void PinTable::InvokeBallBallCollisionCallback(const Ball *b1, const Ball *b2, float hitVelocity)
 {
    if (g_pplayer)
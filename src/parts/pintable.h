@@ -12,6 +12,7 @@
 #include "SearchSelectDialog.h"
 #include "renderer/RenderProbe.h"
 #include "renderer/ViewSetup.h"
+#include "core/ControllerBindings.h"
 
 #define VIEW_PLAYFIELD 1
 #define VIEW_BACKGLASS 2
@@ -318,6 +319,11 @@ public:
    STDMETHOD(get_Option)(BSTR optionName, float minValue, float maxValue, float step, float defaultValue, int unit, /*[optional][in]*/ VARIANT values, /*[out, retval]*/ float *param);
    STDMETHOD(put_Option)(BSTR optionName, float minValue, float maxValue, float step, float defaultValue, int unit, /*[optional][in]*/ VARIANT values, /*[in]*/ float val);
 
+   STDMETHOD(BindLamp)(/*[in]*/ long number, /*[in]*/ VARIANT objects);
+   STDMETHOD(ClearBindings)();
+   STDMETHOD(SetBindingController)(/*[in]*/ VARIANT controller, /*[in, defaultvalue(1)]*/ float scale);
+   STDMETHOD(SimulateLamp)(/*[in]*/ long number, /*[in]*/ float state);
+
    /////////////////////////////////////////////
 
    PinTable();
@@ -386,6 +392,7 @@ public:
    RenderProbe *GetRenderProbe(const string &szName) const;
 
    void AuditTable() const;
+   void OptimizePrimitiveMeshes(); // reorder (and optionally quantize) all imported primitive meshes, reporting the vertex cache statistics
 
    void ListCustomInfo(HWND hwndListView);
    int AddListItem(HWND hwndListView, const string &szName, const string &szValue1, LPARAM lparam);
@@ -435,7 +442,10 @@ public:
    virtual const PinTable *GetPTable() const override { return this; }
    const char *GetElementName(IEditable *pedit) const;
 
-   IEditable *GetElementByName(const char *const name);
+   IEditable *GetElementByName(const char *const name) const; // case insensitive
+   void InvalidateElementNameMap() { m_elementNameMapDirty = true; } // to be called when parts are removed, renamed or reordered (added parts are detected)
+
+   ControllerBindings m_controllerBindings; // lamp to parts bindings registered by the script, applied by the player each frame
    void OnDelete();
 
    void DoLeftButtonDown(int x, int y, bool zoomIn);
@@ -873,6 +883,9 @@ private:
    robin_hood::unordered_map<string, Material *, StringHashFunctor, StringComparator> m_materialMap; // hash table to speed up material lookup by name
    robin_hood::unordered_map<string, Light *, StringHashFunctor, StringComparator> m_lightMap; // hash table to speed up light lookup by name
    robin_hood::unordered_map<string, RenderProbe *, StringHashFunctor, StringComparator> m_renderprobeMap; // hash table to speed up renderprobe lookup by name
+   mutable robin_hood::unordered_map<string, IEditable *, StringHashFunctor, StringComparator> m_elementNameMap; // hash table to speed up part lookup by name, rebuilt on demand
+   mutable size_t m_elementNameMapSize = 0; // number of parts when m_elementNameMap was built
+   mutable bool m_elementNameMapDirty = true;
    bool m_moving;
 
    ToneMapper m_toneMapper = ToneMapper::TM_AGX;
@@ -963,6 +976,7 @@ public:
    STDMETHOD(get_JoyCustomKey)(/*[in]*/ long index, /*[out, retval]*/ long *pVal);
 
    STDMETHOD(GetBalls)(/*[out, retval]*/ LPSAFEARRAY *pVal);
+   STDMETHOD(GetBallStates)(/*[in, out]*/ VARIANT *States, /*[out, retval]*/ int *pVal);
    STDMETHOD(GetElements)(/*[out, retval]*/ LPSAFEARRAY *pVal);
    STDMETHOD(GetElementByName)(/*[in]*/ BSTR name, /*[out, retval]*/ IDispatch **pVal);
    STDMETHOD(get_ActiveTable)(/*[out, retval]*/ ITable **pVal);
@@ -7,6 +7,7 @@
 #include "objloader.h"
 #include "miniz/miniz.h"
 #include "progmesh.h"
+#include "physics/collisionmeshcache.h"
 #include "ThreadPool.h"
 #include "renderer/Shader.h"
 
@@ -19,6 +20,7 @@ void Mesh::Clear()
    for (size_t i = 0; i < m_animationFrames.size(); i++)
       m_animationFrames[i].m_frameVerts.clear();
    m_animationFrames.clear();
+   m_packedFrames.clear();
    middlePoint.x = 0.0f;
    middlePoint.y = 0.0f;
    middlePoint.z = 0.0f;
@@ -129,37 +131,7 @@ void Mesh::UploadToVB(VertexBuffer * vb, const float frame)
       return;
 
    if (frame >= 0.f)
-   {
-      float intPart;
-      const float fractpart = modff(frame, &intPart);
-      const int iFrame = (int)intPart;
-
-      if (iFrame+1 < (int)m_animationFrames.size())
-      {
-          for (size_t i = 0; i < m_vertices.size(); i++)
-          {
-              const VertData& v  = m_animationFrames[iFrame  ].m_frameVerts[i];
-              const VertData& v2 = m_animationFrames[iFrame+1].m_frameVerts[i];
-              m_vertices[i].x  = v.x  + (v2.x  - v.x) *fractpart;
-              m_vertices[i].y  = v.y  + (v2.y  - v.y) *fractpart;
-              m_vertices[i].z  = v.z  + (v2.z  - v.z) *fractpart;
-              m_vertices[i].nx = v.nx + (v2.nx - v.nx)*fractpart;
-              m_vertices[i].ny = v.ny + (v2.ny - v.ny)*fractpart;
-              m_vertices[i].nz = v.nz + (v2.nz - v.nz)*fractpart;
-          }
-      }
-      else
-          for (size_t i = 0; i < m_vertices.size(); i++)
-          {
-              const VertData& v = m_animationFrames[iFrame].m_frameVerts[i];
-              m_vertices[i].x  = v.x;
-              m_vertices[i].y  = v.y;
-              m_vertices[i].z  = v.z;
-              m_vertices[i].nx = v.nx;
-              m_vertices[i].ny = v.ny;
-              m_vertices[i].nz = v.nz;
-          }
-   }
+      BlendAnimationFrames(frame);
 
    Vertex3D_NoTex2 *buf;
    vb->lock(0, 0, (void**)&buf, VertexBuffer::WRITEONLY);
@@ -167,6 +139,98 @@ void Mesh::UploadToVB(VertexBuffer * vb, const float frame)
    vb->unlock();
 }
 
+void Mesh::BlendAnimationFrames(const float frame)
+{
+   if (m_animationFrames.empty())
+      return;
+
+   const size_t numVertices = m_vertices.size();
+   const size_t numGroups = (numVertices + 3) / 4;
+   const size_t frameSize = numGroups * 24;
+   if (m_packedFrames.empty())
+   {
+      m_packedFrames.resize(m_animationFrames.size() * frameSize, 0.f);
+      for (size_t f = 0; f < m_animationFrames.size(); f++)
+         for (size_t i = 0; i < numVertices; i++)
+         {
+            const VertData& v = m_animationFrames[f].m_frameVerts[i];
+            float* const __restrict group = &m_packedFrames[f * frameSize + (i / 4) * 24 + (i & 3)];
+            group[ 0] = v.x;
+            group[ 4] = v.y;
+            group[ 8] = v.z;
+            group[12] = v.nx;
+            group[16] = v.ny;
+            group[20] = v.nz;
+         }
+   }
+
+   float intPart;
+   float fractpart = modff(frame, &intPart);
+   const size_t iFrame = min((size_t)intPart, m_animationFrames.size() - 1);
+   const float* const __restrict a = &m_packedFrames[iFrame * frameSize];
+   const float* const __restrict b = iFrame + 1 < m_animationFrames.size() ? a + frameSize : a;
+   if (a == b)
+      fractpart = 0.f;
+
+   Vertex3D_NoTex2* const __restrict out = m_vertices.data();
+#ifdef ENABLE_SSE_OPTIMIZATIONS
+   const __m128 f = _mm_set1_ps(fractpart);
+   for (size_t g = 0; g < numGroups; g++)
+   {
+      const float* const __restrict ga = a + g * 24;
+      const float* const __restrict gb = b + g * 24;
+      __m128 c[6];
+      for (int k = 0; k < 6; k++)
+      {
+         const __m128 va = _mm_loadu_ps(ga + k * 4);
+         c[k] = _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(gb + k * 4), va), f));
+      }
+      // back to the vertex layout: x,y,z,nx of each vertex by transposition, then the ny,nz pairs (texture coordinates are left untouched)
+      _MM_TRANSPOSE4_PS(c[0], c[1], c[2], c[3]);
+      const __m128 n01 = _mm_unpacklo_ps(c[4], c[5]);
+      const __m128 n23 = _mm_unpackhi_ps(c[4], c[5]);
+      const size_t i = g * 4;
+      if (i + 4 <= numVertices)
+      {
+         _mm_storeu_ps(&out[i    ].x, c[0]);
+         _mm_storeu_ps(&out[i + 1].x, c[1]);
+         _mm_storeu_ps(&out[i + 2].x, c[2]);
+         _mm_storeu_ps(&out[i + 3].x, c[3]);
+         _mm_storel_pi((__m64*)&out[i    ].ny, n01);
+         _mm_storeh_pi((__m64*)&out[i + 1].ny, n01);
+         _mm_storel_pi((__m64*)&out[i + 2].ny, n23);
+         _mm_storeh_pi((__m64*)&out[i + 3].ny, n23);
+      }
+      else // last partial group
+      {
+         Vertex3D_NoTex2 tmp[4];
+         _mm_storeu_ps(&tmp[0].x, c[0]);
+         _mm_storeu_ps(&tmp[1].x, c[1]);
+         _mm_storeu_ps(&tmp[2].x, c[2]);
+         _mm_storeu_ps(&tmp[3].x, c[3]);
+         _mm_storel_pi((__m64*)&tmp[0].ny, n01);
+         _mm_storeh_pi((__m64*)&tmp[1].ny, n01);
+         _mm_storel_pi((__m64*)&tmp[2].ny, n23);
+         _mm_storeh_pi((__m64*)&tmp[3].ny, n23);
+         for (size_t k = 0; i + k < numVertices; k++)
+            memcpy(&out[i + k], &tmp[k], 6 * sizeof(float));
+      }
+   }
+#else
+   for (size_t i = 0; i < numVertices; i++)
+   {
+      const float* const __restrict ga = a + (i / 4) * 24 + (i & 3);
+      const float* const __restrict gb = b + (i / 4) * 24 + (i & 3);
+      out[i].x  = ga[ 0] + (gb[ 0] - ga[ 0])*fractpart;
+      out[i].y  = ga[ 4] + (gb[ 4] - ga[ 4])*fractpart;
+      out[i].z  = ga[ 8] + (gb[ 8] - ga[ 8])*fractpart;
+      out[i].nx = ga[12] + (gb[12] - ga[12])*fractpart;
+      out[i].ny = ga[16] + (gb[16] - ga[16])*fractpart;
+      out[i].nz = ga[20] + (gb[20] - ga[20])*fractpart;
+   }
+#endif
+}
+
 void Mesh::UpdateBounds()
 {
    if (!m_validBounds)
@@ -186,6 +250,195 @@ void Mesh::UpdateBounds()
    }
 }
 
+static constexpr unsigned int STATS_VERTEX_CACHE_SIZE = 16; // FIFO post transform cache size used for the statistics and the overdraw clustering
+static constexpr float OVERDRAW_CACHE_THRESHOLD = 1.05f; // maximum ACMR increase allowed by the overdraw reordering
+
+MeshCacheStats Mesh::ComputeCacheStats() const
+{
+   MeshCacheStats stats;
+   if (m_indices.size() < 3 || m_vertices.empty())
+      return stats;
+
+   vector<unsigned int> timestamps(m_vertices.size(), 0);
+   unsigned int time = STATS_VERTEX_CACHE_SIZE + 1;
+   size_t misses = 0;
+   for (const unsigned int idx : m_indices)
+      if (time - timestamps[idx] > STATS_VERTEX_CACHE_SIZE)
+      {
+         timestamps[idx] = time++;
+         misses++;
+      }
+   stats.m_acmr = (float)misses / (float)(m_indices.size() / 3);
+   stats.m_atvr = (float)misses / (float)m_vertices.size();
+   return stats;
+}
+
+// Split the (vertex cache optimized) triangle list into clusters where the vertex cache restarts anyway, then draw the clusters
+// facing away from the mesh center first, as they are the most likely to occlude the others (see Sander, Nehab and Barczak,
+// "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"). The order is kept if the vertex cache efficiency suffers too much.
+void Mesh::OptimizeOverdraw()
+{
+   const size_t numTriangles = m_indices.size() / 3;
+
+   // Cache misses per triangle
+   vector<BYTE> triangleMisses(numTriangles);
+   {
+      vector<unsigned int> timestamps(m_vertices.size(), 0);
+      unsigned int time = STATS_VERTEX_CACHE_SIZE + 1;
+      for (size_t t = 0; t < numTriangles; t++)
+      {
+         BYTE misses = 0;
+         for (size_t k = 0; k < 3; k++)
+         {
+            const unsigned int idx = m_indices[t * 3 + k];
+            if (time - timestamps[idx] > STATS_VERTEX_CACHE_SIZE)
+            {
+               timestamps[idx] = time++;
+               misses++;
+            }
+         }
+         triangleMisses[t] = misses;
+      }
+   }
+   const MeshCacheStats initialStats = ComputeCacheStats();
+
+   // Clusters start where all vertices of a triangle miss the cache (hard boundary), or where the current cluster, drawn from an empty cache,
+   // is already about as cache efficient as the whole mesh (soft boundary)
+   struct Cluster
+   {
+      size_t m_start, m_count;
+      float m_sortKey;
+   };
+   vector<Cluster> clusters;
+   {
+      vector<unsigned int> timestamps(m_vertices.size(), 0);
+      unsigned int time = 0;
+      size_t clusterMisses = 0;
+      for (size_t t = 0; t < numTriangles; t++)
+      {
+         if (clusters.empty() || triangleMisses[t] == 3 || (float)clusterMisses <= OVERDRAW_CACHE_THRESHOLD * initialStats.m_acmr * (float)clusters.back().m_count)
+         {
+            clusters.push_back({ t, 0, 0.f });
+            clusterMisses = 0;
+            time += STATS_VERTEX_CACHE_SIZE + 1; // flush the cache
+         }
+         clusters.back().m_count++;
+         for (size_t k = 0; k < 3; k++)
+         {
+            const unsigned int idx = m_indices[t * 3 + k];
+            if (time - timestamps[idx] > STATS_VERTEX_CACHE_SIZE)
+            {
+               timestamps[idx] = time++;
+               clusterMisses++;
+            }
+         }
+      }
+   }
+   if (clusters.size() < 2)
+      return;
+
+   // Area weighted centers and normals (from the vertex normals, to not depend on the winding order)
+   Vertex3Ds meshCenter(0.f, 0.f, 0.f);
+   float meshArea = 0.f;
+   vector<Vertex3Ds> clusterCenters(clusters.size()), clusterNormals(clusters.size());
+   for (size_t c = 0; c < clusters.size(); c++)
+   {
+      Vertex3Ds center(0.f, 0.f, 0.f), normal(0.f, 0.f, 0.f);
+      float area = 0.f;
+      for (size_t t = clusters[c].m_start; t < clusters[c].m_start + clusters[c].m_count; t++)
+      {
+         const Vertex3D_NoTex2 &v0 = m_vertices[m_indices[t * 3]], &v1 = m_vertices[m_indices[t * 3 + 1]], &v2 = m_vertices[m_indices[t * 3 + 2]];
+         const Vertex3Ds p0(v0.x, v0.y, v0.z), p1(v1.x, v1.y, v1.z), p2(v2.x, v2.y, v2.z);
+         const float triArea = 0.5f * CrossProduct(p1 - p0, p2 - p0).Length();
+         center += (p0 + p1 + p2) * (triArea * (float)(1.0 / 3.0));
+         normal += Vertex3Ds(v0.nx + v1.nx + v2.nx, v0.ny + v1.ny + v2.ny, v0.nz + v1.nz + v2.nz) * triArea;
+         area += triArea;
+      }
+      meshCenter += center;
+      meshArea += area;
+      clusterCenters[c] = area > 0.f ? center * (1.0f / area) : center;
+      normal.NormalizeSafe();
+      clusterNormals[c] = normal;
+   }
+   if (meshArea > 0.f)
+      meshCenter = meshCenter * (1.0f / meshArea);
+   for (size_t c = 0; c < clusters.size(); c++)
+      clusters[c].m_sortKey = (clusterCenters[c] - meshCenter).Dot(clusterNormals[c]);
+
+   std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster &a, const Cluster &b) { return a.m_sortKey > b.m_sortKey; });
+
+   vector<unsigned int> indices;
+   indices.reserve(m_indices.size());
+   for (const Cluster &cluster : clusters)
+      indices.insert(indices.end(), m_indices.begin() + cluster.m_start * 3, m_indices.begin() + (cluster.m_start + cluster.m_count) * 3);
+   indices.swap(m_indices);
+   if (ComputeCacheStats().m_acmr > OVERDRAW_CACHE_THRESHOLD * initialStats.m_acmr)
+      indices.swap(m_indices);
+}
+
+void Mesh::Optimize(const bool quantize)
+{
+   if (m_indices.size() < 3 || m_vertices.empty())
+      return;
+
+   unsigned int* const tmp = reorderForsyth(m_indices, (int)NumVertices());
+   if (tmp != nullptr)
+   {
+      memcpy(m_indices.data(), tmp, NumIndices() * sizeof(unsigned int));
+      delete[] tmp;
+   }
+
+   OptimizeOverdraw();
+
+   // Vertices in the order of their first use, unused vertices are dropped
+   vector<unsigned int> remap(NumVertices(), ~0u);
+   unsigned int numUsed = 0;
+   for (unsigned int &idx : m_indices)
+   {
+      if (remap[idx] == ~0u)
+         remap[idx] = numUsed++;
+      idx = remap[idx];
+   }
+   vector<Vertex3D_NoTex2> vertices(numUsed);
+   for (size_t i = 0; i < remap.size(); i++)
+      if (remap[i] != ~0u)
+         vertices[remap[i]] = m_vertices[i];
+   m_vertices.swap(vertices);
+   for (FrameData &frame : m_animationFrames)
+   {
+      vector<VertData> frameVerts(numUsed);
+      for (size_t i = 0; i < remap.size(); i++)
+         if (remap[i] != ~0u)
+            frameVerts[remap[i]] = frame.m_frameVerts[i];
+      frame.m_frameVerts.swap(frameVerts);
+   }
+
+   if (quantize)
+   {
+      // normals as 16 bit normalized integers, texture coordinates as half floats (as they may be outside of [0..1])
+      const auto quantizeNormal = [](float &nx, float &ny, float &nz)
+      {
+         Vertex3Ds n(nx, ny, nz);
+         n.NormalizeSafe();
+         nx = (float)(int)lroundf(clamp(n.x, -1.f, 1.f) * 32767.f) * (float)(1.0 / 32767.0);
+         ny = (float)(int)lroundf(clamp(n.y, -1.f, 1.f) * 32767.f) * (float)(1.0 / 32767.0);
+         nz = (float)(int)lroundf(clamp(n.z, -1.f, 1.f) * 32767.f) * (float)(1.0 / 32767.0);
+      };
+      for (Vertex3D_NoTex2 &v : m_vertices)
+      {
+         quantizeNormal(v.nx, v.ny, v.nz);
+         v.tu = half2float(float2half_noLUT(v.tu));
+         v.tv = half2float(float2half_noLUT(v.tv));
+      }
+      for (FrameData &frame : m_animationFrames)
+         for (VertData &v : frame.m_frameVerts)
+            quantizeNormal(v.nx, v.ny, v.nz);
+   }
+
+   m_packedFrames.clear();
+   m_validBounds = false;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 Primitive::Primitive()
@@ -527,45 +780,39 @@ void Primitive::GetHitShapes(vector<HitObject*> &pvho)
       if (i2 < prog_indices.size())
          prog_indices.resize(i2);
       }
-      vector<unsigned int> prog_map;
-      vector<unsigned int> prog_perm;
-      ProgMesh::ProgressiveMesh(prog_vertices, prog_indices, prog_map, prog_perm);
-      ProgMesh::PermuteVertices(prog_perm, prog_vertices, prog_indices);
-      prog_perm.clear();
-
-      vector<ProgMesh::tridata> prog_new_indices;
-      ProgMesh::ReMapIndices(reduced_vertices, prog_indices, prog_new_indices, prog_map);
-      prog_indices.clear();
-      prog_map.clear();
+      // The reduction only depends on the mesh and the targeted vertex count, so reuse it if already done in a previous play session
+      const U64 cacheKey = CollisionMeshCache::ComputeKey(prog_vertices, prog_indices, reduced_vertices);
+      std::shared_ptr<const CollisionMeshCache::Mesh> reduced = g_collisionMeshCache.Find(cacheKey);
+      if (reduced == nullptr || reduced->m_vertices.size() != prog_vertices.size() || !reduced->HasValidIndices())
+      {
+         vector<unsigned int> prog_map;
+         vector<unsigned int> prog_perm;
+         ProgMesh::ProgressiveMesh(prog_vertices, prog_indices, prog_map, prog_perm);
+         ProgMesh::PermuteVertices(prog_perm, prog_vertices, prog_indices);
+         prog_perm.clear();
+
+         const std::shared_ptr<CollisionMeshCache::Mesh> mesh = std::make_shared<CollisionMeshCache::Mesh>();
+         ProgMesh::ReMapIndices(reduced_vertices, prog_indices, mesh->m_indices, prog_map);
+         prog_indices.clear();
+         prog_map.clear();
+         mesh->m_vertices = std::move(prog_vertices);
+         g_collisionMeshCache.Add(cacheKey, mesh);
+         reduced = mesh;
+      }
+      const vector<ProgMesh::float3>& prog_new_vertices = reduced->m_vertices;
+      const vector<ProgMesh::tridata>& prog_new_indices = reduced->m_indices;
 
       //
 
-      robin_hood::unordered_set<robin_hood::pair<unsigned, unsigned>> addedEdges;
+      m_hitMesh = std::make_unique<HitMesh>();
+      m_hitMesh->m_vertices.resize(prog_new_vertices.size());
+      for (size_t i = 0; i < prog_new_vertices.size(); ++i)
+         m_hitMesh->m_vertices[i] = Vertex3Ds(prog_new_vertices[i].x, prog_new_vertices[i].y, prog_new_vertices[i].z);
 
-      // add collision triangles and edges
+      // NB: HitMesh wants CCW vertices, but for rendering we have them in CW order
+      m_hitMesh->m_triangles.reserve(prog_new_indices.size());
       for (size_t i = 0; i < prog_new_indices.size(); ++i)
-      {
-         const unsigned int i0 = prog_new_indices[i].v[0];
-         const unsigned int i1 = prog_new_indices[i].v[1];
-         const unsigned int i2 = prog_new_indices[i].v[2];
-
-         Vertex3Ds rgv3D[3];
-         // NB: HitTriangle wants CCW vertices, but for rendering we have them in CW order
-         rgv3D[0].x = prog_vertices[i0].x; rgv3D[0].y = prog_vertices[i0].y; rgv3D[0].z = prog_vertices[i0].z;
-         rgv3D[1].x = prog_vertices[i2].x; rgv3D[1].y = prog_vertices[i2].y; rgv3D[1].z = prog_vertices[i2].z;
-         rgv3D[2].x = prog_vertices[i1].x; rgv3D[2].y = prog_vertices[i1].y; rgv3D[2].z = prog_vertices[i1].z;
-         SetupHitObject(pvho, new HitTriangle(rgv3D));
-
-         AddHitEdge(pvho, addedEdges, i0, i1, rgv3D[0], rgv3D[2]);
-         AddHitEdge(pvho, addedEdges, i1, i2, rgv3D[2], rgv3D[1]);
-         AddHitEdge(pvho, addedEdges, i2, i0, rgv3D[1], rgv3D[0]);
-      }
-
-      prog_new_indices.clear();
-
-      // add collision vertices
-      for (size_t i = 0; i < prog_vertices.size(); ++i)
-         SetupHitObject(pvho, new HitPoint(prog_vertices[i].x, prog_vertices[i].y, prog_vertices[i].z));
+         m_hitMesh->AddTriangle(prog_new_indices[i].v[0], prog_new_indices[i].v[2], prog_new_indices[i].v[1]);
    }
 
 //
@@ -574,55 +821,28 @@ void Primitive::GetHitShapes(vector<HitObject*> &pvho)
 
    else
    {
-      robin_hood::unordered_set<robin_hood::pair<unsigned, unsigned>> addedEdges;
+      m_hitMesh = std::make_unique<HitMesh>();
+      m_hitMesh->m_vertices.assign(m_vertices.begin(), m_vertices.begin() + m_mesh.NumVertices());
 
-      // add collision triangles and edges
+      // NB: HitMesh wants CCW vertices, but for rendering we have them in CW order
+      m_hitMesh->m_triangles.reserve(m_mesh.NumIndices() / 3);
       for (size_t i = 0; i < m_mesh.NumIndices(); i += 3)
-      {
-         const unsigned int i0 = m_mesh.m_indices[i];
-         const unsigned int i1 = m_mesh.m_indices[i + 1];
-         const unsigned int i2 = m_mesh.m_indices[i + 2];
-
-         Vertex3Ds rgv3D[3];
-         // NB: HitTriangle wants CCW vertices, but for rendering we have them in CW order
-         rgv3D[0] = m_vertices[i0];
-         rgv3D[1] = m_vertices[i2];
-         rgv3D[2] = m_vertices[i1];
-         SetupHitObject(pvho, new HitTriangle(rgv3D));
-
-         AddHitEdge(pvho, addedEdges, i0, i1, rgv3D[0], rgv3D[2]);
-         AddHitEdge(pvho, addedEdges, i1, i2, rgv3D[2], rgv3D[1]);
-         AddHitEdge(pvho, addedEdges, i2, i0, rgv3D[1], rgv3D[0]);
-      }
-
-      // add collision vertices
-      for (size_t i = 0; i < m_mesh.NumVertices(); ++i)
-         SetupHitObject(pvho, new HitPoint(m_vertices[i]));
+         m_hitMesh->AddTriangle(m_mesh.m_indices[i], m_mesh.m_indices[i + 2], m_mesh.m_indices[i + 1]);
    }
-}
 
-void Primitive::GetHitShapesDebug(vector<HitObject*> &pvho)
-{
+   // add collision triangles (each testing its face and the edges and vertices it owns), then the vertices unused by the triangles
+   m_hitMesh->Build();
+   for (unsigned int i = 0; i < (unsigned int)m_hitMesh->m_triangles.size(); ++i)
+      if (m_hitMesh->m_triangles[i].HasHitFeatures())
+         SetupHitObject(pvho, new HitMeshTriangle(m_hitMesh.get(), i));
+   for (const unsigned int i : m_hitMesh->m_isolatedVertices)
+      SetupHitObject(pvho, new HitPoint(m_hitMesh->m_vertices[i]));
 }
 
-//
-// license:GPLv3+
-// Ported at: VisualPinball.Engine/Math/EdgeSet.cs
-//
-
-void Primitive::AddHitEdge(vector<HitObject*> &pvho, robin_hood::unordered_set< robin_hood::pair<unsigned, unsigned> >& addedEdges, const unsigned i, const unsigned j, const Vertex3Ds &vi, const Vertex3Ds &vj)
+void Primitive::GetHitShapesDebug(vector<HitObject*> &pvho)
 {
-   // create pair uniquely identifying the edge (i,j)
-   const robin_hood::pair<unsigned, unsigned> p(std::min(i, j), std::max(i, j));
-
-   if (addedEdges.insert(p).second) // edge not yet added?
-      SetupHitObject(pvho, new HitLine3D(vi, vj));
 }
 
-//
-// end of license:GPLv3+, back to 'old MAME'-like
-//
-
 void Primitive::SetupHitObject(vector<HitObject*> &pvho, HitObject * obj)
 {
    const Material * const mat = m_ptable->GetMaterial(m_d.m_szPhysicsMaterial);
@@ -664,6 +884,7 @@ void Primitive::EndPlay()
    m_d.m_skipRendering = false;
    m_d.m_groupdRendering = false;
    m_vhoCollidable.clear();
+   m_hitMesh.reset();
    IEditable::EndPlay();
 }
 
@@ -717,16 +938,19 @@ void Primitive::RecalculateMatrices()
 // recalculate vertices for editor display
 void Primitive::TransformVertices()
 {
-   m_vertices.resize(m_mesh.NumVertices());
-   m_normals.resize(m_mesh.NumVertices());
+   const size_t numVertices = m_mesh.NumVertices();
+   m_vertices.resize(numVertices);
+   m_normals.resize(numVertices);
 
-   for (size_t i = 0; i < m_mesh.NumVertices(); i++)
+   // m_fullMatrix is affine, so the batch transform (without w divide) matches MultiplyVector
+   vector<Vertex3D_NoTex2> transformed(numVertices);
+   m_fullMatrix.TransformVertices(m_mesh.m_vertices.data(), transformed.data(), (int)numVertices);
+   NormalizeNormals(transformed.data(), numVertices);
+
+   for (size_t i = 0; i < numVertices; i++)
    {
-      m_fullMatrix.MultiplyVector(m_mesh.m_vertices[i], m_vertices[i]);
-      Vertex3Ds n;
-      m_fullMatrix.MultiplyVectorNoTranslateNormal(m_mesh.m_vertices[i], n);
-      n.Normalize();
-      m_normals[i] = n.z;
+      m_vertices[i] = Vertex3Ds(transformed[i].x, transformed[i].y, transformed[i].z);
+      m_normals[i] = transformed[i].nz;
    }
 }
 
@@ -1187,6 +1411,22 @@ void Primitive::UpdateStatusBarInfo()
 
 }
 
+void Primitive::OptimizeMesh(const bool quantize, MeshCacheStats &before, MeshCacheStats &after)
+{
+   WaitForMeshDecompression(); //!! needed nowadays due to multithreaded mesh decompression
+   before = m_mesh.ComputeCacheStats();
+   const size_t numVertices = m_mesh.NumVertices();
+   m_mesh.Optimize(quantize);
+   after = m_mesh.ComputeCacheStats();
+   delete m_meshBuffer;
+   m_meshBuffer = nullptr;
+   // The editor outline is drawn from the transformed vertices through the (now remapped) indices
+   RecalculateMatrices();
+   TransformVertices();
+   PLOGI << "Optimized mesh of primitive " << MakeString(m_wzName) << ": ACMR " << before.m_acmr << " => " << after.m_acmr << ", ATVR " << before.m_atvr << " => " << after.m_atvr
+         << ", vertices " << numVertices << " => " << m_mesh.NumVertices();
+}
+
 void Primitive::ExportMesh(ObjLoader& loader)
 {
    if (m_d.m_visible)
@@ -1238,6 +1478,8 @@ void Primitive::RenderSetup(RenderDevice *device)
    m_lightmap = m_ptable->GetLight(m_d.m_szLightmap);
 
    m_currentFrame = -1.f;
+   m_blendedFrame = -1.f;
+   m_mesh.m_packedFrames.clear();
    m_d.m_isBackGlassImage = IsBackglass();
 
    delete m_meshBuffer;
@@ -1256,6 +1498,8 @@ void Primitive::RenderRelease()
    assert(m_rd != nullptr);
    delete m_meshBuffer;
    m_meshBuffer = nullptr;
+   m_mesh.m_packedFrames.clear();
+   m_mesh.m_packedFrames.shrink_to_fit();
    m_lightmap = nullptr;
    m_rd = nullptr;
 }
@@ -1324,7 +1568,9 @@ void Primitive::Render(const unsigned int renderMask)
       RecalculateMatrices();
       if (m_vertexBufferRegenerate)
       {
-         m_mesh.UploadToVB(m_meshBuffer->m_vb, m_currentFrame);
+         // the player usually already blended the frame (in parallel for all animated primitives), then only the upload is left
+         m_mesh.UploadToVB(m_meshBuffer->m_vb, m_currentFrame == m_blendedFrame ? -1.f : m_currentFrame);
+         m_blendedFrame = m_currentFrame;
          m_vertexBufferRegenerate = false;
       }
    }
@@ -1968,6 +2214,7 @@ INT_PTR CALLBACK Primitive::ObjImportProc(HWND hwndDlg, UINT uMsg, WPARAM wParam
       CheckDlgButton(hwndDlg, IDC_ABS_POSITION_RADIO, BST_UNCHECKED);
       CheckDlgButton(hwndDlg, IDC_CENTER_MESH, BST_UNCHECKED);
       CheckDlgButton(hwndDlg, IDC_IMPORT_NO_FORSYTH, BST_UNCHECKED);
+      CheckDlgButton(hwndDlg, IDC_IMPORT_QUANTIZE, BST_UNCHECKED);
       EnableWindow(GetDlgItem(hwndDlg, IDOK), FALSE);
       return TRUE;
    }
@@ -2004,7 +2251,8 @@ INT_PTR CALLBACK Primitive::ObjImportProc(HWND hwndDlg, UINT uMsg, WPARAM wParam
             const bool centerMesh = IsDlgButtonChecked(hwndDlg, IDC_CENTER_MESH) == BST_CHECKED;
             const bool importMaterial = IsDlgButtonChecked(hwndDlg, IDC_IMPORT_MATERIAL) == BST_CHECKED;
             const bool importAnimation = IsDlgButtonChecked(hwndDlg, IDC_IMPORT_ANIM_SEQUENCE) == BST_CHECKED;
-            const bool doForsyth = IsDlgButtonChecked(hwndDlg, IDC_IMPORT_NO_FORSYTH) == BST_UNCHECKED;
+            const bool doOptimize = IsDlgButtonChecked(hwndDlg, IDC_IMPORT_NO_FORSYTH) == BST_UNCHECKED;
+            const bool doQuantize = IsDlgButtonChecked(hwndDlg, IDC_IMPORT_QUANTIZE) == BST_CHECKED;
             if (importMaterial)
             {
                string szMatName = szFileName;
@@ -2063,14 +2311,10 @@ INT_PTR CALLBACK Primitive::ObjImportProc(HWND hwndDlg, UINT uMsg, WPARAM wParam
                   }
                }
                prim->m_d.m_use3DMesh = true;
-               if (doForsyth)
+               if (doOptimize)
                {
-                   unsigned int* const tmp = reorderForsyth(prim->m_mesh.m_indices, (int)prim->m_mesh.NumVertices());
-                   if (tmp != nullptr)
-                   {
-                       memcpy(prim->m_mesh.m_indices.data(), tmp, prim->m_mesh.NumIndices() * sizeof(unsigned int));
-                       delete[] tmp;
-                   }
+                   MeshCacheStats before, after;
+                   prim->OptimizeMesh(doQuantize, before, after);
                }
                prim->UpdateStatusBarInfo();
                prim = nullptr;
@@ -2292,6 +2536,33 @@ float Primitive::GetDepth(const Vertex3Ds& viewDir) const
    return m_d.m_depthBias + m_d.m_vPosition.Dot(viewDir);
 }
 
+bool Primitive::GetRenderBounds(Vertex3Ds& boundMin, Vertex3Ds& boundMax)
+{
+   // Render groups merge multiple parts in a single world space mesh and animated meshes move their vertices, so they are never culled
+   if (m_d.m_groupdRendering || m_d.m_skipRendering || !m_mesh.m_animationFrames.empty())
+      return false;
+   m_mesh.UpdateBounds();
+   if (m_mesh.m_minAABound.x == FLT_MAX)
+      return false;
+   RecalculateMatrices();
+   boundMin = Vertex3Ds(FLT_MAX, FLT_MAX, FLT_MAX);
+   boundMax = Vertex3Ds(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+   for (int i = 0; i < 8; i++)
+   {
+      const Vertex3Ds p = m_fullMatrix.MultiplyVector(Vertex3Ds(
+         (i & 1) ? m_mesh.m_minAABound.x : m_mesh.m_maxAABound.x,
+         (i & 2) ? m_mesh.m_minAABound.y : m_mesh.m_maxAABound.y,
+         (i & 4) ? m_mesh.m_minAABound.z : m_mesh.m_maxAABound.z));
+      boundMin.x = min(boundMin.x, p.x);
+      boundMin.y = min(boundMin.y, p.y);
+      boundMin.z = min(boundMin.z, p.z);
+      boundMax.x = max(boundMax.x, p.x);
+      boundMax.y = max(boundMax.y, p.y);
+      boundMax.z = max(boundMax.z, p.z);
+   }
+   return true;
+}
+
 STDMETHODIMP Primitive::get_Sides(int *pVal)
 {
    *pVal = m_d.m_Sides;
@@ -8,6 +8,13 @@
 #include "resource.h"
 #include "robin_hood.h"
 
+// Vertex processing efficiency of a mesh, measured with a simulated FIFO post transform vertex cache
+struct MeshCacheStats
+{
+   float m_acmr = 0.f; // average cache miss ratio: transformed vertices per triangle (3 is the worst case, ~0.5 the best for regular grids)
+   float m_atvr = 0.f; // average transformed vertex ratio: transformed vertices per vertex (1 is the best case)
+};
+
 class Mesh final
 {
 public:
@@ -23,6 +30,7 @@ public:
    };
 
    vector<FrameData> m_animationFrames;
+   vector<float> m_packedFrames; // animation frames repacked for blending (per group of 4 vertices: 4 x, 4 y, 4 z, 4 nx, 4 ny, 4 nz), built on first use
    vector<Vertex3D_NoTex2> m_vertices;
    vector<unsigned int> m_indices;
    Vertex3Ds m_minAABound, m_maxAABound;
@@ -37,7 +45,16 @@ public:
    size_t NumVertices() const    { return m_vertices.size(); }
    size_t NumIndices() const     { return m_indices.size(); }
    void UploadToVB(VertexBuffer * vb, const float frame);
+   void BlendAnimationFrames(const float frame); // blend frame positions and normals into m_vertices, can run concurrently for different meshes
    void UpdateBounds();
+
+   // Reorder triangles for the vertex cache (Forsyth) then for less overdraw, and vertices in fetch order (dropping unused ones).
+   // Optionally quantize normals and texture coordinates to 16 bits (this does not change the vertex format, but the stored data compresses much better).
+   void Optimize(const bool quantize);
+   MeshCacheStats ComputeCacheStats() const;
+
+private:
+   void OptimizeOverdraw();
 };
 
 // Indices for RotAndTra:
@@ -306,12 +323,19 @@ private:
 
 public:
    float GetDepth(const Vertex3Ds &viewDir) const final;
+   bool GetRenderBounds(Vertex3Ds &boundMin, Vertex3Ds &boundMax) final;
    ItemTypeEnum HitableGetItemType() const final { return eItemPrimitive; }
 
    void SetDefaultPhysics(const bool fromMouseClick) final;
    void ExportMesh(ObjLoader &loader) final;
    void RenderBlueprint(Sur *psur, const bool solid) final;
    void UpdateStatusBarInfo() final;
+   void OptimizeMesh(const bool quantize, MeshCacheStats &before, MeshCacheStats &after);
+
+   // animation frame blending, done by the player for all animated primitives concurrently before rendering
+   bool HasAnimation() const { return !m_mesh.m_animationFrames.empty(); }
+   bool NeedsAnimationBlend() const { return m_meshBuffer != nullptr && m_vertexBufferRegenerate && m_currentFrame >= 0.f && m_currentFrame != m_blendedFrame && m_d.m_visible && !m_d.m_skipRendering && !m_d.m_groupdRendering; }
+   void BlendAnimation() { m_mesh.BlendAnimationFrames(m_currentFrame); m_blendedFrame = m_currentFrame; }
 
    void CreateRenderGroup(const Collection * const collection);
    void RecalculateMatrices();
@@ -339,6 +363,7 @@ private:
    int m_numGroupVertices;
    int m_numGroupIndices;
    float m_currentFrame;
+   float m_blendedFrame = -1.f; // frame currently blended into m_mesh.m_vertices
    float m_speed;
    bool m_doAnimation;
    bool m_endless;
@@ -353,7 +378,6 @@ private:
 
    bool BrowseFor3DMeshFile();
    void SetupHitObject(vector<HitObject*> &pvho, HitObject * obj);
-   void AddHitEdge(vector<HitObject*> &pvho, robin_hood::unordered_set< robin_hood::pair<unsigned, unsigned> >& addedEdges, const unsigned i, const unsigned j, const Vertex3Ds &vi, const Vertex3Ds &vj);
 
    void CalculateBuiltinOriginal();
    void WaitForMeshDecompression();
@@ -363,6 +387,7 @@ private:
    PropertyPane *m_propPhysics;
 
    vector<HitObject*> m_vhoCollidable; // Objects to that may be collide selectable
+   std::unique_ptr<HitMesh> m_hitMesh; // Collision mesh shared by the hit objects of the primitive while playing
 
    //!! outdated(?) information (along with the variable decls) for the old builtin primitive code, kept for reference:
 
@@ -1004,6 +1004,16 @@ float Ramp::GetDepth(const Vertex3Ds& viewDir) const
    return m_d.m_depthBias + viewDir.x * center2D.x + viewDir.y * center2D.y + viewDir.z * centerZ;
 }
 
+bool Ramp::GetRenderBounds(Vertex3Ds& boundMin, Vertex3Ds& boundMax)
+{
+   // Wire ramps are not culled since their wires are offset from the generated mesh, and bounds are only known once the vertex buffer has been generated
+   if (isHabitrail() || m_meshBuffer == nullptr || m_dynamicVertexBufferRegenerate)
+      return false;
+   boundMin = m_renderBoundMin;
+   boundMax = m_renderBoundMax;
+   return true;
+}
+
 void Ramp::UpdateBounds()
 {
    const Vertex2D center2D = GetPointCenter();
@@ -2405,6 +2415,18 @@ void Ramp::GenerateVertexBuffer()
    Vertex3D_NoTex2 *tmpBuffer = nullptr;
    GenerateRampMesh(&tmpBuffer);
 
+   m_renderBoundMin = Vertex3Ds(FLT_MAX, FLT_MAX, FLT_MAX);
+   m_renderBoundMax = Vertex3Ds(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+   for (int i = 0; i < m_numVertices * 3; i++)
+   {
+      m_renderBoundMin.x = min(m_renderBoundMin.x, tmpBuffer[i].x);
+      m_renderBoundMin.y = min(m_renderBoundMin.y, tmpBuffer[i].y);
+      m_renderBoundMin.z = min(m_renderBoundMin.z, tmpBuffer[i].z);
+      m_renderBoundMax.x = max(m_renderBoundMax.x, tmpBuffer[i].x);
+      m_renderBoundMax.y = max(m_renderBoundMax.y, tmpBuffer[i].y);
+      m_renderBoundMax.z = max(m_renderBoundMax.z, tmpBuffer[i].z);
+   }
+
    delete m_meshBuffer;
    VertexBuffer* dynamicVertexBuffer = new VertexBuffer(m_rd, m_numVertices * 3, (float*) tmpBuffer); //!! use USAGE_DYNAMIC if it would actually be "really" dynamic
    IndexBuffer* dynamicIndexBuffer = new IndexBuffer(m_rd, m_meshIndices);
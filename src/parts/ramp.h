@@ -102,6 +102,7 @@ public:
    void GetBoundingVertices(vector<Vertex3Ds> &pvvertex3D, const bool isLegacy) final;
 
    float GetDepth(const Vertex3Ds &viewDir) const final;
+   bool GetRenderBounds(Vertex3Ds &boundMin, Vertex3Ds &boundMax) final;
    ItemTypeEnum HitableGetItemType() const final { return eItemRamp; }
    void SetDefaultPhysics(const bool fromMouseClick) final;
    void ExportMesh(ObjLoader &loader) final;
@@ -183,6 +184,7 @@ private:
    void GenerateRampMesh(Vertex3D_NoTex2 **meshBuf);
 
    Vertex3Ds m_boundingSphereCenter;
+   Vertex3Ds m_renderBoundMin, m_renderBoundMax; // World space bounds of the flat ramp vertex buffer content
    void UpdateBounds();
 
    // IRamp
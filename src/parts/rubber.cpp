@@ -539,54 +539,32 @@ void Rubber::GetTimers(vector<HitTimer*> &pvht)
 
 void Rubber::GetHitShapes(vector<HitObject*> &pvho)
 {
-   robin_hood::unordered_set<robin_hood::pair<unsigned, unsigned>> addedEdges;
-
    GenerateMesh(6, true); //!! adapt hacky code in the function if changing the "6" here
    UpdateRubber(false, m_d.m_hitHeight);
 
-   // add collision triangles and edges
+   m_hitMesh = std::make_unique<HitMesh>();
+   m_hitMesh->m_vertices.resize(m_vertices.size());
+   for (size_t i = 0; i < m_vertices.size(); ++i)
+      m_hitMesh->m_vertices[i] = Vertex3Ds(m_vertices[i].x, m_vertices[i].y, m_vertices[i].z);
+
+   // NB: HitMesh wants CCW vertices, but for rendering we have them in CW order
+   m_hitMesh->m_triangles.reserve(m_ringIndices.size() / 3);
    for (size_t i = 0; i < m_ringIndices.size(); i += 3)
-   {
-      Vertex3Ds rgv3D[3];
-      // NB: HitTriangle wants CCW vertices, but for rendering we have them in CW order
-      const Vertex3D_NoTex2 *v = &m_vertices[m_ringIndices[i]];
-      rgv3D[0] = Vertex3Ds(v->x, v->y, v->z);
-      v = &m_vertices[m_ringIndices[i + 2]];
-      rgv3D[1] = Vertex3Ds(v->x, v->y, v->z);
-      v = &m_vertices[m_ringIndices[i + 1]];
-      rgv3D[2] = Vertex3Ds(v->x, v->y, v->z);
-      SetupHitObject(pvho, new HitTriangle(rgv3D));
-
-      AddHitEdge(pvho, addedEdges, m_ringIndices[i    ], m_ringIndices[i + 2]);
-      AddHitEdge(pvho, addedEdges, m_ringIndices[i + 2], m_ringIndices[i + 1]);
-      AddHitEdge(pvho, addedEdges, m_ringIndices[i + 1], m_ringIndices[i]);
-   }
+      m_hitMesh->AddTriangle(m_ringIndices[i], m_ringIndices[i + 2], m_ringIndices[i + 1]);
 
-   // add collision vertices
-   for (size_t i = 0; i < m_vertices.size(); ++i)
-   {
-      Vertex3Ds v = Vertex3Ds(m_vertices[i].x, m_vertices[i].y, m_vertices[i].z);
-      SetupHitObject(pvho, new HitPoint(v));
-   }
+   // add collision triangles (each testing its face and the edges and vertices it owns), then the vertices unused by the triangles
+   m_hitMesh->Build();
+   for (unsigned int i = 0; i < (unsigned int)m_hitMesh->m_triangles.size(); ++i)
+      if (m_hitMesh->m_triangles[i].HasHitFeatures())
+         SetupHitObject(pvho, new HitMeshTriangle(m_hitMesh.get(), i));
+   for (const unsigned int i : m_hitMesh->m_isolatedVertices)
+      SetupHitObject(pvho, new HitPoint(m_hitMesh->m_vertices[i]));
 }
 
 //
 // end of license:GPLv3+, back to 'old MAME'-like
 //
 
-void Rubber::AddHitEdge(vector<HitObject*> &pvho, robin_hood::unordered_set< robin_hood::pair<unsigned, unsigned> >& addedEdges, const unsigned i, const unsigned j)
-{
-   // create pair uniquely identifying the edge (i,j)
-   const robin_hood::pair<unsigned, unsigned> p(std::min(i, j), std::max(i, j));
-
-   if (addedEdges.insert(p).second) // edge not yet added?
-   {
-      const Vertex3Ds v1(m_vertices[i].x, m_vertices[i].y, m_vertices[i].z);
-      const Vertex3Ds v2(m_vertices[j].x, m_vertices[j].y, m_vertices[j].z);
-      SetupHitObject(pvho, new HitLine3D(v1, v2));
-   }
-}
-
 void Rubber::SetupHitObject(vector<HitObject*> &pvho, HitObject * obj)
 {
    const Material *const mat = m_ptable->GetMaterial(m_d.m_szPhysicsMaterial);
@@ -606,7 +584,7 @@ void Rubber::SetupHitObject(vector<HitObject*> &pvho, HitObject * obj)
    }
 
    obj->m_enabled = m_d.m_collidable;
-   // the rubber is of type ePrimitive for triggering the event in HitTriangle::Collide()
+   // the rubber is of type ePrimitive for triggering the event in HitMeshTriangle::Collide()
    obj->m_ObjType = ePrimitive;
    // hard coded threshold for now
    obj->m_threshold = 2.0f;
@@ -671,6 +649,7 @@ void Rubber::EndPlay()
 {
    IEditable::EndPlay();
    m_vhoCollidable.clear();
+   m_hitMesh.reset();
 }
 
 #pragma endregion
@@ -684,6 +663,16 @@ float Rubber::GetDepth(const Vertex3Ds& viewDir) const
    return viewDir.x * center2D.x + viewDir.y * center2D.y + viewDir.z * m_d.m_height;
 }
 
+bool Rubber::GetRenderBounds(Vertex3Ds& boundMin, Vertex3Ds& boundMax)
+{
+   // Bounds are only known once the vertex buffer has been updated
+   if (m_meshBuffer == nullptr || (m_dynamicVertexBufferRegenerate && !m_d.m_staticRendering))
+      return false;
+   boundMin = m_renderBoundMin;
+   boundMax = m_renderBoundMax;
+   return true;
+}
+
 void Rubber::UpdateBounds()
 {
    const Vertex2D center2D = GetPointCenter();
@@ -1460,6 +1449,8 @@ void Rubber::UpdateRubber(const bool updateVB, const float height)
    else
       buf = m_vertices.data();
 
+   m_renderBoundMin = Vertex3Ds(FLT_MAX, FLT_MAX, FLT_MAX);
+   m_renderBoundMax = Vertex3Ds(-FLT_MAX, -FLT_MAX, -FLT_MAX);
    for (int i = 0; i < m_numVertices; i++)
    {
       Vertex3Ds vert(m_vertices[i].x, m_vertices[i].y, m_vertices[i].z);
@@ -1467,6 +1458,12 @@ void Rubber::UpdateRubber(const bool updateVB, const float height)
       buf[i].x = vert.x;
       buf[i].y = vert.y;
       buf[i].z = vert.z;
+      m_renderBoundMin.x = min(m_renderBoundMin.x, vert.x);
+      m_renderBoundMin.y = min(m_renderBoundMin.y, vert.y);
+      m_renderBoundMin.z = min(m_renderBoundMin.z, vert.z);
+      m_renderBoundMax.x = max(m_renderBoundMax.x, vert.x);
+      m_renderBoundMax.y = max(m_renderBoundMax.y, vert.y);
+      m_renderBoundMax.z = max(m_renderBoundMax.z, vert.z);
 
       vert = Vertex3Ds(m_vertices[i].nx, m_vertices[i].ny, m_vertices[i].nz);
       vert = fullMatrix.MultiplyVectorNoTranslate(vert);
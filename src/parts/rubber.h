@@ -94,6 +94,7 @@ public:
    void GetBoundingVertices(vector<Vertex3Ds> &pvvertex3D, const bool isLegacy) /*const*/ final;
 
    float GetDepth(const Vertex3Ds& viewDir) const final;
+   bool GetRenderBounds(Vertex3Ds& boundMin, Vertex3Ds& boundMax) final;
    ItemTypeEnum HitableGetItemType() const final { return eItemRubber; }
    void SetDefaultPhysics(const bool fromMouseClick) final;
    void ExportMesh(ObjLoader& loader) final;
@@ -109,7 +110,6 @@ public:
    RubberData m_d;
 
 private:
-   void AddHitEdge(vector<HitObject*> &pvho, robin_hood::unordered_set< robin_hood::pair<unsigned, unsigned> >& addedEdges, const unsigned i, const unsigned j);
    void SetupHitObject(vector<HitObject*> &pvho, HitObject * obj);
 
    PinTable *m_ptable;
@@ -124,6 +124,7 @@ private:
    int m_numIndices;
 
    vector<HitObject*> m_vhoCollidable; // Objects to that may be collide selectable
+   std::unique_ptr<HitMesh> m_hitMesh; // Collision mesh shared by the hit objects of the rubber while playing
    vector<Vertex3D_NoTex2> m_vertices;
    vector<WORD> m_ringIndices;
 
@@ -141,6 +142,7 @@ private:
    void DrawRubberMesh(Sur * const psur);
 
    Vertex3Ds m_boundingSphereCenter;
+   Vertex3Ds m_renderBoundMin, m_renderBoundMax; // World space bounds of the vertex buffer content
    void UpdateBounds();
 
    // IRamp
@@ -0,0 +1,365 @@
+#include "stdafx.h"
+#include "bvh.h"
+
+static constexpr float SAH_TRAVERSAL_COST = 1.0f; // cost of testing the 4 child boxes of a node, relative to testing a leaf block
+static constexpr int SAH_BINS = 16;
+
+static inline float SurfaceArea(const FRect3D& r)
+{
+   const float dx = r.right - r.left, dy = r.bottom - r.top, dz = r.zhigh - r.zlow;
+   return dx * dy + dy * dz + dz * dx;
+}
+
+static inline unsigned int BlockCount(const unsigned int count)
+{
+   return (count + 3) / 4;
+}
+
+static inline float AxisValue(const Vertex3Ds& v, const int axis)
+{
+   return axis == 0 ? v.x : axis == 1 ? v.y : v.z;
+}
+
+static void SetInvalidBox(float (&bounds)[6][4], const unsigned int slot)
+{
+   bounds[0][slot] =  FLT_MAX;
+   bounds[1][slot] = -FLT_MAX;
+   bounds[2][slot] =  FLT_MAX;
+   bounds[3][slot] = -FLT_MAX;
+   bounds[4][slot] =  FLT_MAX;
+   bounds[5][slot] = -FLT_MAX;
+}
+
+static void SetBox(float (&bounds)[6][4], const unsigned int slot, const FRect3D& r)
+{
+   bounds[0][slot] = r.left;
+   bounds[1][slot] = r.right;
+   bounds[2][slot] = r.top;
+   bounds[3][slot] = r.bottom;
+   bounds[4][slot] = r.zlow;
+   bounds[5][slot] = r.zhigh;
+}
+
+void HitBVH::Initialize()
+{
+   m_nodes.clear();
+   m_blocks.clear();
+   m_depth = 0;
+
+#ifdef DEBUGPHYSICS
+   g_pplayer->c_bvhObjects = (U32)m_vho.size();
+#endif
+
+   if (m_vho.empty())
+      return;
+
+   vector<BuildItem> items(m_vho.size());
+   for (size_t i = 0; i < m_vho.size(); ++i)
+   {
+      const FRect3D& r = m_vho[i]->m_hitBBox;
+      items[i].m_bounds = r;
+      items[i].m_center = Vertex3Ds((r.left + r.right) * 0.5f, (r.top + r.bottom) * 0.5f, (r.zlow + r.zhigh) * 0.5f);
+      items[i].m_pho = m_vho[i];
+   }
+
+   m_nodes.reserve(m_vho.size() / 8 + 1);
+   m_blocks.reserve(m_vho.size() / 2 + 1);
+   BuildNode(items.data(), (unsigned int)items.size(), 0);
+
+#ifdef DEBUGPHYSICS
+   g_pplayer->c_bvhNodes = (U32)m_nodes.size();
+#endif
+}
+
+// Partition the items in 2 sets using the binned surface area heuristic, returns the size of the first set and the (relative) cost of the split
+unsigned int HitBVH::SplitSAH(BuildItem* const items, const unsigned int count, float& cost)
+{
+   FRect3D bounds, centers;
+   bounds.Clear();
+   centers.Clear();
+   for (unsigned int i = 0; i < count; ++i)
+   {
+      const Vertex3Ds& c = items[i].m_center;
+      bounds.Extend(items[i].m_bounds);
+      centers.Extend(FRect3D(c.x, c.x, c.y, c.y, c.z, c.z));
+   }
+   const float cmin[3] = { centers.left, centers.top, centers.zlow };
+   const float cext[3] = { centers.right - centers.left, centers.bottom - centers.top, centers.zhigh - centers.zlow };
+
+   float bestCost = FLT_MAX;
+   int bestAxis = -1, bestBin = 0;
+   for (int axis = 0; axis < 3; ++axis)
+   {
+      if (cext[axis] <= 0.f)
+         continue;
+      const float scale = (float)SAH_BINS / cext[axis];
+
+      unsigned int binCount[SAH_BINS] = {};
+      FRect3D binBounds[SAH_BINS];
+      for (int b = 0; b < SAH_BINS; ++b)
+         binBounds[b].Clear();
+      for (unsigned int i = 0; i < count; ++i)
+      {
+         const int b = min(SAH_BINS - 1, (int)((AxisValue(items[i].m_center, axis) - cmin[axis]) * scale));
+         binCount[b]++;
+         binBounds[b].Extend(items[i].m_bounds);
+      }
+
+      // sweep from the right to get the area and count of all the possible right sets, then from the left to evaluate the splits
+      float rightArea[SAH_BINS];
+      unsigned int rightCount[SAH_BINS];
+      FRect3D acc;
+      acc.Clear();
+      unsigned int n = 0;
+      for (int b = SAH_BINS - 1; b > 0; --b)
+      {
+         acc.Extend(binBounds[b]);
+         n += binCount[b];
+         rightArea[b] = (n != 0) ? SurfaceArea(acc) : 0.f;
+         rightCount[b] = n;
+      }
+      acc.Clear();
+      n = 0;
+      for (int b = 0; b < SAH_BINS - 1; ++b)
+      {
+         acc.Extend(binBounds[b]);
+         n += binCount[b];
+         if (n == 0 || rightCount[b + 1] == 0)
+            continue;
+         const float c = SurfaceArea(acc) * (float)BlockCount(n) + rightArea[b + 1] * (float)BlockCount(rightCount[b + 1]);
+         if (c < bestCost)
+         {
+            bestCost = c;
+            bestAxis = axis;
+            bestBin = b;
+         }
+      }
+   }
+
+   if (bestAxis < 0) // all centers at the same place, just cut in the middle
+   {
+      cost = 0.f;
+      return count / 2;
+   }
+
+   const float scale = (float)SAH_BINS / cext[bestAxis];
+   const BuildItem* const mid = std::partition(items, items + count, [&](const BuildItem& item)
+      { return min(SAH_BINS - 1, (int)((AxisValue(item.m_center, bestAxis) - cmin[bestAxis]) * scale)) <= bestBin; });
+
+   const float area = SurfaceArea(bounds);
+   cost = (area > 0.f) ? SAH_TRAVERSAL_COST + bestCost / area : 0.f;
+   return (unsigned int)(mid - items);
+}
+
+unsigned int HitBVH::BuildNode(BuildItem* const items, const unsigned int count, const unsigned int depth)
+{
+   m_depth = max(m_depth, depth);
+
+   const unsigned int index = (unsigned int)m_nodes.size();
+   m_nodes.emplace_back();
+   for (unsigned int i = 0; i < 4; ++i)
+   {
+      SetInvalidBox(m_nodes[index].m_bounds, i);
+      m_nodes[index].m_child[i] = 0;
+      m_nodes[index].m_blocks[i] = 0;
+      m_nodes[index].m_unique[i] = nullptr;
+      m_nodes[index].m_uniqueType[i] = eNull;
+   }
+
+   // split in 2, then each half again in 2 (if not small enough for a leaf) to get the (up to) 4 children
+   BuildItem* groupItems[4] = { items };
+   unsigned int groupCount[4] = { count };
+   unsigned int nGroups = 1;
+   float cost;
+   if (count > LEAF_BLOCK_SIZE)
+   {
+      const unsigned int split = SplitSAH(items, count, cost);
+      groupItems[0] = items;
+      groupCount[0] = split;
+      groupItems[1] = items + split;
+      groupCount[1] = count - split;
+      nGroups = 2;
+      for (unsigned int g = 0; g < 2; ++g)
+         if (groupCount[g] > LEAF_BLOCK_SIZE)
+         {
+            const unsigned int split2 = SplitSAH(groupItems[g], groupCount[g], cost);
+            groupItems[nGroups] = groupItems[g] + split2;
+            groupCount[nGroups] = groupCount[g] - split2;
+            groupCount[g] = split2;
+            nGroups++;
+         }
+   }
+
+   for (unsigned int g = 0; g < nGroups; ++g)
+      BuildChild(index, g, groupItems[g], groupCount[g], depth + 1);
+
+   return index;
+}
+
+void HitBVH::BuildChild(const unsigned int nodeIndex, const unsigned int slot, BuildItem* const items, const unsigned int count, const unsigned int depth)
+{
+   FRect3D bounds;
+   bounds.Clear();
+   IFireEvents* unique = (items[0].m_pho->m_e != 0) ? items[0].m_pho->m_obj : nullptr;
+   for (unsigned int i = 0; i < count; ++i)
+   {
+      const HitObject * const pho = items[i].m_pho;
+      bounds.Extend(items[i].m_bounds);
+      if (((pho->m_e != 0) ? pho->m_obj : nullptr) != unique) // do all objects belong to the same primitive/hittarget?
+         unique = nullptr;
+   }
+
+   bool leaf = count <= LEAF_BLOCK_SIZE || depth >= MAX_DEPTH;
+   if (!leaf && count <= LEAF_BLOCK_SIZE * MAX_LEAF_BLOCKS)
+   {
+      float cost;
+      SplitSAH(items, count, cost);
+      leaf = (float)BlockCount(count) <= cost;
+   }
+
+   unsigned int child, blocks;
+   if (leaf)
+   {
+      child = BuildLeaf(items, count);
+      blocks = BlockCount(count);
+   }
+   else
+   {
+      child = BuildNode(items, count, depth);
+      blocks = 0;
+   }
+
+   // NB: m_nodes may have been reallocated by BuildNode
+   Node& node = m_nodes[nodeIndex];
+   SetBox(node.m_bounds, slot, bounds);
+   node.m_child[slot] = child;
+   node.m_blocks[slot] = blocks;
+   node.m_unique[slot] = unique;
+   node.m_uniqueType[slot] = (unique != nullptr) ? items[0].m_pho->m_ObjType : eNull;
+}
+
+unsigned int HitBVH::BuildLeaf(BuildItem* const items, const unsigned int count)
+{
+   const unsigned int first = (unsigned int)m_blocks.size();
+   for (unsigned int i = 0; i < count; i += LEAF_BLOCK_SIZE)
+   {
+      LeafBlock block;
+      for (unsigned int j = 0; j < LEAF_BLOCK_SIZE; ++j)
+      {
+         if (i + j < count)
+         {
+            SetBox(block.m_bounds, j, items[i + j].m_bounds);
+            block.m_vho[j] = items[i + j].m_pho;
+         }
+         else
+         {
+            SetInvalidBox(block.m_bounds, j);
+            block.m_vho[j] = nullptr;
+         }
+      }
+      m_blocks.push_back(block);
+   }
+   return first;
+}
+
+// Ball bounding box and extended hit sphere, to be tested against 4 boxes at once
+// returns the bit mask of the boxes intersecting the swept ball
+static int TestBounds(const BallSweep& sweep, const float (&bounds)[6][4])
+{
+#ifdef ENABLE_SSE_OPTIMIZATIONS
+   const __m128* const __restrict p = (const __m128*)bounds;
+   return sweep.Intersect4(p[0], p[1], p[2], p[3], p[4], p[5]);
+#else
+   int mask = 0;
+   for (int i = 0; i < 4; ++i)
+      if (sweep.Intersect(FRect3D(bounds[0][i], bounds[1][i], bounds[2][i], bounds[3][i], bounds[4][i], bounds[5][i])))
+         mask |= 1 << i;
+   return mask;
+#endif
+}
+
+template <bool XRay>
+void HitBVH::HitTest(const Ball * const pball, vector<HitObject*> *pvhoHit, CollisionEvent& coll) const
+{
+   if (m_nodes.empty())
+      return;
+
+   const BallSweep sweep(pball, coll.m_hittime);
+
+   struct StackEntry
+   {
+      unsigned int m_index;
+      unsigned int m_blocks; // 0 for a node, number of leaf blocks for a leaf
+   };
+   StackEntry stack[MAX_DEPTH * 3 + 2]; // each node replaces itself by at most 4 children
+   unsigned int stackpos = 0;
+   stack[stackpos++] = { 0, 0 };
+
+   const bool traversal_order = XRay || (rand_mt_01() < 0.5f); // swaps test order randomly
+
+   while (stackpos > 0)
+   {
+      const StackEntry entry = stack[--stackpos];
+      if (entry.m_blocks == 0)
+      {
+#ifdef DEBUGPHYSICS
+         g_pplayer->c_traversed++;
+#endif
+         const Node& node = m_nodes[entry.m_index];
+         const int mask = TestBounds(sweep, node.m_bounds);
+         for (int j = 0; j < 4; ++j)
+         {
+            const int i = traversal_order ? j : 3 - j;
+            if ((mask & (1 << i)) == 0)
+               continue;
+            // early out if only one unique primitive/hittarget stored inside all of the subtree that is also not collidable (at the moment)
+            const IFireEvents * const unique = node.m_unique[i];
+            if (XRay || unique == nullptr
+                || (node.m_uniqueType[i] == ePrimitive && ((const Primitive*)unique)->m_d.m_collidable)
+                || (node.m_uniqueType[i] == eHitTarget && ((const HitTarget*)unique)->m_d.m_isDropped == false))
+               stack[stackpos++] = { node.m_child[i], node.m_blocks[i] };
+         }
+      }
+      else
+      {
+         for (unsigned int b = 0; b < entry.m_blocks; ++b)
+         {
+#ifdef DEBUGPHYSICS
+            g_pplayer->c_tested++;
+#endif
+            const LeafBlock& block = m_blocks[entry.m_index + b];
+            const int mask = TestBounds(sweep, block.m_bounds);
+            if (mask == 0)
+               continue;
+            for (int j = 0; j < 4; ++j)
+            {
+               const int i = traversal_order ? j : 3 - j;
+               HitObject * const pho = block.m_vho[i];
+               if ((mask & (1 << i)) == 0 || pho == pball) // ball can not hit itself
+                  continue;
+               if (XRay)
+               {
+#ifdef DEBUGPHYSICS
+                  g_pplayer->c_deepTested++;
+#endif
+                  const float newtime = pho->HitTest(pball->m_d, coll.m_hittime, coll);
+                  if (newtime >= 0.f)
+                     pvhoHit->push_back(pho);
+               }
+               else
+                  DoHitTest(pball, pho, coll);
+            }
+         }
+      }
+   }
+}
+
+void HitBVH::HitTestBall(const Ball * const pball, CollisionEvent& coll) const
+{
+   HitTest<false>(pball, nullptr, coll);
+}
+
+void HitBVH::HitTestXRay(const Ball * const pball, vector<HitObject*> &pvhoHit, CollisionEvent& coll) const
+{
+   HitTest<true>(pball, &pvhoHit, coll);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "collide.h"
+
+// 4-wide bounding volume hierarchy for the static hit objects, alternative to HitQuadtree and HitKD (selected in the settings)
+//
+// The hierarchy is built once with the surface area heuristic (SAH, binned on the bounding box centers), so contrary to the
+// quadtree it also subdivides along z (e.g. for tables with ramps/wire ramps above detailed playfield meshes). Each node stores
+// the bounds of its 4 children in SIMD friendly layout, and leaves are made of blocks of 4 hit objects also tested at once.
+class HitBVH final
+{
+public:
+   HitBVH() {}
+   ~HitBVH() {}
+
+   void AddElement(HitObject *pho) { m_vho.push_back(pho); }
+   void Initialize(); // build the hierarchy from the added elements
+
+   void HitTestBall(const Ball * const pball, CollisionEvent& coll) const;
+   void HitTestXRay(const Ball * const pball, vector<HitObject*> &pvhoHit, CollisionEvent& coll) const;
+
+   size_t GetNodeCount() const { return m_nodes.size(); }
+   unsigned int GetDepth() const { return m_depth; }
+
+private:
+   static constexpr unsigned int LEAF_BLOCK_SIZE = 4; // hit objects per leaf block
+   static constexpr unsigned int MAX_LEAF_BLOCKS = 4; // leaves are made of at most 4 blocks (except when too deep)
+   static constexpr unsigned int MAX_DEPTH = 64; // each level pushes at most 3 more nodes on the traversal stack (sized accordingly)
+
+   struct alignas(16) Node
+   {
+      float m_bounds[6][4]; // 4xleft, 4xright, 4xtop, 4xbottom, 4xzlow, 4xzhigh of the children, empty slots have an 'invalid' box
+      unsigned int m_child[4]; // index of the child node, or of the first leaf block if m_blocks != 0
+      unsigned int m_blocks[4]; // number of leaf blocks if the child is a leaf, 0 for inner nodes
+      IFireEvents* m_unique[4]; // if not nullptr, everything below the child belongs to this primitive/hittarget (for early outs if not collidable)
+      eObjType m_uniqueType[4];
+   };
+
+   struct alignas(16) LeafBlock
+   {
+      float m_bounds[6][4]; // same layout as Node::m_bounds, for the hit objects of the block
+      HitObject* m_vho[LEAF_BLOCK_SIZE]; // nullptr for padding entries
+   };
+
+   struct BuildItem
+   {
+      FRect3D m_bounds;
+      Vertex3Ds m_center;
+      HitObject* m_pho;
+   };
+
+   unsigned int BuildNode(BuildItem* const items, const unsigned int count, const unsigned int depth);
+   void BuildChild(const unsigned int nodeIndex, const unsigned int slot, BuildItem* const items, const unsigned int count, const unsigned int depth);
+   unsigned int BuildLeaf(BuildItem* const items, const unsigned int count);
+   static unsigned int SplitSAH(BuildItem* const items, const unsigned int count, float& cost);
+
+   template <bool XRay> void HitTest(const Ball * const pball, vector<HitObject*> *pvhoHit, CollisionEvent& coll) const;
+
+   vector<HitObject*> m_vho;
+   vector<Node> m_nodes; // m_nodes[0] is the root, which only uses its first slot if the tree is made of a single leaf
+   vector<LeafBlock> m_blocks;
+   unsigned int m_depth = 0;
+};
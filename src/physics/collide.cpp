@@ -9,6 +9,26 @@ static std::mutex mtx;
 float c_hardScatter = 0.0f;
 
 
+// Each allocation is prefixed by a header telling if it comes from an arena (released as a whole) or from the heap
+static constexpr size_t hitObjectHeaderSize = alignof(std::max_align_t);
+
+void* HitObject::operator new(const size_t size)
+{
+   PhysicsArena* const arena = PhysicsArena::GetCurrent();
+   BYTE* const p = static_cast<BYTE*>(arena ? arena->Allocate(size + hitObjectHeaderSize) : ::operator new(size + hitObjectHeaderSize));
+   *p = arena ? 1 : 0;
+   return p + hitObjectHeaderSize;
+}
+
+void HitObject::operator delete(void* const p)
+{
+   if (p == nullptr)
+      return;
+   BYTE* const header = static_cast<BYTE*>(p) - hitObjectHeaderSize;
+   if (*header == 0)
+      ::operator delete(header);
+}
+
 void HitObject::Contact(CollisionEvent& coll, const float dtime) { coll.m_ball->HandleStaticContact(coll, m_friction, dtime); }
 
 void HitObject::FireHitEvent(Ball * const pball)
@@ -446,7 +466,12 @@ float HitPoint::HitTest(const BallS &ball, const float dtime, CollisionEvent& co
    if (!m_enabled)
       return -1.0f;
 
-   const Vertex3Ds dist = ball.m_pos - m_p;   // relative ball position
+   return HitTestPoint(m_p, ball, dtime, coll);
+}
+
+float HitPoint::HitTestPoint(const Vertex3Ds& p, const BallS &ball, const float dtime, CollisionEvent& coll)
+{
+   const Vertex3Ds dist = ball.m_pos - p;     // relative ball position
 
    const float bcddsq = dist.LengthSquared(); // ball center to line distance squared
    const float bcdd = sqrtf(bcddsq);          // distance ball to line
@@ -496,7 +521,7 @@ float HitPoint::HitTest(const BallS &ball, const float dtime, CollisionEvent& co
       return -1.0f; // contact out of physics frame
 
    const Vertex3Ds hitPos = ball.m_pos + hittime * ball.m_vel;
-   coll.m_hitnormal = hitPos - m_p;
+   coll.m_hitnormal = hitPos - p;
    coll.m_hitnormal.Normalize();
 
    coll.m_isContact = isContact;
@@ -537,8 +562,20 @@ void DoHitTest(const Ball *const pball, const HitObject *const pho, CollisionEve
    g_pplayer->c_deepTested++; //!! atomic needed if USE_EMBREE
 #endif
 
+   // face, edges and vertices of mesh triangles are separate hits (mesh triangles are only used by primitives and rubbers, so skip the type query for other objects)
+   if (pho->m_ObjType == ePrimitive && pho->GetType() == eMeshTriangle)
+   {
+      static_cast<const HitMeshTriangle*>(pho)->HitTestFeatures(pball, coll);
+      return;
+   }
+
    CollisionEvent newColl;
    const float newtime = pho->HitTest(pball->m_d, coll.m_hittime, newColl);
+   RecordHit(pball, pho, newtime, newColl, coll);
+}
+
+void RecordHit(const Ball *const pball, const HitObject *const pho, const float newtime, CollisionEvent& newColl, CollisionEvent& coll)
+{
    const bool validhit = ((newtime >= 0.f) && !sign(newtime) && (newtime <= coll.m_hittime));
 
    if (validhit)
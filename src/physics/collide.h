@@ -16,6 +16,7 @@ enum eObjType : unsigned char
    eTriangle,
    ePlane,
    e3DLine,
+   eMeshTriangle,
    eGate,
    eTextbox,
    eDispReel,
@@ -101,6 +102,10 @@ public:
       m_ObjType(eNull), m_enabled(true), m_fe(false), m_e(0) {}
    virtual ~HitObject() {}
 
+   // Allocated from the current physics arena of the thread if any, otherwise from the heap
+   static void* operator new(const size_t size);
+   static void operator delete(void* const p);
+
    virtual float HitTest(const BallS& ball, const float dtime, CollisionEvent& coll) const { return -1.f; } //!! shouldn't need to do this, but for whatever reason there is a pure virtual function call triggered otherwise that refuses to be debugged (all derived classes DO implement this one!)
    virtual int GetType() const = 0;
    virtual void Collide(const CollisionEvent& coll) = 0;
@@ -130,7 +135,7 @@ public:
    bool  m_enabled;
 
    bool  m_fe;  // FireEvents for m_obj?
-   unsigned char m_e;   // currently only used to determine which HitTriangles/HitLines/HitPoints are being part of the same Primitive(1)/HitTarget(2) element m_obj, to be able to early out intersection traversal if primitive is flagged as not collidable, its 0 if no unique element
+   unsigned char m_e;   // currently only used to determine which HitTriangles/HitLines/HitPoints/HitMeshTriangles are being part of the same Primitive(1)/HitTarget(2) element m_obj, to be able to early out intersection traversal if primitive is flagged as not collidable, its 0 if no unique element
 };
 
 //
@@ -212,6 +217,8 @@ public:
    virtual void Collide(const CollisionEvent& coll) override;
    virtual void CalcHitBBox() override;
 
+   static float HitTestPoint(const Vertex3Ds& p, const BallS& ball, const float dtime, CollisionEvent& coll); // also used by HitMeshTriangle
+
    Vertex3Ds m_p;
 };
 
@@ -220,3 +227,6 @@ public:
 // Perform the actual hittest between ball and hit object and update
 // collision information if a hit occurred.
 void DoHitTest(const Ball * const pball, const HitObject * const pho, CollisionEvent& coll);
+
+// Keep the hit (if valid) as the first collision event, or remember it if it is a contact.
+void RecordHit(const Ball * const pball, const HitObject * const pho, const float newtime, CollisionEvent& newColl, CollisionEvent& coll);
@@ -752,15 +752,20 @@ float HitTriangle::HitTest(const BallS& ball, const float dtime, CollisionEvent&
 {
    if (!m_enabled) return -1.0f;
 
-   const float bnv = m_normal.Dot(ball.m_vel); // speed in Normal-vector direction
+   return HitTestTriangle(m_rgv[0], m_rgv[1], m_rgv[2], m_normal, ball, dtime, coll);
+}
+
+float HitTriangle::HitTestTriangle(const Vertex3Ds& p0, const Vertex3Ds& p1, const Vertex3Ds& p2, const Vertex3Ds& normal, const BallS& ball, const float dtime, CollisionEvent& coll)
+{
+   const float bnv = normal.Dot(ball.m_vel);   // speed in Normal-vector direction
 
    if (bnv > C_CONTACTVEL)                     // return if clearly ball is receding from object
       return -1.0f;
 
    // Point on the ball that will hit the polygon, if it hits at all
-   Vertex3Ds hitPos = ball.m_pos - ball.m_radius * m_normal; // nearest point on ball ... projected radius along norm
+   Vertex3Ds hitPos = ball.m_pos - ball.m_radius * normal; // nearest point on ball ... projected radius along norm
 
-   const float bnd = m_normal.Dot(hitPos - m_rgv[0]);  // distance from plane to ball
+   const float bnd = normal.Dot(hitPos - p0);  // distance from plane to ball
 
    if (bnd < -ball.m_radius/**2.0f*/) //!! *2 necessary?
       return -1.0f;	// (ball normal distance) excessive penetration of object skin ... no collision HACK
@@ -793,9 +798,9 @@ float HitTriangle::HitTest(const BallS& ball, const float dtime, CollisionEvent&
    // check if hitPos is within the triangle
 
    // Compute vectors
-   const Vertex3Ds v0 = m_rgv[2] - m_rgv[0];
-   const Vertex3Ds v1 = m_rgv[1] - m_rgv[0];
-   const Vertex3Ds v2 = hitPos - m_rgv[0];
+   const Vertex3Ds v0 = p2 - p0;
+   const Vertex3Ds v1 = p1 - p0;
+   const Vertex3Ds v2 = hitPos - p0;
 
    // Compute dot products
    const float dot00 = v0.Dot(v0);
@@ -812,7 +817,7 @@ float HitTriangle::HitTest(const BallS& ball, const float dtime, CollisionEvent&
    // Check if point is in triangle
    if ((u >= 0.f) && (v >= 0.f) && (u + v <= 1.f))
    {
-      coll.m_hitnormal = m_normal;
+      coll.m_hitnormal = normal;
 
       coll.m_hitdistance = bnd;				// 3dhit actual contact distance ... 
       //coll.m_hitRigid = true;				// collision type
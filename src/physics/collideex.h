@@ -89,6 +89,9 @@ public:
 
    bool IsDegenerate() const { return m_normal.IsZero(); }
 
+   // Plane and barycentric test of a triangle given by its vertices (counterclockwise order) and normal, also used by HitMeshTriangle
+   static float HitTestTriangle(const Vertex3Ds& p0, const Vertex3Ds& p1, const Vertex3Ds& p2, const Vertex3Ds& normal, const BallS& ball, const float dtime, CollisionEvent& coll);
+
    Vertex3Ds m_rgv[3];
    Vertex3Ds m_normal;
 };
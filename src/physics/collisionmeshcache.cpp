@@ -0,0 +1,163 @@
+#include "stdafx.h"
+#include "collisionmeshcache.h"
+#include <fstream>
+
+CollisionMeshCache g_collisionMeshCache;
+
+// File layout: magic, payload length and checksum, then the payload (entry count, and for each entry its key, vertex and index
+// counts followed by the vertices and indices)
+static constexpr char cacheFileMagic[8] = { 'V', 'P', 'X', 'C', 'M', 'C', '0', '2' };
+static constexpr U32 maxMeshVertices = 1u << 24; // Sanity limits for the counts read from the file
+static constexpr U32 maxMeshIndices = 1u << 25;
+
+bool CollisionMeshCache::Mesh::HasValidIndices() const
+{
+   const size_t nVertices = m_vertices.size();
+   for (const ProgMesh::tridata& t : m_indices)
+      if (t.v[0] >= nVertices || t.v[1] >= nVertices || t.v[2] >= nVertices)
+         return false;
+   return true;
+}
+
+U64 CollisionMeshCache::ComputeKey(const vector<ProgMesh::float3>& vertices, const vector<ProgMesh::tridata>& indices, const unsigned int reducedVertices)
+{
+   U64 key = (U64)robin_hood::hash_bytes(vertices.data(), vertices.size() * sizeof(ProgMesh::float3));
+   key = key * 0x9E3779B97F4A7C15ull ^ (U64)robin_hood::hash_bytes(indices.data(), indices.size() * sizeof(ProgMesh::tridata));
+   key = key * 0x9E3779B97F4A7C15ull ^ ((U64)vertices.size() << 32 | reducedVertices);
+   return key;
+}
+
+std::shared_ptr<const CollisionMeshCache::Mesh> CollisionMeshCache::Find(const U64 key)
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   const auto it = m_entries.find(key);
+   if (it == m_entries.end())
+      return nullptr;
+   it->second.m_used = true;
+   return it->second.m_mesh;
+}
+
+void CollisionMeshCache::Add(const U64 key, const std::shared_ptr<const Mesh>& mesh)
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   m_entries[key] = { mesh, true };
+   m_dirty = true;
+}
+
+void CollisionMeshCache::PruneUnused()
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   for (auto it = m_entries.begin(); it != m_entries.end();)
+   {
+      if (it->second.m_used)
+      {
+         it->second.m_used = false;
+         ++it;
+      }
+      else
+      {
+         it = m_entries.erase(it);
+         m_dirty = true;
+      }
+   }
+}
+
+bool CollisionMeshCache::Load(const string& path)
+{
+   std::ifstream file(path, std::ios::binary | std::ios::ate);
+   if (!file.is_open())
+      return false;
+
+   // The whole file is validated before any entry is merged, so a corrupt or partly written file is dropped as a whole
+   const std::streamoff fileSize = file.tellg();
+   file.seekg(0);
+   char magic[sizeof(cacheFileMagic)];
+   U64 payloadSize = 0, checksum = 0;
+   file.read(magic, sizeof(magic));
+   file.read((char*)&payloadSize, sizeof(payloadSize));
+   file.read((char*)&checksum, sizeof(checksum));
+   const U64 headerSize = sizeof(magic) + sizeof(payloadSize) + sizeof(checksum);
+   if (!file || memcmp(magic, cacheFileMagic, sizeof(magic)) != 0 || fileSize < 0 || payloadSize != (U64)fileSize - headerSize)
+   {
+      PLOGE << "Invalid collision mesh cache file: " << path;
+      return false;
+   }
+   vector<char> payload((size_t)payloadSize);
+   file.read(payload.data(), payload.size());
+   if (!file || (U64)robin_hood::hash_bytes(payload.data(), payload.size()) != checksum)
+   {
+      PLOGE << "Corrupted collision mesh cache file: " << path;
+      return false;
+   }
+
+   size_t pos = 0;
+   const auto read = [&payload, &pos](void* const dst, const size_t size)
+   {
+      if (size > payload.size() - pos)
+         return false;
+      memcpy(dst, payload.data() + pos, size);
+      pos += size;
+      return true;
+   };
+   vector<std::pair<U64, std::shared_ptr<const Mesh>>> meshes;
+   U32 nEntries = 0;
+   bool valid = read(&nEntries, sizeof(nEntries));
+   for (U32 i = 0; valid && i < nEntries; i++)
+   {
+      U64 key;
+      U32 nVertices, nIndices;
+      valid = read(&key, sizeof(key)) && read(&nVertices, sizeof(nVertices)) && read(&nIndices, sizeof(nIndices))
+         && nVertices <= maxMeshVertices && nIndices <= maxMeshIndices
+         && (U64)nVertices * sizeof(ProgMesh::float3) + (U64)nIndices * sizeof(ProgMesh::tridata) <= payload.size() - pos;
+      if (!valid)
+         break;
+      const std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>();
+      mesh->m_vertices.resize(nVertices);
+      mesh->m_indices.resize(nIndices);
+      valid = read(mesh->m_vertices.data(), nVertices * sizeof(ProgMesh::float3)) && read(mesh->m_indices.data(), nIndices * sizeof(ProgMesh::tridata)) && mesh->HasValidIndices();
+      meshes.emplace_back(key, mesh);
+   }
+   if (!valid || pos != payload.size())
+   {
+      PLOGE << "Invalid collision mesh cache file: " << path;
+      return false;
+   }
+
+   std::lock_guard<std::mutex> lock(m_mutex);
+   for (const auto& mesh : meshes)
+      if (m_entries.find(mesh.first) == m_entries.end())
+         m_entries[mesh.first] = { mesh.second, false };
+   m_dirty = false;
+   return true;
+}
+
+bool CollisionMeshCache::Save(const string& path)
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   vector<char> payload;
+   const auto write = [&payload](const void* const src, const size_t size) { payload.insert(payload.end(), (const char*)src, (const char*)src + size); };
+   const U32 nEntries = (U32)m_entries.size();
+   write(&nEntries, sizeof(nEntries));
+   for (const auto& entry : m_entries)
+   {
+      const Mesh& mesh = *entry.second.m_mesh;
+      const U32 nVertices = (U32)mesh.m_vertices.size(), nIndices = (U32)mesh.m_indices.size();
+      write(&entry.first, sizeof(entry.first));
+      write(&nVertices, sizeof(nVertices));
+      write(&nIndices, sizeof(nIndices));
+      write(mesh.m_vertices.data(), nVertices * sizeof(ProgMesh::float3));
+      write(mesh.m_indices.data(), nIndices * sizeof(ProgMesh::tridata));
+   }
+   const U64 payloadSize = payload.size();
+   const U64 checksum = (U64)robin_hood::hash_bytes(payload.data(), payload.size());
+
+   std::ofstream file(path, std::ios::binary | std::ios::trunc);
+   if (!file.is_open())
+      return false;
+   file.write(cacheFileMagic, sizeof(cacheFileMagic));
+   file.write((const char*)&payloadSize, sizeof(payloadSize));
+   file.write((const char*)&checksum, sizeof(checksum));
+   file.write(payload.data(), payload.size());
+   m_dirty = false;
+   return file.good();
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "progmesh.h"
+#include <mutex>
+
+// Cache of the reduced collision meshes of primitives
+//
+// Reducing a primitive collision mesh (ProgMesh progressive mesh, permutation and remapping) only depends on the (transformed)
+// mesh and on the targeted vertex count, but is expensive for large meshes. Results are kept in memory between play sessions,
+// and can be persisted with the other cached data of the table. Entries not used during a play session are pruned at its end.
+class CollisionMeshCache final
+{
+public:
+   struct Mesh
+   {
+      vector<ProgMesh::float3> m_vertices; // Permuted vertices
+      vector<ProgMesh::tridata> m_indices; // Reduced triangles
+
+      bool HasValidIndices() const; // All triangle indices reference an existing vertex
+   };
+
+   static U64 ComputeKey(const vector<ProgMesh::float3>& vertices, const vector<ProgMesh::tridata>& indices, const unsigned int reducedVertices);
+
+   // Thread safe, as hit shapes of the parts are generated concurrently
+   std::shared_ptr<const Mesh> Find(const U64 key);
+   void Add(const U64 key, const std::shared_ptr<const Mesh>& mesh);
+
+   void PruneUnused(); // Remove entries not used since the last call
+   bool Load(const string& path);
+   bool Save(const string& path);
+   bool IsDirty() const { return m_dirty; }
+
+private:
+   struct Entry
+   {
+      std::shared_ptr<const Mesh> m_mesh;
+      bool m_used;
+   };
+
+   std::mutex m_mutex;
+   robin_hood::unordered_map<U64, Entry> m_entries;
+   bool m_dirty = false; // Modified since last load/save
+};
+
+extern CollisionMeshCache g_collisionMeshCache;
@@ -487,6 +487,47 @@ void Ball::CalcHitBBox()
    m_hitBBox.zhigh  = m_d.m_pos.z + vl;
 }
 
+BallSweep::BallSweep(const Ball * const pball, const float hittime)
+{
+   const Vertex3Ds& pos = pball->m_d.m_pos;
+   const Vertex3Ds dir = pball->m_d.m_vel * max(hittime, 0.f);
+   const float radius = pball->m_d.m_radius + 0.05f; //!! 0.05f = paranoia, see CalcHitBBox
+
+   m_bbox.left   = min(pos.x, pos.x + dir.x) - radius;
+   m_bbox.right  = max(pos.x, pos.x + dir.x) + radius;
+   m_bbox.top    = min(pos.y, pos.y + dir.y) - radius;
+   m_bbox.bottom = max(pos.y, pos.y + dir.y) + radius;
+   m_bbox.zlow   = min(pos.z, pos.z + dir.z) - radius;
+   m_bbox.zhigh  = max(pos.z, pos.z + dir.z) + radius;
+
+   // box bounds are expanded by the radius, so the slab entry/exit times are (bound -/+ radius - pos) / dir
+   m_lo = Vertex3Ds(pos.x + radius, pos.y + radius, pos.z + radius);
+   m_hi = Vertex3Ds(pos.x - radius, pos.y - radius, pos.z - radius);
+
+   // axes the ball does not move along get a huge but finite inverse, so that the slab test then just checks if the start
+   // is inside the slab (and never computes 0*inf = NaN)
+   const auto inverse = [](const float d) { return 1.0f / (fabsf(d) > 1.0e-20f ? d : (d < 0.f ? -1.0e-20f : 1.0e-20f)); };
+   m_invDir = Vertex3Ds(inverse(dir.x), inverse(dir.y), inverse(dir.z));
+
+#ifdef ENABLE_SSE_OPTIMIZATIONS
+   m_bleft = _mm_set1_ps(m_bbox.left);
+   m_bright = _mm_set1_ps(m_bbox.right);
+   m_btop = _mm_set1_ps(m_bbox.top);
+   m_bbottom = _mm_set1_ps(m_bbox.bottom);
+   m_bzlow = _mm_set1_ps(m_bbox.zlow);
+   m_bzhigh = _mm_set1_ps(m_bbox.zhigh);
+   m_lox = _mm_set1_ps(m_lo.x);
+   m_loy = _mm_set1_ps(m_lo.y);
+   m_loz = _mm_set1_ps(m_lo.z);
+   m_hix = _mm_set1_ps(m_hi.x);
+   m_hiy = _mm_set1_ps(m_hi.y);
+   m_hiz = _mm_set1_ps(m_hi.z);
+   m_invx = _mm_set1_ps(m_invDir.x);
+   m_invy = _mm_set1_ps(m_invDir.y);
+   m_invz = _mm_set1_ps(m_invDir.z);
+#endif
+}
+
 void BallMoverObject::UpdateDisplacements(const float dtime)
 {
    m_pball->UpdateDisplacements(dtime);
@@ -29,6 +29,10 @@ class Ball : public HitObject
 public:
    Ball();
 
+   // Balls are created and destroyed during play, so they are never allocated from the physics arena
+   static void* operator new(const size_t size) { return ::operator new(size); }
+   static void operator delete(void* const p) { ::operator delete(p); }
+
    void Init(const float mass);
 
    void UpdateDisplacements(const float dtime);
@@ -96,3 +100,64 @@ public:
    bool m_pinballEnvSphericalMapping;
    Texture* m_pinballDecal;
 };
+
+// Swept sphere of a ball during a collision search: the ball (plus the same paranoia margin as in Ball::CalcHitBBox) moving
+// along its velocity from its current position up to the searched hit time. The collision trees use it to prune nodes and
+// hit objects (segment vs. slabs of the boxes expanded by the radius) instead of the velocity inflated m_hitBBox, which covers
+// all directions and is thus much larger for fast balls. This is still conservative, as the ball only moves linearly until
+// the next collision (the search is restarted after each collision).
+class BallSweep final
+{
+public:
+   BallSweep(const Ball * const pball, const float hittime);
+
+   bool Intersect(const FRect3D& rc) const
+   {
+      if (!fRectIntersect3D(m_bbox, rc))
+         return false;
+      const float tx0 = (rc.left   - m_lo.x) * m_invDir.x, tx1 = (rc.right  - m_hi.x) * m_invDir.x;
+      const float ty0 = (rc.top    - m_lo.y) * m_invDir.y, ty1 = (rc.bottom - m_hi.y) * m_invDir.y;
+      const float tz0 = (rc.zlow   - m_lo.z) * m_invDir.z, tz1 = (rc.zhigh  - m_hi.z) * m_invDir.z;
+      const float tnear = max(max(min(tx0, tx1), min(ty0, ty1)), min(tz0, tz1));
+      const float tfar  = min(min(max(tx0, tx1), max(ty0, ty1)), max(tz0, tz1));
+      return tnear <= tfar && tnear <= 1.f && tfar >= 0.f;
+   }
+
+#ifdef ENABLE_SSE_OPTIMIZATIONS
+   // same as Intersect for 4 boxes at once, returns the bit mask of the intersected boxes
+   int Intersect4(const __m128 left, const __m128 right, const __m128 top, const __m128 bottom, const __m128 zlow, const __m128 zhigh) const
+   {
+      int mask = _mm_movemask_ps(_mm_cmpge_ps(m_bright, left));
+      if (mask == 0) return 0;
+      mask &= _mm_movemask_ps(_mm_cmple_ps(m_bleft, right));
+      if (mask == 0) return 0;
+      mask &= _mm_movemask_ps(_mm_cmpge_ps(m_bbottom, top));
+      if (mask == 0) return 0;
+      mask &= _mm_movemask_ps(_mm_cmple_ps(m_btop, bottom));
+      if (mask == 0) return 0;
+      mask &= _mm_movemask_ps(_mm_cmpge_ps(m_bzhigh, zlow));
+      if (mask == 0) return 0;
+      mask &= _mm_movemask_ps(_mm_cmple_ps(m_bzlow, zhigh));
+      if (mask == 0) return 0;
+
+      const __m128 tx0 = _mm_mul_ps(_mm_sub_ps(left,   m_lox), m_invx), tx1 = _mm_mul_ps(_mm_sub_ps(right,  m_hix), m_invx);
+      const __m128 ty0 = _mm_mul_ps(_mm_sub_ps(top,    m_loy), m_invy), ty1 = _mm_mul_ps(_mm_sub_ps(bottom, m_hiy), m_invy);
+      const __m128 tz0 = _mm_mul_ps(_mm_sub_ps(zlow,   m_loz), m_invz), tz1 = _mm_mul_ps(_mm_sub_ps(zhigh,  m_hiz), m_invz);
+      const __m128 tnear = _mm_max_ps(_mm_max_ps(_mm_min_ps(tx0, tx1), _mm_min_ps(ty0, ty1)), _mm_min_ps(tz0, tz1));
+      const __m128 tfar  = _mm_min_ps(_mm_min_ps(_mm_max_ps(tx0, tx1), _mm_max_ps(ty0, ty1)), _mm_max_ps(tz0, tz1));
+      const __m128 hit = _mm_and_ps(_mm_cmple_ps(tnear, tfar), _mm_and_ps(_mm_cmple_ps(tnear, _mm_set1_ps(1.f)), _mm_cmpge_ps(tfar, _mm_setzero_ps())));
+      return mask & _mm_movemask_ps(hit);
+   }
+#endif
+
+   FRect3D m_bbox; // bounds of the swept sphere
+
+private:
+   Vertex3Ds m_lo, m_hi; // start of the segment, offset by +/- the radius, to get the entry/exit times of the expanded slabs
+   Vertex3Ds m_invDir;   // inverse of the segment direction (clamped to stay finite)
+
+#ifdef ENABLE_SSE_OPTIMIZATIONS
+   __m128 m_bleft, m_bright, m_btop, m_bbottom, m_bzlow, m_bzhigh;
+   __m128 m_lox, m_loy, m_loz, m_hix, m_hiy, m_hiz, m_invx, m_invy, m_invz;
+#endif
+};
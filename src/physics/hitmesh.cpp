@@ -0,0 +1,243 @@
+#include "stdafx.h"
+
+void HitMesh::Build()
+{
+   for (Triangle& t : m_triangles)
+   {
+      const Vertex3Ds e0 = m_vertices[t.m_v[2]] - m_vertices[t.m_v[0]];
+      const Vertex3Ds e1 = m_vertices[t.m_v[1]] - m_vertices[t.m_v[0]];
+      t.m_normal = CrossProduct(e0, e1);
+      t.m_normal.NormalizeSafe();
+      t.m_owned = 0;
+   }
+
+   // Gather the half edges of all triangles, sorted by their (unordered) vertex pair, then by triangle, so that the
+   // triangles sharing an edge are contiguous and the first of them is the lowest triangle index (owning the edge)
+   struct HalfEdge
+   {
+      U64 m_key;
+      unsigned int m_triangle;
+      unsigned int m_slot;
+   };
+   vector<HalfEdge> halfEdges;
+   halfEdges.reserve(m_triangles.size() * 3);
+   for (unsigned int i = 0; i < (unsigned int)m_triangles.size(); ++i)
+      for (unsigned int j = 0; j < 3; ++j)
+      {
+         const unsigned int a = m_triangles[i].m_v[j], b = m_triangles[i].m_v[j < 2 ? j + 1 : 0];
+         halfEdges.push_back({ (U64)min(a, b) << 32 | max(a, b), i, j });
+      }
+   std::sort(halfEdges.begin(), halfEdges.end(), [](const HalfEdge& a, const HalfEdge& b) { return a.m_key < b.m_key || (a.m_key == b.m_key && a.m_triangle < b.m_triangle); });
+
+   m_edges.clear();
+   for (size_t i = 0; i < halfEdges.size();)
+   {
+      size_t n = 1;
+      while (i + n < halfEdges.size() && halfEdges[i + n].m_key == halfEdges[i].m_key)
+         n++;
+
+      const HalfEdge& first = halfEdges[i];
+      Triangle& owner = m_triangles[first.m_triangle];
+      Edge edge;
+      edge.m_v[0] = owner.m_v[first.m_slot];
+      edge.m_v[1] = owner.m_v[first.m_slot < 2 ? first.m_slot + 1 : 0];
+      edge.m_triangles[0] = first.m_triangle;
+      edge.m_triangles[1] = n > 1 ? halfEdges[i + 1].m_triangle : INVALID_INDEX;
+      edge.m_dir = m_vertices[edge.m_v[1]] - m_vertices[edge.m_v[0]];
+      edge.m_length = edge.m_dir.Length();
+      if (edge.m_length > 0.f)
+      {
+         edge.m_dir /= edge.m_length;
+         owner.m_owned |= 1 << first.m_slot;
+      }
+      // else degenerate edge, nothing to test
+
+      const unsigned int edgeIndex = (unsigned int)m_edges.size();
+      for (size_t j = 0; j < n; ++j)
+      {
+         const HalfEdge& he = halfEdges[i + j];
+         m_triangles[he.m_triangle].m_edges[he.m_slot] = edgeIndex;
+         m_triangles[he.m_triangle].m_adjacent[he.m_slot] = n != 2 ? INVALID_INDEX : halfEdges[i + 1 - j].m_triangle;
+      }
+      m_edges.push_back(edge);
+      i += n;
+   }
+
+   // Vertices are owned by the first triangle using them
+   vector<bool> used(m_vertices.size(), false);
+   for (Triangle& t : m_triangles)
+      for (unsigned int j = 0; j < 3; ++j)
+         if (!used[t.m_v[j]])
+         {
+            used[t.m_v[j]] = true;
+            t.m_owned |= 8 << j;
+         }
+   m_isolatedVertices.clear();
+   for (unsigned int i = 0; i < (unsigned int)m_vertices.size(); ++i)
+      if (!used[i])
+         m_isolatedVertices.push_back(i);
+}
+
+//
+
+void HitMeshTriangle::CalcHitBBox()
+{
+   const HitMesh::Triangle& t = m_mesh->m_triangles[m_index];
+   const Vertex3Ds& v0 = m_mesh->m_vertices[t.m_v[0]];
+   const Vertex3Ds& v1 = m_mesh->m_vertices[t.m_v[1]];
+   const Vertex3Ds& v2 = m_mesh->m_vertices[t.m_v[2]];
+   m_hitBBox.left   = min(v0.x, min(v1.x, v2.x));
+   m_hitBBox.right  = max(v0.x, max(v1.x, v2.x));
+   m_hitBBox.top    = min(v0.y, min(v1.y, v2.y));
+   m_hitBBox.bottom = max(v0.y, max(v1.y, v2.y));
+   m_hitBBox.zlow   = min(v0.z, min(v1.z, v2.z));
+   m_hitBBox.zhigh  = max(v0.z, max(v1.z, v2.z));
+}
+
+float HitMeshTriangle::HitTestFace(const BallS& ball, const float dtime, CollisionEvent& coll) const
+{
+   const HitMesh::Triangle& t = m_mesh->m_triangles[m_index];
+   return HitTriangle::HitTestTriangle(m_mesh->m_vertices[t.m_v[0]], m_mesh->m_vertices[t.m_v[1]], m_mesh->m_vertices[t.m_v[2]], t.m_normal, ball, dtime, coll);
+}
+
+// Same as HitLine3D::HitTest, but directly working on the components of the ball position and velocity perpendicular to
+// the edge, instead of rotating the ball into a coordinate system where the edge is aligned with the z axis
+float HitMeshTriangle::HitTestEdge(const HitMesh::Edge& edge, const BallS& ball, const float dtime, CollisionEvent& coll) const
+{
+   const Vertex3Ds rel = ball.m_pos - m_mesh->m_vertices[edge.m_v[0]];
+   const float posAlong = rel.Dot(edge.m_dir);
+   const float velAlong = ball.m_vel.Dot(edge.m_dir);
+   const Vertex3Ds dist = rel - posAlong * edge.m_dir;      // relative ball position, perpendicular to the edge
+   const Vertex3Ds dv = ball.m_vel - velAlong * edge.m_dir; // ball velocity, perpendicular to the edge
+
+   const float bcddsq = dist.LengthSquared(); // ball center to line distance squared
+   const float bcdd = sqrtf(bcddsq);          // distance ball to line
+   if (bcdd <= 1.0e-6f)
+      return -1.0f;                           // no hit on exact center
+
+   const float b = dist.Dot(dv);
+   const float bnv = b / bcdd;                // ball normal velocity
+
+   if (bnv > C_CONTACTVEL)
+      return -1.0f;                           // clearly receding from radius
+
+   const float bnd = bcdd - ball.m_radius;    // ball distance to line
+
+   const float a = dv.LengthSquared();
+
+   float hittime = 0.f;
+   bool isContact = false;
+
+   if (bnd < (float)PHYS_TOUCH)       // already in collision distance?
+   {
+      if (fabsf(bnv) <= C_CONTACTVEL)
+      {
+         isContact = true;
+         hittime = 0.f;
+      }
+      else
+         hittime = -bnd / bnv;   // estimate based on distance and speed along distance
+   }
+   else
+   {
+      if (a < 1.0e-8f)
+         return -1.0f;    // no hit - ball not moving relative to object
+
+      float time1, time2;
+      if (!SolveQuadraticEq(a, 2.0f*b, bcddsq - ball.m_radius*ball.m_radius, time1, time2))
+         return -1.0f;
+
+      hittime = (time1*time2 < 0.f) ? max(time1, time2) : min(time1, time2); // find smallest nonnegative solution
+   }
+
+   if (infNaN(hittime) || hittime < 0 || hittime > dtime)
+      return -1.0f; // contact out of physics frame
+
+   const float hitAlong = posAlong + hittime * velAlong; // ball position along the edge at hit time
+   if (hitAlong < 0.f || hitAlong > edge.m_length)
+      return -1.0f;
+
+   coll.m_hitnormal = dist + hittime * dv;
+   coll.m_hitnormal.Normalize();
+
+   coll.m_isContact = isContact;
+   if (isContact)
+      coll.m_hit_org_normalvelocity = bnv;
+
+   coll.m_hitdistance = bnd; // actual contact distance
+   //coll.m_hitRigid = true;
+
+   return hittime;
+}
+
+float HitMeshTriangle::HitTest(const BallS& ball, const float dtime, CollisionEvent& coll) const
+{
+   if (!m_enabled)
+      return -1.0f;
+
+   const HitMesh::Triangle& t = m_mesh->m_triangles[m_index];
+   float hittime = -1.0f;
+   CollisionEvent newColl;
+   const auto keepEarliest = [&](const float newtime)
+   {
+      if (newtime >= 0.f && (hittime < 0.f || newtime < hittime))
+      {
+         hittime = newtime;
+         coll = newColl;
+      }
+   };
+   if (!t.m_normal.IsZero())
+      keepEarliest(HitTestFace(ball, dtime, newColl));
+   for (unsigned int i = 0; i < 3; ++i)
+      if (t.m_owned & (1 << i))
+         keepEarliest(HitTestEdge(m_mesh->m_edges[t.m_edges[i]], ball, dtime, newColl));
+   for (unsigned int i = 0; i < 3; ++i)
+      if (t.m_owned & (8 << i))
+         keepEarliest(HitPoint::HitTestPoint(m_mesh->m_vertices[t.m_v[i]], ball, dtime, newColl));
+   return hittime;
+}
+
+void HitMeshTriangle::HitTestFeatures(const Ball * const pball, CollisionEvent& coll) const
+{
+   if (!m_enabled)
+      return;
+
+   const HitMesh::Triangle& t = m_mesh->m_triangles[m_index];
+   if (!t.m_normal.IsZero())
+   {
+      CollisionEvent newColl;
+      const float newtime = HitTestFace(pball->m_d, coll.m_hittime, newColl);
+      RecordHit(pball, this, newtime, newColl, coll);
+   }
+   for (unsigned int i = 0; i < 3; ++i)
+      if (t.m_owned & (1 << i))
+      {
+         CollisionEvent newColl;
+         const float newtime = HitTestEdge(m_mesh->m_edges[t.m_edges[i]], pball->m_d, coll.m_hittime, newColl);
+         RecordHit(pball, this, newtime, newColl, coll);
+      }
+   for (unsigned int i = 0; i < 3; ++i)
+      if (t.m_owned & (8 << i))
+      {
+         CollisionEvent newColl;
+         const float newtime = HitPoint::HitTestPoint(m_mesh->m_vertices[t.m_v[i]], pball->m_d, coll.m_hittime, newColl);
+         RecordHit(pball, this, newtime, newColl, coll);
+      }
+}
+
+// Faces, edges and vertices collide the same way, along the normal of the collision event
+void HitMeshTriangle::Collide(const CollisionEvent& coll)
+{
+   Ball *const pball = coll.m_ball;
+   const Vertex3Ds& hitnormal = coll.m_hitnormal;
+
+   const float dot = -(hitnormal.Dot(pball->m_d.m_vel));
+
+   pball->Collide3DWall(hitnormal, m_elasticity, m_elasticityFalloff, m_friction, m_scatter);
+
+   if (m_obj && m_fe && dot >= m_threshold)
+   {
+      m_obj->m_currentHitThreshold = dot;
+      FireHitEvent(pball);
+   }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+// Indexed collision mesh (used by primitives and rubbers)
+//
+// Vertices and edges are shared by the triangles of the mesh instead of being copied into independent triangle, line and point
+// hit objects. Each triangle owns the edges and vertices it is the first to reference, so that every feature of the mesh is
+// tested exactly once. The collision trees reference the mesh through one light HitMeshTriangle per triangle (mesh and triangle
+// index), which tests the face of the triangle together with the edges and vertices it owns.
+class HitMesh final
+{
+public:
+   static constexpr unsigned int INVALID_INDEX = ~0u;
+
+   struct Edge
+   {
+      unsigned int m_v[2];
+      unsigned int m_triangles[2]; // Triangles sharing the edge (INVALID_INDEX for border edges)
+      Vertex3Ds m_dir; // Normalized direction from m_v[0] to m_v[1]
+      float m_length;
+   };
+
+   struct Triangle
+   {
+      unsigned int m_v[3]; // Counterclockwise order
+      unsigned int m_edges[3]; // Edge i goes from m_v[i] to m_v[(i + 1) % 3]
+      unsigned int m_adjacent[3]; // Triangle on the other side of edge i (INVALID_INDEX for border or non manifold edges)
+      Vertex3Ds m_normal; // Zero for degenerate triangles, which are then only tested through their edges and vertices
+      BYTE m_owned; // Bit i (0..2) set if edge i is owned by this triangle, bit 3 + i if vertex i is owned by this triangle
+
+      bool HasHitFeatures() const { return m_owned != 0 || !m_normal.IsZero(); }
+   };
+
+   // NB: HitMesh wants CCW vertices, but for rendering we have them in CW order
+   void AddTriangle(const unsigned int i0, const unsigned int i1, const unsigned int i2) { m_triangles.push_back({ { i0, i1, i2 } }); }
+   void Build(); // Compute normals, shared edges, adjacency and feature ownership once all vertices and triangles are added
+
+   vector<Vertex3Ds> m_vertices;
+   vector<Edge> m_edges;
+   vector<Triangle> m_triangles;
+   vector<unsigned int> m_isolatedVertices; // Vertices not used by any triangle
+};
+
+class HitMeshTriangle : public HitObject
+{
+public:
+   HitMeshTriangle(const HitMesh * const mesh, const unsigned int index) : m_mesh(mesh), m_index(index) { CalcHitBBox(); }
+
+   float HitTest(const BallS& ball, const float dtime, CollisionEvent& coll) const override; // Earliest hit of the face, owned edges and vertices
+   int GetType() const override { return eMeshTriangle; }
+   void Collide(const CollisionEvent& coll) override;
+   void CalcHitBBox() override;
+
+   // Test the face, owned edges and vertices as separate hits (as multiple contacts may happen at once), see DoHitTest
+   void HitTestFeatures(const Ball * const pball, CollisionEvent& coll) const;
+
+private:
+   float HitTestFace(const BallS& ball, const float dtime, CollisionEvent& coll) const;
+   float HitTestEdge(const HitMesh::Edge& edge, const BallS& ball, const float dtime, CollisionEvent& coll) const;
+
+   const HitMesh * const m_mesh;
+   const unsigned int m_index;
+};
@@ -0,0 +1,132 @@
+#include "stdafx.h"
+
+void TimerScheduler::Add(HitTimer* const timer)
+{
+   timer->m_order = m_nextOrder++;
+   m_active.push_back(timer);
+   Push(timer);
+   m_syncListsDirty = true;
+}
+
+void TimerScheduler::Clear()
+{
+   m_active.clear();
+   m_pending.clear();
+   m_heap.clear();
+   m_due.clear();
+   m_deferred.clear();
+   m_syncTimers.clear();
+   m_controllerSyncTimers.clear();
+   m_syncListsDirty = true;
+   m_nextOrder = 1;
+}
+
+void TimerScheduler::SetEnabled(HitTimer* const timer, const bool enabled)
+{
+   timer->m_enablePending = enabled;
+   if (!timer->m_changePending)
+   {
+      timer->m_changePending = true;
+      m_pending.push_back(timer);
+   }
+   Reschedule(timer);
+}
+
+void TimerScheduler::Reschedule(HitTimer* const timer)
+{
+   // Timers being fired are pushed back once done (with their new fire time)
+   if (!timer->m_queued)
+      Push(timer);
+   // The timer may have switched between the heap and the '-1'/'-2' lists
+   if (timer->m_order != 0 && (timer->m_interval < 0 ? timer->m_interval : 0) != timer->m_syncInterval)
+      m_syncListsDirty = true;
+}
+
+void TimerScheduler::ApplyChanges()
+{
+   if (m_pending.empty())
+      return;
+
+   bool removed = false;
+   for (HitTimer* const timer : m_pending)
+   {
+      timer->m_changePending = false;
+      if (timer->m_enablePending)
+      {
+         if (timer->m_order == 0) // add the timer (an already active timer keeps its position)
+         {
+            timer->m_order = m_nextOrder++;
+            m_active.push_back(timer);
+            Push(timer);
+         }
+      }
+      else if (timer->m_order != 0) // delete the timer
+      {
+         timer->m_order = 0;
+         timer->m_heapVersion++;
+         removed = true;
+      }
+   }
+   m_pending.clear();
+
+   if (removed)
+   {
+      m_active.erase(std::remove_if(m_active.begin(), m_active.end(), [](const HitTimer* const timer) { return timer->m_order == 0; }), m_active.end());
+      // Stale entries of disabled timers never become due (m_nextfire = 0xFFFFFFFF), so drop them from time to time
+      if (m_heap.size() > 2 * m_active.size() + 64)
+         RebuildHeap();
+   }
+   m_syncListsDirty = true;
+}
+
+void TimerScheduler::Push(HitTimer* const timer)
+{
+   timer->m_heapVersion++; // invalidates the previous entry
+   if (timer->m_order == 0 || timer->m_interval < 0)
+      return;
+   m_heap.push_back({ timer->m_nextfire, timer->m_heapVersion, timer });
+   std::push_heap(m_heap.begin(), m_heap.end(), LaterFire);
+}
+
+bool TimerScheduler::PopDue(const unsigned int time, HitTimer*& timer)
+{
+   while (!m_heap.empty() && m_heap.front().m_nextfire <= time)
+   {
+      std::pop_heap(m_heap.begin(), m_heap.end(), LaterFire);
+      const HeapEntry entry = m_heap.back();
+      m_heap.pop_back();
+      if (entry.m_version == entry.m_timer->m_heapVersion)
+      {
+         timer = entry.m_timer;
+         return true;
+      }
+   }
+   return false;
+}
+
+void TimerScheduler::RebuildHeap()
+{
+   m_heap.clear();
+   for (HitTimer* const timer : m_active)
+      if (!timer->m_queued)
+         Push(timer);
+}
+
+void TimerScheduler::UpdateSyncLists()
+{
+   if (!m_syncListsDirty)
+      return;
+   m_syncListsDirty = false;
+   m_syncTimers.clear();
+   m_controllerSyncTimers.clear();
+   for (HitTimer* const timer : m_active)
+   {
+      timer->m_syncInterval = timer->m_interval < 0 ? timer->m_interval : 0;
+      if (timer->m_interval < 0)
+      {
+         m_syncTimers.push_back(timer);
+         if (timer->m_interval == -2)
+            m_controllerSyncTimers.push_back(timer);
+      }
+   }
+}
@@ -23,4 +23,121 @@ public:
 
    int m_interval;
    unsigned int m_nextfire = 0;
+
+private:
+   friend class TimerScheduler;
+   unsigned int m_order = 0;       // position in the firing order of the active timers, 0 if not active
+   unsigned int m_heapVersion = 0; // only the scheduler heap entry with the current version is valid
+   bool m_changePending = false;   // en/disable change waiting for TimerScheduler::ApplyChanges
+   bool m_enablePending = false;
+   bool m_queued = false;          // in the list of due timers being fired
+   int m_syncInterval = 0;         // interval (-1/-2, or 0 for the other ones) when the sync lists were last built
+};
+
+// Dispatch of the timers during play
+//
+// Active timers keep the firing order of the former plain list (order of enabling). The ones with an interval >= 0 are kept in a
+// min heap on their next fire time, so that the physics ticks only look at the due timers instead of scanning all timers. The ones
+// synced with the frame (-1) or the controller (-2) are fired from separate lists. En/disabling is O(1) and only applied by the
+// next ApplyChanges(), to avoid problems with timers dis/enabling themselves (or each other) while being fired.
+class TimerScheduler final
+{
+public:
+   void Add(HitTimer* const timer); // initially enabled timer, to be added in firing order
+   void Clear();
+
+   void SetEnabled(HitTimer* const timer, const bool enabled);
+   void Reschedule(HitTimer* const timer); // to be called whenever m_nextfire or m_interval is changed from outside the fire callback
+   void ApplyChanges();
+
+   // Fire all timers with an interval >= 0 due at the given time, in firing order. The callback fires the event and advances m_nextfire.
+   template <typename FireFunc> void FireDue(const unsigned int time, FireFunc fire);
+
+   // Fire the '-1' and '-2' timers (or only the '-2' ones), in firing order
+   template <typename FireFunc> void FireSync(const bool controllerSyncOnly, FireFunc fire);
+
+private:
+   struct HeapEntry
+   {
+      unsigned int m_nextfire;
+      unsigned int m_version;
+      HitTimer* m_timer;
+   };
+   static bool LaterFire(const HeapEntry& a, const HeapEntry& b) { return a.m_nextfire > b.m_nextfire; }
+   static bool LaterOrder(const HitTimer* const a, const HitTimer* const b) { return a->m_order > b->m_order; }
+
+   void Push(HitTimer* const timer);
+   bool PopDue(const unsigned int time, HitTimer*& timer);
+   void RebuildHeap();
+   void UpdateSyncLists();
+
+   vector<HitTimer*> m_active;  // active timers, in firing order
+   vector<HitTimer*> m_pending; // timers with a pending en/disable change, in order of the first change
+   vector<HeapEntry> m_heap;    // min heap on m_nextfire, with stale entries skipped when popped
+   vector<HitTimer*> m_due;     // min heap on m_order of the timers to fire in the current FireDue
+   vector<HitTimer*> m_deferred;
+   vector<HitTimer*> m_syncTimers;           // '-1' and '-2' timers, in firing order
+   vector<HitTimer*> m_controllerSyncTimers; // '-2' timers, in firing order
+   bool m_syncListsDirty = true;
+   unsigned int m_nextOrder = 1;
 };
+
+template <typename FireFunc> void TimerScheduler::FireDue(const unsigned int time, FireFunc fire)
+{
+   // Due timers are fired in firing order. A timer becoming due again (or rescheduled by the script) after its turn waits for the
+   // next call, like with the former single scan of the timer list.
+   unsigned int lastOrder = 0;
+   const auto collectDue = [&]()
+   {
+      HitTimer* timer;
+      while (PopDue(time, timer))
+         if (timer->m_order <= lastOrder)
+            m_deferred.push_back(timer);
+         else if (!timer->m_queued)
+         {
+            timer->m_queued = true;
+            m_due.push_back(timer);
+            std::push_heap(m_due.begin(), m_due.end(), LaterOrder);
+         }
+   };
+
+   collectDue();
+   while (!m_due.empty())
+   {
+      std::pop_heap(m_due.begin(), m_due.end(), LaterOrder);
+      HitTimer* const pht = m_due.back();
+      m_due.pop_back();
+      pht->m_queued = false;
+      lastOrder = pht->m_order;
+      if (pht->m_interval >= 0 && pht->m_nextfire <= time)
+         fire(pht);
+      Push(pht);
+      collectDue(); // the script may have enabled/rescheduled other timers
+   }
+
+   for (HitTimer* const pht : m_deferred)
+      Push(pht);
+   m_deferred.clear();
+}
+
+template <typename FireFunc> void TimerScheduler::FireSync(const bool controllerSyncOnly, FireFunc fire)
+{
+   // The script may switch timers from/to the sync modes while being fired. The lists are then rebuilt and the scan resumes after
+   // the current timer, like with the former scan of the timer list.
+   UpdateSyncLists();
+   const vector<HitTimer*>& timers = controllerSyncOnly ? m_controllerSyncTimers : m_syncTimers;
+   for (size_t i = 0; i < timers.size();)
+   {
+      HitTimer* const pht = timers[i];
+      if (controllerSyncOnly ? pht->m_interval == -2 : pht->m_interval < 0)
+         fire(pht);
+      if (m_syncListsDirty)
+      {
+         const unsigned int order = pht->m_order;
+         UpdateSyncLists();
+         i = std::upper_bound(timers.begin(), timers.end(), order, [](const unsigned int o, const HitTimer* const timer) { return o < timer->m_order; }) - timers.begin();
+      }
+      else
+         i++;
+   }
+}
@@ -394,20 +394,9 @@ collisions
 
 */
 
-void HitKDNode::HitTestBall(const Ball * const pball, CollisionEvent& coll) const
+void HitKDNode::HitTestBall(const Ball * const pball, const BallSweep& sweep, CollisionEvent& coll) const
 {
-#ifdef KDTREE_SSE_LEAFTEST
-   /// with SSE optimizations ///////////////////////
-
-   HitTestBallSse(pball, coll);
-
-#else
-   /// without SSE optimization /////////////////////
-
    const unsigned int org_items = (m_items&0x3FFFFFFF);
-   const unsigned int axis = (m_items>>30);
-
-   const float rcHitRadiusSqr = pball->HitRadiusSqr();
 
    for (unsigned i=m_start; i<m_start+org_items; i++)
    {
@@ -416,8 +405,7 @@ void HitKDNode::HitTestBall(const Ball * const pball, CollisionEvent& coll) cons
 #endif
       HitObject * const pho = m_hitoct->GetItemAt(i);
       if ((pball != pho) // ball can not hit itself
-		  /*&& fRectIntersect3D(pball->m_hitBBox, pho->m_hitBBox)*/ //!! do bbox test before to save alu-instructions? or not to save registers? -> currently not, as just sphere vs sphere
-		 && fRectIntersect3D(pball->m_d.m_pos, rcHitRadiusSqr, pho->m_hitBBox))
+         && sweep.Intersect(pho->m_hitBBox))
       {
          DoHitTest(pball, pho, coll);
       }
@@ -428,34 +416,12 @@ void HitKDNode::HitTestBall(const Ball * const pball, CollisionEvent& coll) cons
 #ifdef DEBUGPHYSICS
       g_pplayer->c_traversed++;
 #endif
-      if (axis == 0)
-      {
-         const float vcenter = (m_rectbounds.left+m_rectbounds.right)*0.5f;
-         if (pball->m_hitBBox.left <= vcenter)
-            m_children[0].HitTestBall(pball, coll);
-         if (pball->m_hitBBox.right >= vcenter)
-            m_children[1].HitTestBall(pball, coll);
-      }
-      else
-         if (axis == 1)
-         {
-            const float vcenter = (m_rectbounds.top+m_rectbounds.bottom)*0.5f;
-            if (pball->m_hitBBox.top <= vcenter)
-               m_children[0].HitTestBall(pball, coll);
-            if (pball->m_hitBBox.bottom >= vcenter)
-               m_children[1].HitTestBall(pball, coll);
-         }
-         else
-         {
-            const float vcenter = (m_rectbounds.zlow+m_rectbounds.zhigh)*0.5f;
-
-            if (pball->m_hitBBox.zlow <= vcenter)
-               m_children[0].HitTestBall(pball, coll);
-            if (pball->m_hitBBox.zhigh >= vcenter)
-               m_children[1].HitTestBall(pball, coll);
-         }
+      // the children bounds are the two halves of this node, and contain all their hit objects
+      if (sweep.Intersect(m_children[0].m_rectbounds))
+         m_children[0].HitTestBall(pball, sweep, coll);
+      if (sweep.Intersect(m_children[1].m_rectbounds))
+         m_children[1].HitTestBall(pball, sweep, coll);
    }
-#endif
 }
 
 //
@@ -463,7 +429,7 @@ void HitKDNode::HitTestBall(const Ball * const pball, CollisionEvent& coll) cons
 //
 
 #ifdef KDTREE_SSE_LEAFTEST
-void HitKDNode::HitTestBallSse(const Ball * const pball, CollisionEvent& coll) const
+void HitKDNode::HitTestBallSse(const Ball * const pball, const BallSweep& sweep, CollisionEvent& coll) const
 {
    const HitKDNode* stack[128]; //!! should be enough, but better implement test in construction to not exceed this
    unsigned int stackpos = 0;
@@ -480,26 +446,12 @@ void HitKDNode::HitTestBallSse(const Ball * const pball, CollisionEvent& coll) c
    const __m128* __restrict const pZl = (__m128*)(m_hitoct->l_r_t_b_zl_zh + padded * 4);
    const __m128* __restrict const pZh = (__m128*)(m_hitoct->l_r_t_b_zl_zh + padded * 5);
 
-   // init SSE registers with ball bbox
-   /*const __m128 bleft = _mm_set1_ps(pball->m_hitBBox.left);
-   const __m128 bright = _mm_set1_ps(pball->m_hitBBox.right);
-   const __m128 btop = _mm_set1_ps(pball->m_hitBBox.top);
-   const __m128 bbottom = _mm_set1_ps(pball->m_hitBBox.bottom);
-   const __m128 bzlow = _mm_set1_ps(pball->m_hitBBox.zlow);
-   const __m128 bzhigh = _mm_set1_ps(pball->m_hitBBox.zhigh);*/
-
-   const __m128 posx = _mm_set1_ps(pball->m_d.m_pos.x);
-   const __m128 posy = _mm_set1_ps(pball->m_d.m_pos.y);
-   const __m128 posz = _mm_set1_ps(pball->m_d.m_pos.z);
-   const __m128 rsqr = _mm_set1_ps(pball->HitRadiusSqr());
-
    const bool traversal_order = (rand_mt_01() < 0.5f); // swaps test order in leafs randomly
    const unsigned int dt = traversal_order ? 1 : -1;
 
    do
    {
       const unsigned int org_items = (current->m_items & 0x3FFFFFFF);
-      const unsigned int axis = (current->m_items >> 30);
 
       // loop implements 4 collision checks at once
       // (rc1.right >= rc2.left && rc1.bottom >= rc2.top && rc1.left <= rc2.right && rc1.top <= rc2.bottom && rc1.zlow <= rc2.zhigh && rc1.zhigh >= rc2.zlow)
@@ -511,45 +463,10 @@ void HitKDNode::HitTestBallSse(const Ball * const pball, CollisionEvent& coll) c
 #ifdef DEBUGPHYSICS
          g_pplayer->c_tested++; //!! +=4? or is this more fair?
 #endif
-         // comparisons set bits if bounds miss. if all bits are set, there is no collision. otherwise continue comparisons
-         // bits set, there is a bounding box collision
-         /*__m128 cmp = _mm_cmpge_ps(bright, pL[i]);
-         int mask = _mm_movemask_ps(cmp);
-         if (mask == 0) continue;
-
-         cmp = _mm_cmple_ps(bleft, pR[i]);
-         mask &= _mm_movemask_ps(cmp);
-         if (mask == 0) continue;
-
-         cmp = _mm_cmpge_ps(bbottom, pT[i]);
-         mask &= _mm_movemask_ps(cmp);
-         if (mask == 0) continue;
-
-         cmp = _mm_cmple_ps(btop, pB[i]);
-         mask &= _mm_movemask_ps(cmp);
-         if (mask == 0) continue;
-
-         cmp = _mm_cmpge_ps(bzhigh, pZl[i]);
-         mask &= _mm_movemask_ps(cmp);
-         if (mask == 0) continue;
-
-         cmp = _mm_cmple_ps(bzlow, pZh[i]);
-         mask &= _mm_movemask_ps(cmp);
-         if (mask == 0) continue;*/ //!! do bbox test before to save alu-instructions? or not to save registers? -> currently not, as just sphere vs sphere
-
-		 // test actual sphere against box(es)
-		 const __m128 zero = _mm_setzero_ps();
-		 __m128 ex = _mm_add_ps(_mm_max_ps(_mm_sub_ps(pL[i],  posx), zero), _mm_max_ps(_mm_sub_ps(posx, pR[i] ), zero));
-		 __m128 ey = _mm_add_ps(_mm_max_ps(_mm_sub_ps(pT[i],  posy), zero), _mm_max_ps(_mm_sub_ps(posy, pB[i] ), zero));
-		 __m128 ez = _mm_add_ps(_mm_max_ps(_mm_sub_ps(pZl[i], posz), zero), _mm_max_ps(_mm_sub_ps(posz, pZh[i]), zero));
-		 ex = _mm_mul_ps(ex, ex);
-		 ey = _mm_mul_ps(ey, ey);
-		 ez = _mm_mul_ps(ez, ez);
-		 const __m128 d = _mm_add_ps(_mm_add_ps(ex, ey), ez);
-		 const __m128 cmp2 = _mm_cmple_ps(d, rsqr);
-		 const int mask2 = _mm_movemask_ps(cmp2);
-		 if (mask2 == 0) continue;
-		 
+         // test swept ball against box(es)
+         const int mask2 = sweep.Intersect4(pL[i], pR[i], pT[i], pB[i], pZl[i], pZh[i]);
+         if (mask2 == 0) continue;
+
 		 // now there is at least one bbox collision
          if ((mask2 & 1) != 0)
          {
@@ -586,25 +503,9 @@ void HitKDNode::HitTestBallSse(const Ball * const pball, CollisionEvent& coll) c
 #ifdef DEBUGPHYSICS
          g_pplayer->c_traversed++;
 #endif
-         if (axis == 0)
-         {
-            const float vcenter = (current->m_rectbounds.left + current->m_rectbounds.right)*0.5f;
-            if (pball->m_hitBBox.left <= vcenter) stack[++stackpos] = current->m_children;
-            if (pball->m_hitBBox.right >= vcenter) stack[++stackpos] = current->m_children + 1;
-         }
-         else
-            if (axis == 1)
-            {
-               const float vcenter = (current->m_rectbounds.top + current->m_rectbounds.bottom)*0.5f;
-               if (pball->m_hitBBox.top <= vcenter) stack[++stackpos] = current->m_children;
-               if (pball->m_hitBBox.bottom >= vcenter) stack[++stackpos] = current->m_children + 1;
-            }
-            else
-            {
-               const float vcenter = (current->m_rectbounds.zlow + current->m_rectbounds.zhigh)*0.5f;
-               if (pball->m_hitBBox.zlow <= vcenter) stack[++stackpos] = current->m_children;
-               if (pball->m_hitBBox.zhigh >= vcenter) stack[++stackpos] = current->m_children + 1;
-            }
+         // the children bounds are the two halves of this node, and contain all their hit objects
+         if (sweep.Intersect(current->m_children[0].m_rectbounds)) stack[++stackpos] = current->m_children;
+         if (sweep.Intersect(current->m_children[1].m_rectbounds)) stack[++stackpos] = current->m_children + 1;
       }
 
       //current = stack[stackpos];
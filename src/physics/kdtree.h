@@ -16,13 +16,13 @@ class HitKDNode final
 private:
    void Reset() { m_children = nullptr; m_hitoct = nullptr; m_start = 0; m_items = 0; }
 
-   void HitTestBall(const Ball * const pball, CollisionEvent& coll) const;
+   void HitTestBall(const Ball * const pball, const BallSweep& sweep, CollisionEvent& coll) const;
    void HitTestXRay(const Ball * const pball, vector<HitObject*> &pvhoHit, CollisionEvent& coll) const;
 
    void CreateNextLevel(const unsigned int level, unsigned int level_empty);
 
 #ifdef KDTREE_SSE_LEAFTEST
-   void HitTestBallSse(const Ball * const pball, CollisionEvent& coll) const;
+   void HitTestBallSse(const Ball * const pball, const BallSweep& sweep, CollisionEvent& coll) const;
 #endif
 
    FRect3D m_rectbounds;
@@ -61,10 +61,11 @@ public:
 
    void HitTestBall(const Ball * const pball, CollisionEvent& coll) const
    {
+      const BallSweep sweep(pball, coll.m_hittime);
 #ifdef KDTREE_SSE_LEAFTEST
-      m_rootNode.HitTestBallSse(pball, coll);
+      m_rootNode.HitTestBallSse(pball, sweep, coll);
 #else
-      m_rootNode.HitTestBall(pball, coll);
+      m_rootNode.HitTestBall(pball, sweep, coll);
 #endif
    }
 
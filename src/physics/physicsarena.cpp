@@ -0,0 +1,77 @@
+#include "stdafx.h"
+
+static thread_local PhysicsArena* s_currentArena = nullptr;
+
+PhysicsArena* PhysicsArena::GetCurrent()
+{
+   return s_currentArena;
+}
+
+void PhysicsArena::SetCurrent(PhysicsArena* const arena)
+{
+   s_currentArena = arena;
+}
+
+void* PhysicsArena::Allocate(const size_t size)
+{
+   constexpr size_t align = alignof(std::max_align_t);
+   const size_t alignedSize = (size + align - 1) & ~(align - 1);
+
+   // Only a few different hit object types (so sizes) exist, a linear search is fine
+   Pool* pool = nullptr;
+   for (Pool& p : m_pools)
+      if (p.m_size == alignedSize)
+      {
+         pool = &p;
+         break;
+      }
+   if (pool == nullptr)
+   {
+      m_pools.push_back({ alignedSize, {}, 0, max(BLOCK_SIZE / alignedSize, (size_t)16) * alignedSize });
+      pool = &m_pools.back();
+   }
+
+   if (pool->m_blocks.empty() || pool->m_used + alignedSize > pool->m_blockSize)
+   {
+      pool->m_blocks.push_back(static_cast<BYTE*>(::operator new(pool->m_blockSize)));
+      pool->m_used = 0;
+   }
+
+   void* const p = pool->m_blocks.back() + pool->m_used;
+   pool->m_used += alignedSize;
+   m_nAllocations++;
+   return p;
+}
+
+void PhysicsArena::Release()
+{
+   for (const Pool& pool : m_pools)
+      for (BYTE* const block : pool.m_blocks)
+         ::operator delete(block);
+   m_pools.clear();
+   m_nAllocations = 0;
+}
+
+void PhysicsArena::Merge(PhysicsArena& other)
+{
+   for (Pool& pool : other.m_pools)
+   {
+      // Keep our partially filled block of the same size (if any) as the last one
+      auto it = std::find_if(m_pools.begin(), m_pools.end(), [&pool](const Pool& p) { return p.m_size == pool.m_size; });
+      if (it == m_pools.end())
+         m_pools.push_back(std::move(pool));
+      else
+         it->m_blocks.insert(it->m_blocks.end() - 1, pool.m_blocks.begin(), pool.m_blocks.end());
+   }
+   m_nAllocations += other.m_nAllocations;
+   other.m_pools.clear();
+   other.m_nAllocations = 0;
+}
+
+size_t PhysicsArena::GetReservedSize() const
+{
+   size_t size = 0;
+   for (const Pool& pool : m_pools)
+      size += pool.m_blocks.size() * pool.m_blockSize;
+   return size;
+}
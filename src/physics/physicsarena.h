@@ -0,0 +1,51 @@
+#pragma once
+
+// Memory arena for the hit objects of a table
+//
+// Tables create from 50k up to 200k hit objects when starting to play. Instead of allocating each of them on the heap, they
+// are allocated (see HitObject::operator new) from the arena set as current for the allocating thread. Allocations are grouped
+// by size (so practically by hit object type), improving locality when scanning the hit objects of a collision tree node, and
+// the arena memory is released in one shot at the end of play.
+class PhysicsArena final
+{
+public:
+   PhysicsArena() = default;
+   ~PhysicsArena() { Release(); }
+   PhysicsArena(const PhysicsArena&) = delete;
+   PhysicsArena& operator=(const PhysicsArena&) = delete;
+
+   void* Allocate(const size_t size);
+   void Release(); // Objects allocated from the arena must have been destroyed before
+   void Merge(PhysicsArena& other); // Take ownership of the allocations of another arena
+
+   size_t GetAllocationCount() const { return m_nAllocations; }
+   size_t GetReservedSize() const;
+
+   // Arena used for hit object allocations of the calling thread (nullptr to use the heap)
+   static PhysicsArena* GetCurrent();
+   static void SetCurrent(PhysicsArena* const arena);
+
+   class Scope final
+   {
+   public:
+      Scope(PhysicsArena* const arena) : m_previous(GetCurrent()) { SetCurrent(arena); }
+      ~Scope() { SetCurrent(m_previous); }
+
+   private:
+      PhysicsArena* const m_previous;
+   };
+
+private:
+   static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+   struct Pool
+   {
+      size_t m_size; // Allocation size of this pool
+      vector<BYTE*> m_blocks;
+      size_t m_used; // Used bytes in the last block
+      size_t m_blockSize;
+   };
+
+   vector<Pool> m_pools;
+   size_t m_nAllocations = 0;
+};
@@ -346,27 +346,34 @@ void HitQuadtree::InitSseArrays()
 #ifndef USE_EMBREE
 void HitQuadtree::HitTestBall(const Ball * const pball, CollisionEvent& coll) const
 {
+   const BallSweep sweep(pball, coll.m_hittime);
+
 #ifdef QUADTREE_SSE_LEAFTEST
 
-   HitTestBallSse(pball, coll);
+   HitTestBallSse(pball, sweep, coll);
 
 #else                                   /// without SSE optimization ////////////////////////
 
+   HitTestBall(pball, sweep, coll);
+
+#endif
+}
+
+#ifndef QUADTREE_SSE_LEAFTEST
+void HitQuadtree::HitTestBall(const Ball * const pball, const BallSweep& sweep, CollisionEvent& coll) const
+{
 //
 // license:GPLv3+
 // Ported at: VisualPinball.Engine/Physics/HitQuadTree.cs
 //
 
-   const float rcHitRadiusSqr = pball->HitRadiusSqr();
-
    for (unsigned i=0; i<m_vho.size(); i++)
    {
 #ifdef DEBUGPHYSICS
       g_pplayer->c_tested++;
 #endif
       if ((pball != m_vho[i]) // ball can not hit itself
-         && fRectIntersect3D(pball->m_hitBBox, m_vho[i]->m_hitBBox)
-         && fRectIntersect3D(pball->m_d.m_pos, rcHitRadiusSqr, m_vho[i]->m_hitBBox))
+         && sweep.Intersect(m_vho[i]->m_hitBBox))
       {
          DoHitTest(pball, m_vho[i], coll);
       }
@@ -374,31 +381,31 @@ void HitQuadtree::HitTestBall(const Ball * const pball, CollisionEvent& coll) co
 
    if (!m_leaf)
    {
-      const bool left = (pball->m_hitBBox.left <= m_vcenter.x);
-      const bool right = (pball->m_hitBBox.right >= m_vcenter.x);
+      const bool left = (sweep.m_bbox.left <= m_vcenter.x);
+      const bool right = (sweep.m_bbox.right >= m_vcenter.x);
 
 #ifdef DEBUGPHYSICS
-      g_pplayer->c_tested++;
+      g_pplayer->c_traversed++;
 #endif
-      if (pball->m_hitBBox.top <= m_vcenter.y) // Top
+      if (sweep.m_bbox.top <= m_vcenter.y) // Top
       {
-         if (left)  m_children[0].HitTestBall(pball, coll);
-         if (right) m_children[1].HitTestBall(pball, coll);
+         if (left)  m_children[0].HitTestBall(pball, sweep, coll);
+         if (right) m_children[1].HitTestBall(pball, sweep, coll);
       }
-      if (pball->m_hitBBox.bottom >= m_vcenter.y) // Bottom
+      if (sweep.m_bbox.bottom >= m_vcenter.y) // Bottom
       {
-         if (left)  m_children[2].HitTestBall(pball, coll);
-         if (right) m_children[3].HitTestBall(pball, coll);
+         if (left)  m_children[2].HitTestBall(pball, sweep, coll);
+         if (right) m_children[3].HitTestBall(pball, sweep, coll);
       }
    }
-#endif
 //
 // end of license:GPLv3+, back to 'old MAME'-like
 //
 }
+#endif
 
 #ifdef QUADTREE_SSE_LEAFTEST
-void HitQuadtree::HitTestBallSse(const Ball * const pball, CollisionEvent& coll) const
+void HitQuadtree::HitTestBallSse(const Ball * const pball, const BallSweep& sweep, CollisionEvent& coll) const
 {
    const HitQuadtree* stack[128]; //!! should be enough, but better implement test in construction to not exceed this
    unsigned int stackpos = 0;
@@ -406,21 +413,10 @@ void HitQuadtree::HitTestBallSse(const Ball * const pball, CollisionEvent& coll)
 
    const HitQuadtree* __restrict current = this;
 
-   // init SSE registers with ball bbox
-   const __m128 bleft = _mm_set1_ps(pball->m_hitBBox.left);
-   const __m128 bright = _mm_set1_ps(pball->m_hitBBox.right);
-   const __m128 btop = _mm_set1_ps(pball->m_hitBBox.top);
-   const __m128 bbottom = _mm_set1_ps(pball->m_hitBBox.bottom);
-#ifndef DISABLE_ZTEST
-   const __m128 bzlow = _mm_set1_ps(pball->m_hitBBox.zlow);
-   const __m128 bzhigh = _mm_set1_ps(pball->m_hitBBox.zhigh);
-#endif
-   const __m128 posx = _mm_set1_ps(pball->m_d.m_pos.x);
-   const __m128 posy = _mm_set1_ps(pball->m_d.m_pos.y);
-#ifndef DISABLE_ZTEST
-   const __m128 posz = _mm_set1_ps(pball->m_d.m_pos.z);
+#ifdef DISABLE_ZTEST
+   const __m128 zlow = _mm_set1_ps(-FLT_MAX);
+   const __m128 zhigh = _mm_set1_ps(FLT_MAX);
 #endif
-   const __m128 rsqr = _mm_set1_ps(pball->HitRadiusSqr());
 
    const bool traversal_order = (rand_mt_01() < 0.5f); // swaps test order in leafs randomly
    const size_t dt = traversal_order ? 1 : -1;
@@ -453,50 +449,12 @@ void HitQuadtree::HitTestBallSse(const Ball * const pball, CollisionEvent& coll)
 #ifdef DEBUGPHYSICS
                g_pplayer->c_tested++; //!! +=4? or is this more fair?
 #endif
-               // comparisons set bits if bounds miss. if all bits are set, there is no collision. otherwise continue comparisons
-               // bits set, there is a bounding box collision
-               __m128 cmp = _mm_cmpge_ps(bright, p[i2]); // right vs left
-               int mask = _mm_movemask_ps(cmp);
-               if (mask == 0) continue;
-
-               cmp = _mm_cmple_ps(bleft, p[i2+1]); // left vs right
-               mask &= _mm_movemask_ps(cmp);
-               if (mask == 0) continue;
-
-               cmp = _mm_cmpge_ps(bbottom, p[i2+2]); // bottom vs top
-               mask &= _mm_movemask_ps(cmp);
-               if (mask == 0) continue;
-
-               cmp = _mm_cmple_ps(btop, p[i2+3]); // top vs bottom
-               mask &= _mm_movemask_ps(cmp);
-               if (mask == 0) continue;
-
-#ifndef DISABLE_ZTEST
-               cmp = _mm_cmpge_ps(bzhigh, p[i2+4]); // zhigh vs zlow
-               mask &= _mm_movemask_ps(cmp);
-               if (mask == 0) continue;
-
-               cmp = _mm_cmple_ps(bzlow, p[i2+5]); // zlow vs zhigh
-               mask &= _mm_movemask_ps(cmp);
-               if (mask == 0) continue;
-#endif
-               // test actual sphere against box(es)
-               const __m128 zero = _mm_setzero_ps();
-               __m128 ex = _mm_add_ps(_mm_max_ps(_mm_sub_ps(p[i2  ]/*left*/, posx), zero), _mm_max_ps(_mm_sub_ps(posx, p[i2+1]/*right */), zero));
-               __m128 ey = _mm_add_ps(_mm_max_ps(_mm_sub_ps(p[i2+2]/*top */, posy), zero), _mm_max_ps(_mm_sub_ps(posy, p[i2+3]/*bottom*/), zero));
-#ifndef DISABLE_ZTEST
-               __m128 ez = _mm_add_ps(_mm_max_ps(_mm_sub_ps(p[i2+4]/*zlow*/, posz), zero), _mm_max_ps(_mm_sub_ps(posz, p[i2+5]/*zhigh */), zero));
-#endif
-               ex = _mm_mul_ps(ex, ex);
-               ey = _mm_mul_ps(ey, ey);
+               // test swept ball against box(es)
 #ifndef DISABLE_ZTEST
-               ez = _mm_mul_ps(ez, ez);
-               const __m128 d = _mm_add_ps(_mm_add_ps(ex, ey), ez);
+               const int mask2 = sweep.Intersect4(p[i2], p[i2+1], p[i2+2], p[i2+3], p[i2+4], p[i2+5]);
 #else
-               const __m128 d = _mm_add_ps(ex, ey);
+               const int mask2 = sweep.Intersect4(p[i2], p[i2+1], p[i2+2], p[i2+3], zlow, zhigh);
 #endif
-               const __m128 cmp2 = _mm_cmple_ps(d, rsqr);
-               const int mask2 = _mm_movemask_ps(cmp2);
                if (mask2 == 0) continue;
 
                // now there is at least one bbox collision
@@ -520,15 +478,15 @@ void HitQuadtree::HitTestBallSse(const Ball * const pball, CollisionEvent& coll)
 #ifdef DEBUGPHYSICS
             g_pplayer->c_traversed++;
 #endif
-            const bool left = (pball->m_hitBBox.left <= current->m_vcenter.x);
-            const bool right = (pball->m_hitBBox.right >= current->m_vcenter.x);
+            const bool left = (sweep.m_bbox.left <= current->m_vcenter.x);
+            const bool right = (sweep.m_bbox.right >= current->m_vcenter.x);
 
-            if (pball->m_hitBBox.top <= current->m_vcenter.y) // Top
+            if (sweep.m_bbox.top <= current->m_vcenter.y) // Top
             {
                if (left)  stack[++stackpos] = current->m_children;
                if (right) stack[++stackpos] = current->m_children+1;
             }
-            if (pball->m_hitBBox.bottom >= current->m_vcenter.y) // Bottom
+            if (sweep.m_bbox.bottom >= current->m_vcenter.y) // Bottom
             {
                if (left)  stack[++stackpos] = current->m_children+2;
                if (right) stack[++stackpos] = current->m_children+3;
@@ -2,6 +2,8 @@
 
 #include "collide.h"
 
+class BallSweep;
+
 //#define DISABLE_ZTEST // z values of the BBox of (objects within) a node can be constant over some traversal levels (as its a quadtree and not an octree!), so we could also just ignore z tests overall. This can lead to performance benefits on some tables ("flat" ones) and performance penalties on others (e.g. when a ball moves under detailed meshes)
 
 //#define USE_EMBREE //!! experimental, but working, collision detection replacement for our quad and kd-tree //!! picking in debug mode so far not implemented though
@@ -47,7 +49,8 @@ private:
 
 #ifndef USE_EMBREE
    void CreateNextLevel(const FRect& bounds, const unsigned int level, unsigned int level_empty); // FRect3D for an octree
-   void HitTestBallSse(const Ball * const pball, CollisionEvent& coll) const;
+   void HitTestBall(const Ball * const pball, const BallSweep& sweep, CollisionEvent& coll) const;
+   void HitTestBallSse(const Ball * const pball, const BallSweep& sweep, CollisionEvent& coll) const;
 
    IFireEvents* __restrict m_unique; // everything below/including this node shares the same original primitive/hittarget object (just for early outs if not collidable),
                                      // so this is actually cast then to a Primitive* or HitTarget*
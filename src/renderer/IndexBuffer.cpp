@@ -26,6 +26,12 @@ void SharedIndexBuffer::Upload()
          delete[] upload.data;
       }
       m_pendingUploads.clear();
+      if (!m_isStatic)
+      {
+         m_shadow.resize(size);
+         memcpy(data, m_shadow.data(), size);
+         m_dirtySpans.clear();
+      }
 
       // Upload data block
       #if defined(ENABLE_SDL) // OpenGL && OpenGL ES
@@ -55,30 +61,29 @@ void SharedIndexBuffer::Upload()
    }
    else
    {
-      for (PendingUpload upload : m_pendingUploads)
+      // Only dynamic buffers can be modified after their initial upload, and only their modified spans are uploaded
+      assert(m_pendingUploads.empty());
+      for (const DirtySpan& span : m_dirtySpans)
       {
          #if defined(ENABLE_SDL) // OpenGL
          #ifndef __OPENGLES__
          if (GLAD_GL_VERSION_4_5)
-            glNamedBufferSubData(m_ib, upload.offset, upload.size, upload.data);
+            glNamedBufferSubData(m_ib, span.offset, span.size, m_shadow.data() + span.offset);
          else
          #endif
          {
             Bind();
-            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, upload.offset, upload.size, upload.data);
+            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, span.offset, span.size, m_shadow.data() + span.offset);
          }
-
          #else // DirectX 9
-         // It would be better to perform a single lock but in fact, I don't think there are situations where more than one update is pending
          UINT8* data;
-         CHECKD3D(m_ib->Lock(upload.offset, upload.size, (void**)&data, 0));
-         memcpy(data, upload.data, upload.size);
+         CHECKD3D(m_ib->Lock(span.offset, span.size, (void**)&data, 0));
+         memcpy(data, m_shadow.data() + span.offset, span.size);
          CHECKD3D(m_ib->Unlock());
-
          #endif
-         delete[] upload.data;
+         m_buffers[0]->m_rd->m_curBufferUploadBytes += span.size;
       }
-      m_pendingUploads.clear();
+      m_dirtySpans.clear();
    }
 }
 
@@ -192,25 +197,36 @@ void IndexBuffer::ApplyOffset(VertexBuffer* vb)
    const unsigned int offset = vb->GetVertexOffset();
    if (offset == 0)
       return;
-   for (SharedIndexBuffer::PendingUpload upload : m_sharedBuffer->m_pendingUploads)
+   if (!m_isStatic)
    {
+      // Dynamic buffers keep their data in the shared buffer CPU copy
+      assert(m_offset + m_size <= m_sharedBuffer->m_shadow.size());
+      void* data;
+      lock(0, 0, &data, 0);
+      memcpy(data, m_sharedBuffer->m_shadow.data() + m_offset, m_size);
+      ApplyOffset(data, m_size / m_sizePerIndex, offset);
+      unlock();
+      return;
+   }
+   for (SharedIndexBuffer::PendingUpload upload : m_sharedBuffer->m_pendingUploads)
       if (upload.buffer == this)
-      {
-         const unsigned int count = upload.size / m_sizePerIndex;
-         if (m_indexFormat == FMT_INDEX16)
-         {
-            U16* const __restrict indices = (U16*) upload.data;
-            for (unsigned int i = 0; i < count; i++)
-               indices[i] += offset;
-         }
-         else // FMT_INDEX32
-         {
-            assert(m_indexFormat == FMT_INDEX32);
-            U32* const __restrict indices = (U32*) upload.data;
-            for (unsigned int i = 0; i < count; i++)
-               indices[i] += offset;
-         }
-      }
+         ApplyOffset(upload.data, upload.size / m_sizePerIndex, offset);
+}
+
+void IndexBuffer::ApplyOffset(void* data, const unsigned int count, const unsigned int offset) const
+{
+   if (m_indexFormat == FMT_INDEX16)
+   {
+      U16* const __restrict indices = (U16*)data;
+      for (unsigned int i = 0; i < count; i++)
+         indices[i] += offset;
+   }
+   else // FMT_INDEX32
+   {
+      assert(m_indexFormat == FMT_INDEX32);
+      U32* const __restrict indices = (U32*)data;
+      for (unsigned int i = 0; i < count; i++)
+         indices[i] += offset;
    }
 }
 
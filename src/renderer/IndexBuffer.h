@@ -36,14 +36,27 @@ public:
       m_lock.buffer = buffer;
       m_lock.offset = offsetToLock;
       m_lock.size = sizeToLock;
-      m_lock.data = new BYTE[m_lock.size];
+      if (m_isStatic)
+         m_lock.data = new BYTE[m_lock.size];
+      else
+      {
+         // Dynamic buffers are locked through a reusable scratch block, which is compared to the CPU copy of the buffer on unlock
+         if (m_lockScratch.size() < m_lock.size)
+            m_lockScratch.resize(m_lock.size);
+         m_lock.data = m_lockScratch.data();
+      }
       *dataBuffer = m_lock.data;
    }
 
    void Unlock()
    {
-      PendingUpload upload = m_lock;
-      m_pendingUploads.push_back(upload);
+      if (m_isStatic)
+      {
+         m_pendingUploads.push_back(m_lock);
+         m_revision++;
+      }
+      else
+         UpdateShadow(m_lock.offset, m_lock.size, m_lock.data);
       m_lock.data = nullptr;
    }
 
@@ -64,8 +77,67 @@ public:
    };
    vector<PendingUpload> m_pendingUploads;
 
+   // Dirty spans of a dynamic buffer (sorted, non overlapping byte ranges of the CPU copy that needs to be uploaded)
+   struct DirtySpan
+   {
+      unsigned int offset;
+      unsigned int size;
+   };
+   vector<DirtySpan> m_dirtySpans;
+   vector<BYTE> m_shadow; // CPU copy of dynamic buffers content
+   unsigned int m_revision = 0; // Incremented each time the buffer content is modified
+
 protected:
+   // Update the CPU copy of a dynamic buffer, only marking as dirty the elements that were actually modified.
+   // Most dynamic parts rewrite their whole buffer while only a few vertices (or none) changed since last update.
+   void UpdateShadow(const unsigned int offset, const unsigned int size, const BYTE* const data)
+   {
+      if (m_shadow.size() < (size_t)m_count * m_bytePerElement)
+         m_shadow.resize((size_t)m_count * m_bytePerElement);
+      assert(offset + size <= m_shadow.size());
+      // Small gaps between modified elements are uploaded with them since a few more bytes are cheaper than another upload call
+      const unsigned int maxGap = 16 * m_bytePerElement;
+      unsigned int spanStart = 0, spanEnd = 0;
+      bool inSpan = false;
+      for (unsigned int pos = 0; pos < size; pos += m_bytePerElement)
+      {
+         const unsigned int len = min(m_bytePerElement, size - pos);
+         if (memcmp(m_shadow.data() + offset + pos, data + pos, len) == 0)
+            continue;
+         memcpy(m_shadow.data() + offset + pos, data + pos, len);
+         if (inSpan && pos - spanEnd > maxGap)
+         {
+            AddDirtySpan(offset + spanStart, spanEnd - spanStart);
+            inSpan = false;
+         }
+         if (!inSpan)
+            spanStart = pos;
+         spanEnd = pos + len;
+         inSpan = true;
+      }
+      if (inSpan)
+         AddDirtySpan(offset + spanStart, spanEnd - spanStart);
+   }
+
+   void AddDirtySpan(const unsigned int offset, const unsigned int size)
+   {
+      // Insert sorted, merging with overlapping or contiguous spans
+      unsigned int start = offset, end = offset + size;
+      typename vector<DirtySpan>::iterator it = m_dirtySpans.begin();
+      while (it != m_dirtySpans.end() && it->offset + it->size < start)
+         ++it;
+      while (it != m_dirtySpans.end() && it->offset <= end)
+      {
+         start = min(start, it->offset);
+         end = max(end, it->offset + it->size);
+         it = m_dirtySpans.erase(it);
+      }
+      m_dirtySpans.insert(it, DirtySpan { start, end - start });
+      m_revision++;
+   }
+
    PendingUpload m_lock = { nullptr, 0, 0, nullptr };
+   vector<BYTE> m_lockScratch;
    vector<Buf*> m_buffers;
    unsigned int m_count = 0;
 };
@@ -125,7 +197,11 @@ public:
    IDirect3DIndexBuffer9* GetBuffer() const;
    #endif
 
+   SharedIndexBuffer* GetSharedBuffer() const { return m_sharedBuffer; }
+
 private:
+   void ApplyOffset(void* data, const unsigned int count, const unsigned int offset) const;
+
    unsigned int m_offset = 0; // Offset in bytes of the data inside the native GPU array
    unsigned int m_indexOffset = 0; // Offset in indices of the data inside the native GPU array
    SharedIndexBuffer* m_sharedBuffer = nullptr;
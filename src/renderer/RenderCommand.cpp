@@ -21,6 +21,116 @@ bool RenderCommand::IsFullClear(const bool hasDepth) const
       return false;
 }
 
+unsigned int RenderCommand::GetPrimitiveCount() const
+{
+   switch (m_primitiveType)
+   {
+   case RenderDevice::POINTLIST: return m_indicesCount;
+   case RenderDevice::LINELIST: return m_indicesCount / 2;
+   case RenderDevice::LINESTRIP: return std::max(0u, m_indicesCount - 1);
+   case RenderDevice::TRIANGLELIST: return m_indicesCount / 3;
+   case RenderDevice::TRIANGLESTRIP:
+   case RenderDevice::TRIANGLEFAN: return std::max(0u, m_indicesCount - 2);
+   default: assert(false); return 0;
+   }
+}
+
+void RenderCommand::DrawMesh(const int instanceCount)
+{
+   if (m_mb->m_ib == nullptr)
+   {
+      #ifdef ENABLE_SDL
+      assert(0 <= m_mb->m_vb->GetVertexOffset() && m_mb->m_vb->GetVertexOffset() + m_indicesCount <= m_mb->m_vb->GetSharedBuffer()->GetCount());
+      if (instanceCount > 1)
+         glDrawArraysInstanced(m_primitiveType, m_mb->m_vb->GetVertexOffset() + m_startIndex, m_indicesCount, instanceCount);
+      else
+         glDrawArrays(m_primitiveType, m_mb->m_vb->GetVertexOffset() + m_startIndex, m_indicesCount);
+      #else
+      CHECKD3D(m_rd->GetCoreDevice()->DrawPrimitive((D3DPRIMITIVETYPE)m_primitiveType, m_mb->m_vb->GetVertexOffset() + m_startIndex, GetPrimitiveCount()));
+      #endif
+   }
+   else
+   {
+      const int vertexOffset = m_mb->m_isVBOffsetApplied ? 0 : m_mb->m_vb->GetOffset();
+      #ifdef ENABLE_SDL
+      const int indexOffset = m_mb->m_ib->GetOffset() + m_startIndex * m_mb->m_ib->m_sizePerIndex;
+      const GLenum indexType = m_mb->m_ib->m_indexFormat == IndexBuffer::FMT_INDEX16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+      #if defined(DEBUG) && 0
+      // Track invalid vertex memory reference. Very slow, only for debugging memory access exception in OpenGL
+      BYTE* tmp = new BYTE[m_indicesCount * m_mb->m_ib->m_sizePerIndex];
+      U16* tmp16 = (U16*)tmp;
+      U32* tmp32 = (U32*)tmp;
+      glGetNamedBufferSubData(m_mb->m_ib->GetBuffer(), indexOffset, m_indicesCount * m_mb->m_ib->m_sizePerIndex, tmp);
+      assert(m_mb->m_vb->GetVertexOffset() + m_mb->m_vb->m_count <= m_mb->m_vb->GetSharedBuffer()->GetCount());
+      for (unsigned int i = 0; i < m_indicesCount; i++)
+      {
+         unsigned int idx = m_mb->m_ib->m_indexFormat == IndexBuffer::FMT_INDEX16 ? tmp16[i] : tmp32[i];
+         assert((m_mb->m_vb->GetVertexOffset() <= vertexOffset + idx) && (vertexOffset + idx <= m_mb->m_vb->GetVertexOffset() + m_mb->m_vb->m_count));
+      }
+      delete[] tmp;
+      #endif
+      if (vertexOffset == 0)
+      {
+         if (instanceCount > 1)
+            glDrawElementsInstanced(m_primitiveType, m_indicesCount, indexType, (void*)(intptr_t)indexOffset, instanceCount);
+         else
+            glDrawRangeElements(m_primitiveType, 
+               m_mb->m_vb->GetVertexOffset(), m_mb->m_vb->GetVertexOffset() + m_mb->m_vb->m_count, 
+               m_indicesCount, indexType, (void*)(intptr_t)indexOffset);
+      }
+      else
+      {
+         #if defined(__OPENGLES__)
+         assert(false); // OpenGL ES does not support offseted vertices. The buffers must be built accordingly
+         #else
+         if (instanceCount > 1)
+            glDrawElementsInstancedBaseVertex(m_primitiveType, m_indicesCount, indexType, (void*)(intptr_t)indexOffset, vertexOffset, instanceCount);
+         else
+            glDrawRangeElementsBaseVertex(m_primitiveType, 
+               m_mb->m_vb->GetVertexOffset(), m_mb->m_vb->GetVertexOffset() + m_mb->m_vb->m_count, 
+               m_indicesCount, indexType, (void*)(intptr_t)indexOffset, vertexOffset);
+         #endif
+      }
+      #else
+      CHECKD3D(m_rd->GetCoreDevice()->DrawIndexedPrimitive((D3DPRIMITIVETYPE)m_primitiveType, 
+         vertexOffset, 0, m_mb->m_vb->m_count, m_mb->m_ib->GetIndexOffset() + m_startIndex, GetPrimitiveCount()));
+      #endif
+   }
+}
+
+void RenderCommand::Dump(std::ostream& out) const
+{
+   switch (m_command)
+   {
+   case RC_CLEAR:
+      out << "Clear          Flags: " << std::hex << m_clearFlags << " Color: " << std::setw(8) << std::setfill('0') << m_clearARGB << std::setfill(' ') << std::dec;
+      break;
+   case RC_COPY:
+      out << "Copy           " << m_copyFrom->m_name << " => " << m_copyTo->m_name << (m_copyColor ? " Color" : "") << (m_copyDepth ? " Depth" : "");
+      if (m_copySrcLayer >= 0 || m_copyDstLayer >= 0)
+         out << " Layers: " << m_copySrcLayer << " => " << m_copyDstLayer;
+      break;
+   case RC_SUBMIT_VR: out << "Submit VR      " << m_copyFrom->m_name; break;
+   case RC_DRAW_LIVEUI: out << "Draw LiveUI"; break;
+   case RC_DRAW_LIVEUI_L: out << "Draw LiveUI L"; break;
+   case RC_DRAW_LIVEUI_R: out << "Draw LiveUI R"; break;
+   case RC_DRAW_QUAD_PT:
+   case RC_DRAW_QUAD_PNT:
+   case RC_DRAW_MESH:
+      out << (m_command == RC_DRAW_QUAD_PT ? "Draw Quad PT   " : m_command == RC_DRAW_QUAD_PNT ? "Draw Quad PNT  " : "Draw Mesh      ");
+      out << (m_isTransparent ? "T " : "O ");
+      out << std::setw(40) << Shader::GetTechniqueName(m_shaderTechnique) << std::setw(0) << " " << m_renderState.GetLog();
+      out << " Depth: " << std::fixed << std::setw(8) << std::setprecision(2) << m_depth;
+      if (m_command == RC_DRAW_MESH)
+      {
+         out << " MB:" << std::setw(4) << std::hex << m_mb->GetSortKey() << std::dec;
+         out << " Start: " << std::setw(8) << m_startIndex << " IndCount: " << std::setw(8) << m_indicesCount << " " << m_mb->m_name;
+      }
+      m_shader->DumpState(m_shaderState, out);
+      break;
+   }
+}
+
 void RenderCommand::Execute(const int nInstances, const bool log)
 {
    switch (m_command)
@@ -221,80 +331,9 @@ void RenderCommand::Execute(const int nInstances, const bool log)
 
       case RC_DRAW_MESH:
       {
-         unsigned int np; 
-         switch (m_primitiveType)
-         {
-         case RenderDevice::POINTLIST: np = m_indicesCount; break;
-         case RenderDevice::LINELIST: np = m_indicesCount / 2; break;
-         case RenderDevice::LINESTRIP: np = std::max(0u, m_indicesCount - 1); break;
-         case RenderDevice::TRIANGLELIST: np = m_indicesCount / 3; break;
-         case RenderDevice::TRIANGLESTRIP:
-         case RenderDevice::TRIANGLEFAN: np = std::max(0u, m_indicesCount - 2); break;
-         default: assert(false);
-         }
-         m_rd->m_curDrawnTriangles += np;
-
+         m_rd->m_curDrawnTriangles += GetPrimitiveCount();
          m_mb->bind();
-
-         if (m_mb->m_ib == nullptr)
-         {
-            #ifdef ENABLE_SDL
-            assert(0 <= m_mb->m_vb->GetVertexOffset() && m_mb->m_vb->GetVertexOffset() + m_indicesCount <= m_mb->m_vb->GetSharedBuffer()->GetCount());
-            if (instanceCount > 1)
-               glDrawArraysInstanced(m_primitiveType, m_mb->m_vb->GetVertexOffset() + m_startIndex, m_indicesCount, instanceCount);
-            else
-               glDrawArrays(m_primitiveType, m_mb->m_vb->GetVertexOffset() + m_startIndex, m_indicesCount);
-            #else
-            CHECKD3D(m_rd->GetCoreDevice()->DrawPrimitive((D3DPRIMITIVETYPE)m_primitiveType, m_mb->m_vb->GetVertexOffset() + m_startIndex, np));
-            #endif
-         }
-         else
-         {
-            const int vertexOffset = m_mb->m_isVBOffsetApplied ? 0 : m_mb->m_vb->GetOffset();
-            #ifdef ENABLE_SDL
-            const int indexOffset = m_mb->m_ib->GetOffset() + m_startIndex * m_mb->m_ib->m_sizePerIndex;
-            const GLenum indexType = m_mb->m_ib->m_indexFormat == IndexBuffer::FMT_INDEX16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
-            #if defined(DEBUG) && 0
-            // Track invalid vertex memory reference. Very slow, only for debugging memory access exception in OpenGL
-            BYTE* tmp = new BYTE[m_indicesCount * m_mb->m_ib->m_sizePerIndex];
-            U16* tmp16 = (U16*)tmp;
-            U32* tmp32 = (U32*)tmp;
-            glGetNamedBufferSubData(m_mb->m_ib->GetBuffer(), indexOffset, m_indicesCount * m_mb->m_ib->m_sizePerIndex, tmp);
-            assert(m_mb->m_vb->GetVertexOffset() + m_mb->m_vb->m_count <= m_mb->m_vb->GetSharedBuffer()->GetCount());
-            for (unsigned int i = 0; i < m_indicesCount; i++)
-            {
-               unsigned int idx = m_mb->m_ib->m_indexFormat == IndexBuffer::FMT_INDEX16 ? tmp16[i] : tmp32[i];
-               assert((m_mb->m_vb->GetVertexOffset() <= vertexOffset + idx) && (vertexOffset + idx <= m_mb->m_vb->GetVertexOffset() + m_mb->m_vb->m_count));
-            }
-            delete[] tmp;
-            #endif
-            if (vertexOffset == 0)
-            {
-               if (instanceCount > 1)
-                  glDrawElementsInstanced(m_primitiveType, m_indicesCount, indexType, (void*)(intptr_t)indexOffset, instanceCount);
-               else
-                  glDrawRangeElements(m_primitiveType, 
-                     m_mb->m_vb->GetVertexOffset(), m_mb->m_vb->GetVertexOffset() + m_mb->m_vb->m_count, 
-                     m_indicesCount, indexType, (void*)(intptr_t)indexOffset);
-            }
-            else
-            {
-               #if defined(__OPENGLES__)
-               assert(false); // OpenGL ES does not support offseted vertices. The buffers must be built accordingly
-               #else
-               if (instanceCount > 1)
-                  glDrawElementsInstancedBaseVertex(m_primitiveType, m_indicesCount, indexType, (void*)(intptr_t)indexOffset, vertexOffset, instanceCount);
-               else
-                  glDrawRangeElementsBaseVertex(m_primitiveType, 
-                     m_mb->m_vb->GetVertexOffset(), m_mb->m_vb->GetVertexOffset() + m_mb->m_vb->m_count, 
-                     m_indicesCount, indexType, (void*)(intptr_t)indexOffset, vertexOffset);
-               #endif
-            }
-            #else
-            CHECKD3D(m_rd->GetCoreDevice()->DrawIndexedPrimitive((D3DPRIMITIVETYPE)m_primitiveType, 
-               vertexOffset, 0, m_mb->m_vb->m_count, m_mb->m_ib->GetIndexOffset() + m_startIndex, np));
-            #endif
-         }
+         DrawMesh(instanceCount);
          break;
       }
       }
@@ -325,6 +364,164 @@ void RenderCommand::Execute(const int nInstances, const bool log)
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Batching of draw mesh commands
+//
+//  Parts built from the same builtin mesh (bumpers, kickers, gates, targets,
+//  bulbs,...) bake their transform into their own vertices, but static and
+//  dynamic buffers are allocated inside a few shared GPU buffers. Consecutive
+//  draws that only differ by their vertex/index range can therefore be
+//  submitted at once, applying render & shader states a single time, and
+//  issuing a single multi draw call on OpenGL.
+
+bool RenderCommand::IsBatchableWith(const RenderCommand* other) const
+{
+   if (m_command != RC_DRAW_MESH || other->m_command != RC_DRAW_MESH || other->m_dependency != nullptr)
+      return false;
+   if (m_shader != other->m_shader || m_shaderTechnique != other->m_shaderTechnique || m_primitiveType != other->m_primitiveType)
+      return false;
+   if (m_mb->m_ib == nullptr || other->m_mb->m_ib == nullptr)
+      return false;
+   if (m_mb->m_vb->GetSharedBuffer() != other->m_mb->m_vb->GetSharedBuffer() || m_mb->m_ib->GetSharedBuffer() != other->m_mb->m_ib->GetSharedBuffer())
+      return false;
+   if (m_renderState.m_state != other->m_renderState.m_state || m_renderState.m_depthBias != other->m_renderState.m_depthBias)
+      return false;
+   return memcmp(m_shaderState->m_state, other->m_shaderState->m_state, m_shader->GetStateSize()) == 0;
+}
+
+void RenderCommand::ExecuteBatch(RenderCommand* const* batch, const unsigned int batchSize, const int nInstances, const bool log)
+{
+   assert(batchSize > 0 && batch[0] == this);
+   m_renderState.Apply(m_rd);
+   m_shader->SetTechnique(m_shaderTechnique);
+   m_shader->m_state->CopyTo(false, m_shaderState, m_shaderTechnique);
+   m_shader->Begin();
+   // All commands share the same native buffers, so binding the first one also uploads pending updates of the others
+   m_mb->bind();
+   for (unsigned int i = 0; i < batchSize; i++)
+      m_rd->m_curDrawnTriangles += batch[i]->GetPrimitiveCount();
+
+   #if defined(ENABLE_SDL) && !defined(__OPENGLES__)
+   if (nInstances == 1)
+   {
+      const GLenum indexType = m_mb->m_ib->m_indexFormat == IndexBuffer::FMT_INDEX16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+      m_rd->m_batchCounts.resize(batchSize);
+      m_rd->m_batchIndexOffsets.resize(batchSize);
+      m_rd->m_batchVertexOffsets.resize(batchSize);
+      for (unsigned int i = 0; i < batchSize; i++)
+      {
+         const MeshBuffer* const mb = batch[i]->m_mb;
+         m_rd->m_batchCounts[i] = (GLsizei)batch[i]->m_indicesCount;
+         m_rd->m_batchIndexOffsets[i] = (void*)(intptr_t)(mb->m_ib->GetOffset() + batch[i]->m_startIndex * mb->m_ib->m_sizePerIndex);
+         m_rd->m_batchVertexOffsets[i] = mb->m_isVBOffsetApplied ? 0 : (GLint)mb->m_vb->GetOffset();
+      }
+      glMultiDrawElementsBaseVertex(m_primitiveType, m_rd->m_batchCounts.data(), indexType, m_rd->m_batchIndexOffsets.data(), (GLsizei)batchSize, m_rd->m_batchVertexOffsets.data());
+      m_rd->m_curDrawCalls++;
+   }
+   else
+   #endif
+   {
+      // No multi draw support: still save the state changes between draws
+      for (unsigned int i = 0; i < batchSize; i++)
+         batch[i]->DrawMesh(nInstances);
+      m_rd->m_curDrawCalls += batchSize;
+   }
+   m_rd->m_curBatchedDrawCalls += batchSize - 1;
+   m_shader->End();
+
+   if (log)
+   {
+      std::stringstream ss;
+      ss << "> Draw Batch    " << (m_isTransparent ? "T "s : "O "s);
+      ss << std::setw(40) << Shader::GetTechniqueName(m_shaderTechnique) << std::setw(0) << " " << m_renderState.GetLog();
+      ss << " Depth: " << std::fixed << std::setw(8) << std::setprecision(2) << m_depth;
+      ss << " MB:" << std::setw(4) << std::hex << m_mb->GetSortKey() << std::dec;
+      ss << " Batch: " << std::setw(4) << batchSize << " draws";
+      for (unsigned int i = 0; i < batchSize; i++)
+         ss << (i == 0 ? " " : ", ") << batch[i]->m_mb->m_name;
+      PLOGI << ss.str();
+   }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Content hash
+//
+//  Identifies the output of a command from its inputs (states, buffers with
+//  their content revision, textures with their content revision) to allow
+//  skipping renders that would give the same result as the previous one.
+
+static inline U64 HashBytes(U64 hash, const void* data, const size_t size)
+{
+   const BYTE* bytes = (const BYTE*)data;
+   for (size_t i = 0; i < size; i++)
+      hash = (hash ^ bytes[i]) * 1099511628211ull; // FNV-1a
+   return hash;
+}
+
+template <class T> static inline U64 HashValue(const U64 hash, const T& value) { return HashBytes(hash, &value, sizeof(T)); }
+
+U64 RenderCommand::GetContentHash(U64 hash) const
+{
+   hash = HashValue(hash, m_command);
+   switch (m_command)
+   {
+   case RC_CLEAR:
+      hash = HashValue(hash, m_clearFlags);
+      hash = HashValue(hash, m_clearARGB);
+      break;
+
+   case RC_COPY:
+      hash = HashValue(hash, m_copyFrom);
+      hash = HashValue(hash, m_copyTo);
+      hash = HashValue(hash, m_copyColor);
+      hash = HashValue(hash, m_copyDepth);
+      hash = HashValue(hash, m_copySrcRect);
+      hash = HashValue(hash, m_copyDstRect);
+      hash = HashValue(hash, m_copySrcLayer);
+      hash = HashValue(hash, m_copyDstLayer);
+      if (m_copyFrom->GetColorSampler())
+         hash = HashValue(hash, m_copyFrom->GetColorSampler()->m_contentRevision);
+      if (m_copyFrom->GetDepthSampler())
+         hash = HashValue(hash, m_copyFrom->GetDepthSampler()->m_contentRevision);
+      break;
+
+   case RC_DRAW_MESH:
+   case RC_DRAW_QUAD_PT:
+   case RC_DRAW_QUAD_PNT:
+      hash = HashValue(hash, m_renderState.m_state);
+      hash = HashValue(hash, m_renderState.m_depthBias);
+      hash = HashValue(hash, m_shader);
+      hash = HashValue(hash, m_shaderTechnique);
+      hash = HashBytes(hash, m_shaderState->m_state, m_shader->GetStateSize());
+      hash = HashValue(hash, m_shader->GetTexturesRevision(m_shaderState));
+      if (m_command == RC_DRAW_MESH)
+      {
+         hash = HashValue(hash, m_mb);
+         hash = HashValue(hash, m_primitiveType);
+         hash = HashValue(hash, m_startIndex);
+         hash = HashValue(hash, m_indicesCount);
+         if (m_mb->m_vb->GetSharedBuffer())
+            hash = HashValue(hash, m_mb->m_vb->GetSharedBuffer()->m_revision);
+         if (m_mb->m_ib && m_mb->m_ib->GetSharedBuffer())
+            hash = HashValue(hash, m_mb->m_ib->GetSharedBuffer()->m_revision);
+      }
+      else
+         hash = HashBytes(hash, m_vertices, m_command == RC_DRAW_QUAD_PT ? 4 * sizeof(Vertex3D_TexelOnly) : 4 * sizeof(Vertex3D_NoTex2));
+      break;
+
+   default:
+      // Other commands (LiveUI, VR submission) are never considered as unchanged
+      static size_t uniqueCounter = 0;
+      hash = HashValue(hash, ++uniqueCounter);
+      break;
+   }
+   return hash;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 //  Default build from live render device state
@@ -18,6 +18,7 @@ public:
    bool IsDrawCommand() const { return m_command == RC_DRAW_MESH || m_command == RC_DRAW_QUAD_PT || m_command == RC_DRAW_QUAD_PNT || m_command == RC_DRAW_LIVEUI; }
    bool IsDrawMeshCommand() const { return m_command == RC_DRAW_MESH; }
    bool IsDrawLiveUICommand() const { return m_command == RC_DRAW_LIVEUI; }
+   bool IsSubmitVRCommand() const { return m_command == RC_SUBMIT_VR; }
    inline RenderState GetRenderState() const { return m_renderState; }
    inline Shader::ShaderState* GetShaderState() const { return m_shaderState; }
    inline ShaderTechniques GetShaderTechnique() const { return m_shaderTechnique; }
@@ -28,6 +29,16 @@ public:
 
    void Execute(const int nInstances, const bool log);
 
+   // Batching of consecutive draw mesh commands sharing the same states and buffers
+   bool IsBatchableWith(const RenderCommand* other) const;
+   void ExecuteBatch(RenderCommand* const* batch, const unsigned int batchSize, const int nInstances, const bool log);
+
+   // Hash of the command inputs, used to detect renders that are unchanged since their last execution
+   U64 GetContentHash(U64 hash) const;
+
+   // Write a single line description of the command (used for frame captures)
+   void Dump(std::ostream& out) const;
+
    // Build from render device live state
    void SetClear(DWORD clearFlags, DWORD clearARGB);
    void SetCopy(RenderTarget* from, RenderTarget* to, bool color, bool depth,  
@@ -43,6 +54,9 @@ public:
    RenderPass* m_dependency;
 
 private:
+   unsigned int GetPrimitiveCount() const;
+   void DrawMesh(const int instanceCount);
+
    enum Command
    {
       RC_CLEAR,
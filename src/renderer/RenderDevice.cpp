@@ -1389,10 +1389,13 @@ RenderDevice::~RenderDevice()
    assert(m_pendingSharedVertexBuffers.empty());
 }
 
-/*static void FlushGPUCommandBuffer(IDirect3DDevice9* pd3dDevice)
+void RenderDevice::FlushGPUCommandBuffer()
 {
+#ifdef ENABLE_SDL
+   glFinish();
+#else
    IDirect3DQuery9* pEventQuery;
-   pd3dDevice->CreateQuery(D3DQUERYTYPE_EVENT, &pEventQuery);
+   m_pD3DDevice->CreateQuery(D3DQUERYTYPE_EVENT, &pEventQuery);
 
    if (pEventQuery)
    {
@@ -1401,7 +1404,8 @@ RenderDevice::~RenderDevice()
          ;
       SAFE_RELEASE(pEventQuery);
    }
-}*/
+#endif
+}
 
 bool RenderDevice::SetMaximumPreRenderedFrames(const DWORD frames)
 {
@@ -1472,6 +1476,8 @@ void RenderDevice::Flip()
    // reset performance counters
    m_frameDrawCalls = m_curDrawCalls;
    m_curDrawCalls = 0;
+   m_frameBatchedDrawCalls = m_curBatchedDrawCalls;
+   m_curBatchedDrawCalls = 0;
    m_frameStateChanges = m_curStateChanges;
    m_curStateChanges = 0;
    m_frameTextureChanges = m_curTextureChanges;
@@ -1486,6 +1492,10 @@ void RenderDevice::Flip()
    m_curTextureUpdates = 0;
    m_frameLockCalls = m_curLockCalls;
    m_curLockCalls = 0;
+   m_frameBufferUploadBytes = m_curBufferUploadBytes;
+   m_curBufferUploadBytes = 0;
+   m_frameCulledParts = m_curCulledParts;
+   m_curCulledParts = 0;
 }
 
 void RenderDevice::UploadAndSetSMAATextures()
@@ -1795,6 +1805,10 @@ void RenderDevice::SetRenderTarget(const string& name, RenderTarget* rt, const b
          m_currentPass->AddPrecursor(rt->m_lastRenderPass);
       }
       rt->m_lastRenderPass = m_currentPass;
+      if (rt->GetColorSampler())
+         rt->GetColorSampler()->m_contentRevision++;
+      if (rt->GetDepthSampler())
+         rt->GetDepthSampler()->m_contentRevision++;
    }
 }
 
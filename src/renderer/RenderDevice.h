@@ -134,6 +134,9 @@ public:
    bool LoadShaders();
 
    RenderPass* GetCurrentPass() { return m_currentPass; }
+   // Change tracking of recorded commands, allowing to skip renders that are unchanged since their last execution
+   unsigned int GetRenderCommandsMark() const { return m_renderFrame.GetPassCount(); }
+   U64 GetRenderCommandsHash(const unsigned int mark) const { return m_renderFrame.GetContentHash(mark); }
    const RenderTarget* GetCurrentRenderTarget() const { assert(m_currentPass != nullptr); return m_currentPass->m_rt; }
    void SetRenderTarget(const string& passName, RenderTarget* rt, const bool useRTContent = true, const bool forceNewPass = false);
    void AddRenderTargetDependency(RenderTarget* rt, const bool needDepth = false);
@@ -153,6 +156,8 @@ public:
    void DrawGaussianBlur(RenderTarget* source, RenderTarget* tmp, RenderTarget* dest, float kernel_size, int singleLayer = -1);
    void LogNextFrame() { m_logNextFrame = true; }
    bool IsLogNextFrame() const { return m_logNextFrame; }
+   void CaptureNextFrame(const string& path, const unsigned int nReplays) { m_renderFrame.CaptureNextFrame(path, nReplays); }
+   void FlushGPUCommandBuffer(); // Wait for the GPU to have processed all submitted commands
    void FlushRenderFrame();
    void Flip();
    void WaitForVSync(const bool asynchronous);
@@ -245,12 +250,15 @@ public:
 
    // performance counters
    unsigned int Perf_GetNumDrawCalls() const        { return m_frameDrawCalls; }
+   unsigned int Perf_GetNumBatchedDrawCalls() const { return m_frameBatchedDrawCalls; }
    unsigned int Perf_GetNumStateChanges() const     { return m_frameStateChanges; }
    unsigned int Perf_GetNumTextureChanges() const   { return m_frameTextureChanges; }
    unsigned int Perf_GetNumParameterChanges() const { return m_frameParameterChanges; }
    unsigned int Perf_GetNumTechniqueChanges() const { return m_frameTechniqueChanges; }
    unsigned int Perf_GetNumTextureUploads() const   { return m_frameTextureUpdates; }
    unsigned int Perf_GetNumLockCalls() const        { return m_frameLockCalls; }
+   unsigned int Perf_GetBufferUploadBytes() const   { return m_frameBufferUploadBytes; }
+   unsigned int Perf_GetNumCulledParts() const      { return m_frameCulledParts; }
 
    void FreeShader();
 
@@ -354,12 +362,15 @@ public:
 
    // performance counters
    unsigned int m_curDrawCalls = 0, m_frameDrawCalls = 0;
+   unsigned int m_curBatchedDrawCalls = 0, m_frameBatchedDrawCalls = 0;
    unsigned int m_curStateChanges = 0, m_frameStateChanges = 0;
    unsigned int m_curTextureChanges = 0, m_frameTextureChanges = 0;
    unsigned int m_curParameterChanges = 0, m_frameParameterChanges = 0;
    unsigned int m_curTechniqueChanges = 0, m_frameTechniqueChanges = 0;
    unsigned int m_curTextureUpdates = 0, m_frameTextureUpdates = 0;
    unsigned int m_curLockCalls = 0, m_frameLockCalls = 0;
+   unsigned int m_curBufferUploadBytes = 0, m_frameBufferUploadBytes = 0;
+   unsigned int m_curCulledParts = 0, m_frameCulledParts = 0;
    unsigned int m_curDrawnTriangles = 0, m_frameDrawnTriangles = 0;
 
    Shader *basicShader = nullptr;
@@ -383,6 +394,10 @@ public:
 #if defined(ENABLE_SDL) // OpenGL
    std::vector<SamplerBinding*> m_samplerBindings;
    GLuint m_curVAO = 0;
+   // Scratch buffers used to submit batched draw commands as a single multi draw call
+   vector<GLsizei> m_batchCounts;
+   vector<void*> m_batchIndexOffsets;
+   vector<GLint> m_batchVertexOffsets;
    
 #else // DirectX9
    IDirect3DVertexBuffer9* m_curVertexBuffer = nullptr;
@@ -40,6 +40,129 @@ RenderPass* RenderFrame::AddPass(const string& name, RenderTarget* const rt)
    return pass;
 }
 
+U64 RenderFrame::GetContentHash(const unsigned int firstPass) const
+{
+   U64 hash = 14695981039346656037ull;
+   for (size_t i = firstPass; i < m_passes.size(); i++)
+   {
+      hash = (hash ^ (U64)reinterpret_cast<uintptr_t>(m_passes[i]->m_rt)) * 1099511628211ull;
+      for (const RenderCommand* cmd : m_passes[i]->m_commands)
+         hash = cmd->GetContentHash(hash);
+   }
+   return hash;
+}
+
+void RenderFrame::Capture(const vector<RenderPass*>& sortedPasses)
+{
+   std::ofstream out(m_capturePath);
+   if (!out.is_open())
+   {
+      PLOGE << "Failed to create frame capture file: " << m_capturePath;
+      return;
+   }
+   PLOGI << "Capturing frame to " << m_capturePath << " (" << m_captureReplays << " replays)";
+
+   // Replaying modifies the performance counters of the captured frame, so save them to restore them afterward
+   const unsigned int counters[] = { m_rd->m_curDrawCalls, m_rd->m_curBatchedDrawCalls, m_rd->m_curStateChanges, m_rd->m_curTextureChanges,
+      m_rd->m_curParameterChanges, m_rd->m_curTechniqueChanges, m_rd->m_curDrawnTriangles };
+
+   // VR submission must not be performed more than once per frame, so passes that perform it are not replayed
+   const size_t nPasses = sortedPasses.size();
+   vector<bool> replayable(nPasses);
+   for (size_t i = 0; i < nPasses; i++)
+      replayable[i] = std::none_of(sortedPasses[i]->m_commands.begin(), sortedPasses[i]->m_commands.end(), [](const RenderCommand* cmd) { return cmd->IsSubmitVRCommand(); });
+
+   // First replay the frame, synchronizing with the GPU between each pass to measure them
+   vector<U64> passTotal(nPasses, 0), passMin(nPasses, ~0ull);
+   U64 frameTotal = 0, frameMin = ~0ull;
+   for (unsigned int replay = 0; replay < m_captureReplays; replay++)
+   {
+      #ifndef ENABLE_SDL
+      CHECKD3D(m_rd->GetCoreDevice()->BeginScene());
+      #endif
+      m_rd->FlushGPUCommandBuffer();
+      const U64 frameStart = usec();
+      for (size_t i = 0; i < nPasses; i++)
+      {
+         if (!replayable[i])
+            continue;
+         const U64 passStart = usec();
+         sortedPasses[i]->Execute(false);
+         m_rd->FlushGPUCommandBuffer();
+         const U64 passTime = usec() - passStart;
+         passTotal[i] += passTime;
+         passMin[i] = min(passMin[i], passTime);
+      }
+      const U64 frameTime = usec() - frameStart;
+      frameTotal += frameTime;
+      frameMin = min(frameMin, frameTime);
+      #ifndef ENABLE_SDL
+      CHECKD3D(m_rd->GetCoreDevice()->EndScene());
+      #endif
+   }
+
+   // Then replay it again, synchronizing between each command (or batch of commands) to measure them. These timings include a larger synchronization overhead.
+   for (RenderPass* pass : sortedPasses)
+      pass->m_commandTimings.assign(pass->m_commands.size(), 0);
+   for (unsigned int replay = 0; replay < m_captureReplays; replay++)
+   {
+      #ifndef ENABLE_SDL
+      CHECKD3D(m_rd->GetCoreDevice()->BeginScene());
+      #endif
+      for (size_t i = 0; i < nPasses; i++)
+         if (replayable[i])
+            sortedPasses[i]->Execute(false);
+      #ifndef ENABLE_SDL
+      CHECKD3D(m_rd->GetCoreDevice()->EndScene());
+      #endif
+   }
+
+   m_rd->m_curDrawCalls = counters[0];
+   m_rd->m_curBatchedDrawCalls = counters[1];
+   m_rd->m_curStateChanges = counters[2];
+   m_rd->m_curTextureChanges = counters[3];
+   m_rd->m_curParameterChanges = counters[4];
+   m_rd->m_curTechniqueChanges = counters[5];
+   m_rd->m_curDrawnTriangles = counters[6];
+
+   // Write the captured frame with its timings (in microseconds)
+   const double replays = (double)m_captureReplays;
+   out << std::fixed << std::setprecision(1);
+   out << "Frame: " << nPasses << " passes, " << m_captureReplays << " replays, avg " << (double)frameTotal / replays << "us, min " << frameMin << "us\n";
+   for (size_t i = 0; i < nPasses; i++)
+   {
+      const RenderPass* pass = sortedPasses[i];
+      out << std::setprecision(1) << "\nPass '" << pass->m_name << "' [RT='" << pass->m_rt->m_name << "' " << pass->m_rt->GetWidth() << 'x' << pass->m_rt->GetHeight();
+      if (pass->m_rt->m_nLayers > 1)
+         out << 'x' << pass->m_rt->m_nLayers;
+      if (pass->m_singleLayerRendering >= 0)
+         out << ", Layer=" << pass->m_singleLayerRendering;
+      if (pass->m_areaOfInterest.x != FLT_MAX)
+         out << ", Scissor=(" << pass->m_areaOfInterest.x << ", " << pass->m_areaOfInterest.y << ", " << pass->m_areaOfInterest.z << ", " << pass->m_areaOfInterest.w << ')';
+      out << ", " << pass->m_commands.size() << " commands, Dependencies:";
+      for (const RenderPass* dep : pass->m_dependencies)
+         out << " '" << dep->m_name << '\'';
+      out << ']';
+      if (replayable[i])
+         out << " avg " << (double)passTotal[i] / replays << "us, min " << passMin[i] << "us\n";
+      else
+         out << " not replayed\n";
+      for (size_t j = 0; j < pass->m_commands.size(); j++)
+      {
+         // Batched commands are measured together and reported on the first command of the batch
+         out << std::setprecision(1) << std::setw(10) << (double)pass->m_commandTimings[j] / replays << "us ";
+         pass->m_commands[j]->Dump(out);
+         out << '\n';
+      }
+   }
+   out.close();
+
+   for (RenderPass* pass : sortedPasses)
+      pass->m_commandTimings.clear();
+
+   PLOGI << "Frame captured: avg " << (double)frameTotal / replays << "us, min " << frameMin << "us";
+}
+
 RenderCommand* RenderFrame::NewCommand()
 {
    if (m_commandPool.empty())
@@ -174,6 +297,12 @@ bool RenderFrame::Execute(const bool log)
    CHECKD3D(m_rd->GetCoreDevice()->EndScene());
    #endif
 
+   if (rendered && !m_capturePath.empty())
+   {
+      Capture(sortedPasses);
+      m_capturePath.clear();
+   }
+
    // Recycle commands & passes
    for (RenderPass* pass : m_passes)
       pass->RecycleCommands(m_commandPool);
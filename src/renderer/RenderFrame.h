@@ -18,10 +18,21 @@ public:
 
    RenderCommand* NewCommand();
 
+   // Request a capture of the next executed frame: it is replayed in-process to measure per pass & per command GPU timings, then its pass/command structure
+   // is written to the given file with the timings. The file is a report (each draw lists its bound textures/render targets and a hash of its uniforms), not a replayable stream
+   void CaptureNextFrame(const string& path, const unsigned int nReplays) { m_capturePath = path; m_captureReplays = max(nReplays, 1u); }
+
+   unsigned int GetPassCount() const { return (unsigned int)m_passes.size(); }
+   U64 GetContentHash(const unsigned int firstPass) const; // Hash of the commands submitted to the passes added after the given pass count
+
 private:
+   void Capture(const vector<RenderPass*>& sortedPasses);
+
    RenderDevice* const m_rd;
    RenderDeviceState* m_rdState = nullptr;
    vector<RenderPass*> m_passes;
    vector<RenderPass*> m_passPool;
    vector<RenderCommand*> m_commandPool;
+   string m_capturePath;
+   unsigned int m_captureReplays = 0;
 };
@@ -315,44 +315,20 @@ bool RenderPass::Execute(const bool log)
    if (m_rt->m_nLayers == 1 || (m_singleLayerRendering < 0 && m_rt->GetRenderDevice()->SupportLayeredRendering()))
    {
       m_rt->Activate();
-      for (RenderCommand* cmd : m_commands)
-      {
-         #ifdef ENABLE_SDL // Layered rendering is not yet implemented for DirectX
-         Shader::ShaderState* state = cmd->GetShaderState();
-         if (state)
-            state->SetInt(SHADER_layer, 0);
-         #endif
-         cmd->Execute(m_rt->m_nLayers, log);
-      }
+      ExecuteCommands(0, m_rt->m_nLayers, log);
    }
    else if (m_singleLayerRendering >= 0)
    {
       assert(m_singleLayerRendering < m_rt->m_nLayers);
       m_rt->Activate(m_singleLayerRendering);
-      for (RenderCommand* cmd : m_commands)
-      {
-         #ifdef ENABLE_SDL // Layered rendering is not yet implemented for DirectX
-         Shader::ShaderState* state = cmd->GetShaderState();
-         if (state)
-            state->SetInt(SHADER_layer, m_singleLayerRendering);
-         #endif
-         cmd->Execute(1, log);
-      }
+      ExecuteCommands(m_singleLayerRendering, 1, log);
    }
    else
    {
       for (int layer = 0; layer < m_rt->m_nLayers; layer++)
       {
          m_rt->Activate(layer);
-         for (RenderCommand* cmd : m_commands)
-         {
-            #ifdef ENABLE_SDL // Layered rendering is not yet implemented for DirectX
-            Shader::ShaderState* state = cmd->GetShaderState();
-            if (state)
-               state->SetInt(SHADER_layer, layer);
-            #endif
-            cmd->Execute(1, log);
-         }
+         ExecuteCommands(layer, 1, log);
       }
    }
 
@@ -375,3 +351,49 @@ bool RenderPass::Execute(const bool log)
 
    return true;
 }
+
+void RenderPass::ExecuteCommands(const int layer, const int nInstances, const bool log)
+{
+   const unsigned int nCommands = (unsigned int)m_commands.size();
+   for (unsigned int i = 0; i < nCommands;)
+   {
+      RenderCommand* cmd = m_commands[i];
+      #ifdef ENABLE_SDL // Layered rendering is not yet implemented for DirectX
+      Shader::ShaderState* state = cmd->GetShaderState();
+      if (state)
+         state->SetInt(SHADER_layer, layer);
+      #endif
+      // Gather following commands that can be submitted together with this one (commands are sorted to make them consecutive)
+      unsigned int batchSize = 1;
+      if (cmd->IsDrawMeshCommand())
+      {
+         while (i + batchSize < nCommands)
+         {
+            RenderCommand* next = m_commands[i + batchSize];
+            #ifdef ENABLE_SDL
+            if (next->IsDrawMeshCommand())
+               next->GetShaderState()->SetInt(SHADER_layer, layer);
+            #endif
+            if (!cmd->IsBatchableWith(next))
+               break;
+            batchSize++;
+         }
+      }
+      U64 start = 0;
+      if (!m_commandTimings.empty())
+      {
+         m_rt->GetRenderDevice()->FlushGPUCommandBuffer();
+         start = usec();
+      }
+      if (batchSize > 1)
+         cmd->ExecuteBatch(&m_commands[i], batchSize, nInstances, log);
+      else
+         cmd->Execute(nInstances, log);
+      if (!m_commandTimings.empty())
+      {
+         m_rt->GetRenderDevice()->FlushGPUCommandBuffer();
+         m_commandTimings[i] += usec() - start;
+      }
+      i += batchSize;
+   }
+}
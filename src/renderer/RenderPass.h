@@ -34,4 +34,8 @@ public:
    vector<RenderTarget*> m_referencedRT; // List of render targets used by dependencies
    int m_sortKey = 0;
    bool m_updated = false;
+   vector<U64> m_commandTimings; // If not empty, each command execution is measured, synchronizing with the GPU, and its duration (in us) accumulated here (used for frame captures)
+
+private:
+   void ExecuteCommands(const int layer, const int nInstances, const bool log);
 };
@@ -94,6 +94,7 @@ void RenderProbe::RenderRelease()
    m_prerenderRT = nullptr;
    delete m_dynamicRT;
    m_dynamicRT = nullptr;
+   m_renderHash = 0;
    delete m_blurRT;
    m_blurRT = nullptr;
 }
@@ -174,6 +175,16 @@ void RenderProbe::ApplyAreaOfInterest(RenderPass* pass)
 {
    if (pass == nullptr)
    {
+      if (m_type == PLANE_REFLECTION && !m_dirty)
+      {
+         if (m_finalPass != nullptr)
+            m_renderedAreaOfInterest = m_reflection_clip_bounds;
+         else if (m_renderedAreaOfInterest.x != FLT_MAX
+            && (m_reflection_clip_bounds.x == FLT_MAX
+               || m_reflection_clip_bounds.x < m_renderedAreaOfInterest.x || m_reflection_clip_bounds.y < m_renderedAreaOfInterest.y
+               || m_reflection_clip_bounds.z > m_renderedAreaOfInterest.z || m_reflection_clip_bounds.w > m_renderedAreaOfInterest.w))
+            m_renderHash = 0; // The reused render was clipped to a smaller area than the one needed, so force a render on next frame
+      }
       pass = m_finalPass;
       if (pass == nullptr)
          return;
@@ -395,7 +406,10 @@ void RenderProbe::RenderReflectionProbe(const unsigned int renderMask)
       const int w = m_rd->GetMSAABackBufferTexture()->GetWidth() / downscale, h = m_rd->GetMSAABackBufferTexture()->GetHeight() / downscale;
       m_dynamicRT = new RenderTarget(m_rd, m_rd->GetMSAABackBufferTexture()->m_type, m_name + ".Dyn", w, h, m_rd->GetMSAABackBufferTexture()->GetColorFormat(), true, 1,
          "Failed to create plane reflection dynamic render target", nullptr);
+      m_renderHash = 0;
    }
+   const unsigned int revision = m_dynamicRT->GetContentRevision();
+   const unsigned int mark = m_rd->GetRenderCommandsMark();
    m_rd->SetRenderTarget(m_name, m_dynamicRT);
    m_rd->ResetRenderState();
    if (isDynamicOnly && mode == REFL_DYNAMIC)
@@ -406,7 +420,18 @@ void RenderProbe::RenderReflectionProbe(const unsigned int renderMask)
    const bool render_balls = !isStaticOnly && (mode == REFL_BALLS || mode >= REFL_STATIC_N_BALLS);
    const bool render_dynamic = !isStaticOnly && (mode >= REFL_STATIC_N_DYNAMIC);
    DoRenderReflectionProbe(render_static, render_balls, render_dynamic);
-   ApplyRoughness(m_dynamicRT, m_roughness);
+   // If nothing changed since last render (lights, balls, dynamic parts, view,...), discard this render and use the previous one
+   const U64 hash = m_rd->GetRenderCommandsHash(mark);
+   if (hash == m_renderHash)
+   {
+      m_dynamicRT->DiscardFrameRender(revision);
+      m_finalPass = nullptr;
+   }
+   else
+   {
+      m_renderHash = hash;
+      ApplyRoughness(m_dynamicRT, m_roughness);
+   }
    m_rd->SetRenderTarget(previousRT->m_name + '+', previousRT->m_rt);
    m_rendering = false;
 }
@@ -88,4 +88,6 @@ private:
    RenderTarget* m_dynamicRT = nullptr;
    RenderPass* m_finalPass = nullptr; // Pass after rougness has been applied
    RenderPass* m_copyPass = nullptr; // Pass that performs the screen space copy
+   U64 m_renderHash = 0; // Hash of the commands of the last executed render, used to skip unchanged renders
+   vec4 m_renderedAreaOfInterest = vec4(FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX); // Area of interest of the last executed render
 };
@@ -380,6 +380,25 @@ void RenderTarget::UpdateDepthSampler(bool insideBeginEnd)
 #endif
 }
 
+unsigned int RenderTarget::GetContentRevision() const
+{
+   return m_color_sampler ? m_color_sampler->m_contentRevision : 0;
+}
+
+// Discard the passes rendered to this render target since the given content revision, keeping its previous content.
+// Passes are only executed if they contribute to the final pass, so unlinking them from the render target is enough.
+void RenderTarget::DiscardFrameRender(const unsigned int revision)
+{
+   m_lastRenderPass = nullptr;
+   if (m_color_sampler)
+   {
+      const unsigned int nUpdates = m_color_sampler->m_contentRevision - revision;
+      m_color_sampler->m_contentRevision = revision;
+      if (m_depth_sampler)
+         m_depth_sampler->m_contentRevision -= nUpdates;
+   }
+}
+
 RenderTarget* RenderTarget::Duplicate(const string& name, const bool shareDepthSurface)
 {
    assert(!m_is_back_buffer);
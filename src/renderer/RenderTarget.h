@@ -18,6 +18,8 @@ public:
    Sampler* GetColorSampler() { return m_color_sampler; }
    void UpdateDepthSampler(bool insideBeginEnd);
    Sampler* GetDepthSampler() { return m_depth_sampler; }
+   unsigned int GetContentRevision() const;
+   void DiscardFrameRender(const unsigned int revision);
 
    RenderTarget* Duplicate(const string& name, const bool shareDepthSurface = false);
    void CopyTo(RenderTarget* dest, const bool copyColor = true, const bool copyDepth = true, 
@@ -13,5 +13,7 @@ public:
    virtual void UpdateAnimation(const float diff_time_msec) = 0;
    virtual void Render(const unsigned int renderMask) = 0;
    virtual float GetDepth(const Vertex3Ds& viewDir) const { return 0.0f; }
+   // World space axis aligned bounds of the rendered geometry, used for view frustum culling. Parts returning false are never culled.
+   virtual bool GetRenderBounds(Vertex3Ds& boundMin, Vertex3Ds& boundMax) { return false; }
    virtual void RenderRelease() = 0;
 };
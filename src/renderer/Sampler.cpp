@@ -187,6 +187,7 @@ void Sampler::UpdateTexture(BaseTexture* const surf, const bool force_linear_rgb
    CHECKD3D(m_rd->GetCoreDevice()->UpdateTexture(sysTex, m_texture));
    SAFE_RELEASE(sysTex);
 #endif
+   m_contentRevision++;
    m_rd->m_curTextureUpdates++;
 }
 
@@ -203,6 +204,7 @@ void Sampler::SetFilter(const SamplerFilter filter)
 
 void Sampler::SetName(const string& name)
 {
+   m_name = name;
    #ifdef ENABLE_SDL
    if (GLAD_GL_VERSION_4_3)
       glObjectLabel(GL_TEXTURE, m_texture, (GLsizei) name.length(), name.c_str());
@@ -60,6 +60,7 @@ public:
    void SetClamp(const SamplerAddressMode clampu, const SamplerAddressMode clampv);
    void SetFilter(const SamplerFilter filter);
    void SetName(const string& name);
+   const string& GetName() const { return m_name; }
 
    bool IsLinear() const { return m_isLinear; }
    int GetWidth() const { return m_width; }
@@ -69,6 +70,7 @@ public:
    SamplerAddressMode GetClampV() const { return m_clampv; }
 
    bool m_dirty;
+   unsigned int m_contentRevision = 0; // Incremented each time the texture content is modified (texture update or render target rendering)
    robin_hood::unordered_set<SamplerBinding*> m_bindings;
    const SurfaceType m_type;
 
@@ -81,6 +83,7 @@ private:
    SamplerAddressMode m_clampu;
    SamplerAddressMode m_clampv;
    SamplerFilter m_filter;
+   string m_name;
 
 #ifdef ENABLE_SDL
    GLenum m_texTarget = 0;
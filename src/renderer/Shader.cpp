@@ -501,6 +501,51 @@ void Shader::End()
 #endif
 }
 
+unsigned int Shader::GetTexturesRevision(const ShaderState* state) const
+{
+   unsigned int revision = 0;
+   for (int uniform = 0; uniform < SHADER_UNIFORM_COUNT; uniform++)
+   {
+      if (m_stateOffsets[uniform] == -1 || shaderUniformNames[uniform].type != SUT_Sampler)
+         continue;
+      const Sampler* const sampler = *(Sampler**)(state->m_state + m_stateOffsets[uniform]);
+      if (sampler)
+         revision = revision * 31u + sampler->m_contentRevision;
+   }
+   return revision;
+}
+
+void Shader::DumpState(const ShaderState* state, std::ostream& out) const
+{
+   // Textures are identified by their sampler name (image name or render target), or by their address if unnamed
+   U64 hash = 14695981039346656037ull; // FNV-1a
+   out << " Tex:";
+   for (int uniform = 0; uniform < SHADER_UNIFORM_COUNT; uniform++)
+   {
+      if (m_stateOffsets[uniform] == -1)
+         continue;
+      if (shaderUniformNames[uniform].type == SUT_Sampler)
+      {
+         const Sampler* const sampler = *(Sampler**)(state->m_state + m_stateOffsets[uniform]);
+         if (sampler == nullptr || sampler == m_renderDevice->m_nullTexture)
+            continue;
+         out << ' ' << shaderUniformNames[uniform].name << "='";
+         if (sampler->GetName().empty())
+            out << (const void*)sampler;
+         else
+            out << sampler->GetName();
+         out << '\'';
+      }
+      else
+      {
+         const BYTE* const data = state->m_state + m_stateOffsets[uniform];
+         for (int i = 0; i < m_stateSizes[uniform]; i++)
+            hash = (hash ^ data[i]) * 1099511628211ull;
+      }
+   }
+   out << " Uniforms: " << std::hex << std::setw(16) << std::setfill('0') << hash << std::setfill(' ') << std::dec;
+}
+
 void Shader::SetTextureNull(const ShaderUniforms uniformName)
 {
    SetTexture(uniformName, m_renderDevice->m_nullTexture);
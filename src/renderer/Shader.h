@@ -508,6 +508,8 @@ public:
    };
 
    unsigned int GetStateSize() const { return m_stateSize; };
+   unsigned int GetTexturesRevision(const ShaderState* state) const; // Combined content revision of the textures bound in the given state
+   void DumpState(const ShaderState* state, std::ostream& out) const; // Write the textures bound in the given state and a hash of its other uniforms (used for frame captures)
    ShaderState* m_state = nullptr; // State that will be applied for the next begin/end pair
 
 private:
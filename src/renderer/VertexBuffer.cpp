@@ -41,6 +41,12 @@ void SharedVertexBuffer::Upload()
          delete[] upload.data;
       }
       m_pendingUploads.clear();
+      if (!m_isStatic)
+      {
+         m_shadow.resize(size);
+         memcpy(data, m_shadow.data(), size);
+         m_dirtySpans.clear();
+      }
 
       // Upload data block
       #if defined(ENABLE_SDL) // OpenGL
@@ -70,28 +76,29 @@ void SharedVertexBuffer::Upload()
    }
    else
    {
-      for (PendingUpload upload : m_pendingUploads)
+      // Only dynamic buffers can be modified after their initial upload, and only their modified spans are uploaded
+      assert(m_pendingUploads.empty());
+      for (const DirtySpan& span : m_dirtySpans)
       {
          #if defined(ENABLE_SDL) // OpenGL
          #ifndef __OPENGLES__
          if (GLAD_GL_VERSION_4_5)
-            glNamedBufferSubData(m_vb, upload.offset, upload.size, upload.data);
+            glNamedBufferSubData(m_vb, span.offset, span.size, m_shadow.data() + span.offset);
          else
          #endif
          {
             Bind();
-            glBufferSubData(GL_ARRAY_BUFFER, upload.offset, upload.size, upload.data);
+            glBufferSubData(GL_ARRAY_BUFFER, span.offset, span.size, m_shadow.data() + span.offset);
          }
          #else // DirectX 9
-         // It would be better to perform a single lock but in fact, I don't think there are situations where more than one update is pending
          UINT8* data;
-         CHECKD3D(m_vb->Lock(upload.offset, upload.size, (void**)&data, 0));
-         memcpy(data, upload.data, upload.size);
+         CHECKD3D(m_vb->Lock(span.offset, span.size, (void**)&data, 0));
+         memcpy(data, m_shadow.data() + span.offset, span.size);
          CHECKD3D(m_vb->Unlock());
          #endif
-         delete[] upload.data;
+         m_buffers[0]->m_rd->m_curBufferUploadBytes += span.size;
       }
-      m_pendingUploads.clear();
+      m_dirtySpans.clear();
    }
 }
 
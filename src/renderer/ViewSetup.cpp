@@ -1,6 +1,14 @@
 #include "stdafx.h"
 #include "ViewSetup.h"
 
+// Settings read each time the view is computed
+static const Settings::FloatSetting s_screenPlayerX = Settings::RegisterFloatSetting(Settings::Player, "ScreenPlayerX"s, 0.0f);
+static const Settings::FloatSetting s_screenPlayerY = Settings::RegisterFloatSetting(Settings::Player, "ScreenPlayerY"s, 0.0f);
+static const Settings::FloatSetting s_screenPlayerZ = Settings::RegisterFloatSetting(Settings::Player, "ScreenPlayerZ"s, 70.0f);
+static const Settings::FloatSetting s_screenInclination = Settings::RegisterFloatSetting(Settings::Player, "ScreenInclination"s, 0.0f);
+static const Settings::FloatSetting s_screenWidth = Settings::RegisterFloatSetting(Settings::Player, "ScreenWidth"s, 0.0f);
+static const Settings::FloatSetting s_stereo3DEyeSeparation = Settings::RegisterFloatSetting(Settings::Player, "Stereo3DEyeSeparation"s, 63.0f);
+
 ViewSetup::ViewSetup()
 {
 }
@@ -11,10 +19,10 @@ ViewSetup::ViewSetup()
 void ViewSetup::SetWindowModeFromSettings(const PinTable* const table)
 {
    float realToVirtual = GetRealToVirtualScale(table);
-   vec3 playerPos(CMTOVPU(table->m_settings.LoadValueWithDefault(Settings::Player, "ScreenPlayerX"s, 0.0f)),
-                  CMTOVPU(table->m_settings.LoadValueWithDefault(Settings::Player, "ScreenPlayerY"s, 0.0f)),
-                  CMTOVPU(table->m_settings.LoadValueWithDefault(Settings::Player, "ScreenPlayerZ"s, 70.0f)));
-   float inclination = table->m_settings.LoadValueWithDefault(Settings::Player, "ScreenInclination"s, 0.0f);
+   vec3 playerPos(CMTOVPU(table->m_settings.GetValue(s_screenPlayerX)),
+                  CMTOVPU(table->m_settings.GetValue(s_screenPlayerY)),
+                  CMTOVPU(table->m_settings.GetValue(s_screenPlayerZ)));
+   float inclination = table->m_settings.GetValue(s_screenInclination);
    float screenBotZ = GetWindowBottomZOFfset(table);
    float screenTopZ = GetWindowTopZOFfset(table);
    Matrix3D rotx; // Rotate by the angle between playfield and real world horizontal (scale on Y and Z axis are equal and can be ignored)
@@ -137,7 +145,7 @@ float ViewSetup::GetRealToVirtualScale(const PinTable* const table) const
    if (mMode == VLM_WINDOW)
    {
       float windowBotZ = GetWindowBottomZOFfset(table), windowTopZ = GetWindowTopZOFfset(table);
-      const float screenHeight = table->m_settings.LoadValueWithDefault(Settings::Player, "ScreenWidth"s, 0.0f); // Physical width (always measured in landscape orientation) is the height in window mode
+      const float screenHeight = table->m_settings.GetValue(s_screenWidth); // Physical width (always measured in landscape orientation) is the height in window mode
       // const float inc = atan2f(mSceneScaleZ * (windowTopZ - windowBotZ), mSceneScaleY * table->m_bottom);
       const float inc = atan2f(windowTopZ - windowBotZ, table->m_bottom);
       return screenHeight <= 1.f ? 1.f : (VPUTOCM(table->m_bottom) / cosf(inc)) / screenHeight; // Ratio between screen height in virtual world to real world screen height
@@ -342,7 +350,7 @@ void ViewSetup::ComputeMVP(const PinTable* const table, const float aspect, cons
       const Vertex3Ds bottom = fit.MultiplyVector(Vertex3Ds(centerAxis, table->m_bottom, windowBotZ));
       const float xmin = zNear * min(bottom.x, top.x), xmax = zNear * max(bottom.x, top.x);
       const float ymin = zNear * min(bottom.y, top.y), ymax = zNear * max(bottom.y, top.y);
-      const float screenHeight = table->m_settings.LoadValueWithDefault(Settings::Player, "ScreenWidth"s, 0.0f); // Physical width (always measured in landscape orientation) is the height in window mode
+      const float screenHeight = table->m_settings.GetValue(s_screenWidth); // Physical width (always measured in landscape orientation) is the height in window mode
       float offsetScale;
       if ((quadrant & 1) == 0) // 0 & 180
       {
@@ -378,7 +386,7 @@ void ViewSetup::ComputeMVP(const PinTable* const table, const float aspect, cons
       // Since the table is scaled to 'real world units' (that is to say same scale as the user measures), we directly use the user settings for IPD,.. without any scaling
 
       // 63mm is the average distance between eyes (varies from 54 to 74mm between adults, 43 to 58mm for children)
-      const float eyeSeparation = MMTOVPU(table->m_settings.LoadValueWithDefault(Settings::Player, "Stereo3DEyeSeparation"s, 63.0f));
+      const float eyeSeparation = MMTOVPU(table->m_settings.GetValue(s_stereo3DEyeSeparation));
 
       // Z where the stereo separation is 0:
       // - for cabinet (window) mode, we use the orthogonal distance to the screen (window)
@@ -66,8 +66,8 @@ public:
 };
 
 
-static vector<Vertex *>   vertices;
-static vector<Triangle *> triangles;
+static thread_local vector<Vertex *>   vertices; // thread_local, as collision meshes of several primitives are reduced concurrently
+static thread_local vector<Triangle *> triangles;
 
 
 __forceinline Triangle::Triangle(Vertex * const v0, Vertex * const v1, Vertex * const v2)
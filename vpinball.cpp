@@ -894,6 +894,13 @@ bool VPinball::ParseCommand(const size_t code, const bool notify)
       ShowSubDialog(m_renderProbeDialog, true);
       return true;
    }
+   case ID_TABLE_OPTIMIZEPRIMITIVES:
+   {
+      CComObject<PinTable> *const ptCur = GetActiveTable();
+      if (ptCur && !ptCur->IsLocked())
+         ptCur->OptimizePrimitiveMeshes();
+      return true;
+   }
    case ID_PREFERENCES_SECURITYOPTIONS:
    {
       DialogBoxParam(theInstance, MAKEINTRESOURCE(IDD_SECURITY_OPTIONS), GetHwnd(), SecurityOptionsProc, 0);
@@ -1170,6 +1177,7 @@ void VPinball::SetEnableMenuItems()
       mainMenu.EnableMenuItem(ID_TABLE_TABLEINFO, enabled);
       mainMenu.EnableMenuItem(ID_TABLE_DIMENSIONMANAGER, ptCur->IsLocked() ? grayed : enabled);
       mainMenu.EnableMenuItem(ID_TABLE_RENDERPROBEMANAGER, ptCur->IsLocked() ? grayed : enabled);
+      mainMenu.EnableMenuItem(ID_TABLE_OPTIMIZEPRIMITIVES, ptCur->IsLocked() ? grayed : enabled);
       mainMenu.EnableMenuItem(ID_EDIT_SEARCH, ptCur->IsLocked() ? grayed : enabled);
       mainMenu.EnableMenuItem(ID_EDIT_DRAWINGORDER_HIT, ptCur->IsLocked() ? grayed : enabled);
       mainMenu.EnableMenuItem(ID_EDIT_DRAWINGORDER_SELECT, ptCur->IsLocked() ? grayed : enabled);
@@ -1260,6 +1268,7 @@ void VPinball::SetEnableMenuItems()
       mainMenu.EnableMenuItem(ID_TABLE_COLLECTIONMANAGER, grayed);
       mainMenu.EnableMenuItem(ID_TABLE_DIMENSIONMANAGER, grayed);
       mainMenu.EnableMenuItem(ID_TABLE_RENDERPROBEMANAGER, grayed);
+      mainMenu.EnableMenuItem(ID_TABLE_OPTIMIZEPRIMITIVES, grayed);
       mainMenu.EnableMenuItem(ID_TABLE_TABLEINFO, grayed);
       mainMenu.EnableMenuItem(ID_TABLE_MAGNIFY, grayed);
       mainMenu.EnableMenuItem(ID_EDIT_SEARCH, grayed);
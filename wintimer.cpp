@@ -229,6 +229,184 @@ void uOverSleep(const unsigned long long u)
 
 //
 
+void ScriptEventProfiler::Reset()
+{
+   m_nodes.clear();
+   m_nodes.push_back(Node());
+   m_children.clear();
+   m_stack.clear();
+}
+
+void ScriptEventProfiler::Enter(const DISPID dispid, const void* const name, const bool wide, const unsigned long long ts)
+{
+   if (m_nodes.empty())
+      Reset();
+   const unsigned int parent = m_stack.empty() ? 0 : m_stack.back().m_node;
+   const ChildKey key { parent, dispid, name };
+   auto it = m_children.find(key);
+   if (it == m_children.end())
+   {
+      // Label after the script sub handling the event, e.g. 'Bumper1_Hit'
+      const string event = GetEventName(dispid);
+      const size_t colon = event.find(':');
+      string label = name == nullptr ? string() : wide ? MakeString(wstring((const WCHAR*)name)) : string((const char*)name);
+      if (!label.empty())
+         label += '_';
+      label += colon == string::npos ? event : event.substr(colon + 1);
+      unsigned int node;
+      if (parent != 0 && m_nodes[parent].m_label == label)
+         node = parent; // same handler fired through another path (e.g. the player firing a timer, then the timer firing its event)
+      else
+      {
+         node = (unsigned int)m_nodes.size();
+         m_nodes.push_back(Node());
+         m_nodes[node].m_label = label;
+         m_nodes[node].m_parent = parent;
+      }
+      it = m_children.emplace(key, node).first;
+   }
+   if (!m_stack.empty() && it->second == parent)
+      m_stack.back().m_repeat++;
+   else
+      m_stack.push_back({ it->second, 0, ts, 0 });
+}
+
+void ScriptEventProfiler::Exit(const unsigned long long ts)
+{
+   if (m_stack.empty())
+      return;
+   Call& call = m_stack.back();
+   if (call.m_repeat > 0)
+   {
+      call.m_repeat--;
+      return;
+   }
+   const unsigned long long length = ts - call.m_start;
+   Node& node = m_nodes[call.m_node];
+   node.m_callCount++;
+   node.m_totalLength += length;
+   node.m_selfLength += length > call.m_childLength ? length - call.m_childLength : 0;
+   node.m_maxLength = max(node.m_maxLength, (unsigned int)min(length, 0xFFFFFFFFull));
+   unsigned int bucket = 0;
+   while (bucket < N_BUCKETS - 1 && length >= (2ull << bucket))
+      bucket++;
+   node.m_histogram[bucket]++;
+   m_stack.pop_back();
+   if (!m_stack.empty())
+      m_stack.back().m_childLength += length;
+}
+
+string ScriptEventProfiler::GetPath(unsigned int node) const
+{
+   string path = m_nodes[node].m_label;
+   for (node = m_nodes[node].m_parent; node != 0; node = m_nodes[node].m_parent)
+      path = m_nodes[node].m_label + ';' + path;
+   return path;
+}
+
+void ScriptEventProfiler::LogSummary() const
+{
+   // Merge the nodes of the same handler called from different places
+   struct Summary
+   {
+      string label;
+      unsigned int callCount = 0;
+      unsigned long long totalLength = 0;
+      unsigned long long selfLength = 0;
+      unsigned int maxLength = 0;
+      unsigned int histogram[N_BUCKETS] = {};
+   };
+   robin_hood::unordered_map<string, size_t> indices;
+   vector<Summary> summaries;
+   unsigned long long selfLength = 0;
+   for (size_t i = 1; i < m_nodes.size(); i++)
+   {
+      const Node& node = m_nodes[i];
+      const auto it = indices.find(node.m_label);
+      const size_t index = it == indices.end() ? summaries.size() : it->second;
+      if (index == summaries.size())
+      {
+         indices[node.m_label] = index;
+         summaries.push_back(Summary());
+         summaries.back().label = node.m_label;
+      }
+      Summary& summary = summaries[index];
+      summary.callCount += node.m_callCount;
+      summary.totalLength += node.m_totalLength;
+      summary.selfLength += node.m_selfLength;
+      summary.maxLength = max(summary.maxLength, node.m_maxLength);
+      for (unsigned int j = 0; j < N_BUCKETS; j++)
+         summary.histogram[j] += node.m_histogram[j];
+      selfLength += node.m_selfLength;
+   }
+   std::sort(summaries.begin(), summaries.end(), [](const Summary& a, const Summary& b) { return a.selfLength > b.selfLength; });
+
+   PLOGI << "Script event profile: " << std::fixed << std::setprecision(1) << (selfLength * 1e-3) << "ms spent in " << summaries.size() << " event handlers";
+   for (size_t i = 0; i < min(summaries.size(), (size_t)20); i++)
+   {
+      const Summary& summary = summaries[i];
+      std::stringstream ss;
+      ss << "  . " << summary.label << ": " << std::setw(6) << std::fixed << std::setprecision(1) << (summary.selfLength * 1e-3) << "ms self, "
+         << (summary.totalLength * 1e-3) << "ms total in " << summary.callCount << " calls (" << std::setprecision(3)
+         << (summary.callCount == 0 ? 0. : (double)summary.totalLength * 1e-3 / (double)summary.callCount) << "ms avg, " << (summary.maxLength * 1e-3) << "ms max) [";
+      bool first = true;
+      for (unsigned int j = 0; j < N_BUCKETS; j++)
+         if (summary.histogram[j] > 0)
+         {
+            ss << (first ? "" : " ") << (j == N_BUCKETS - 1 ? ">=" : "<") << ((j == N_BUCKETS - 1 ? 1u : 2u) << j) << "us:" << summary.histogram[j];
+            first = false;
+         }
+      ss << ']';
+      PLOGI << ss.str();
+   }
+}
+
+bool ScriptEventProfiler::SaveFoldedStacks(const string& path) const
+{
+   // One line per call path with its self time in microseconds, e.g. 'Timer1_Timer;Kicker1_Hit 1234'
+   std::ofstream file(path, std::ios::trunc);
+   if (!file.is_open())
+   {
+      PLOGE << "Failed to write script event profile to " << path;
+      return false;
+   }
+   for (unsigned int i = 1; i < (unsigned int)m_nodes.size(); i++)
+      if (m_nodes[i].m_selfLength > 0)
+         file << GetPath(i) << ' ' << m_nodes[i].m_selfLength << '\n';
+   PLOGI << "Script event profile saved to " << path;
+   return true;
+}
+
+string ScriptEventProfiler::GetEventName(const DISPID dispid)
+{
+   switch (dispid)
+   {
+   case 1000: return "GameEvents:KeyDown"s;
+   case 1001: return "GameEvents:KeyUp"s;
+   case 1002: return "GameEvents:Init"s;
+   case 1003: return "GameEvents:MusicDone"s;
+   case 1004: return "GameEvents:Exit"s;
+   case 1005: return "GameEvents:Paused"s;
+   case 1006: return "GameEvents:UnPaused"s;
+   case 1007: return "GameEvents:OptionEvent"s;
+   case 1101: return "SurfaceEvents:Slingshot"s;
+   case 1200: return "FlipperEvents:Collide"s;
+   case 1300: return "TimerEvents:Timer"s;
+   case 1301: return "SpinnerEvents:Spin"s;
+   case 1302: return "TargetEvents:Dropped"s;
+   case 1303: return "TargetEvents:Raised"s;
+   case 1320: return "LightSeqEvents:PlayDone"s;
+   case 1400: return "HitEvents:Hit"s;
+   case 1401: return "HitEvents:Unhit"s;
+   case 1402: return "LimitEvents:EOS"s;
+   case 1403: return "LimitEvents:BOS"s;
+   case 1404: return "AnimateEvents:Animate"s;
+   default: return "DispID["s + std::to_string(dispid) + ']';
+   }
+}
+
+//
+
 static constexpr unsigned int daysPerMonths[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 }; // Number of days per month
 
 // (Rough) angle of the day (radian)
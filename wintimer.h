@@ -20,6 +20,70 @@ double MaxTheoreticRadiation(const unsigned int year, const double rlat);
 double SunsetSunriseLocalTime(const unsigned int day, const unsigned int month, const unsigned int year, const double rlong, const double rlat, const bool sunrise);
 
 
+// Continuous profiling of the script event handlers, per object and event (enabled by the 'ScriptProfiler' setting)
+//
+// Calls are recorded as a call tree, since handlers may fire other events (e.g. a timer kicking a ball out of a kicker), with call
+// counts, inclusive and self times, and a histogram of the call lengths for each node. At the end of play, the self times are
+// saved in the folded stack format used by flame graph tools (flamegraph.pl, speedscope, ...), and the costliest handlers are logged.
+class ScriptEventProfiler
+{
+public:
+   void Enable(const bool enable) { m_enabled = enable; }
+   bool IsEnabled() const { return m_enabled; }
+   void Reset();
+
+   // The name pointer also identifies the object, so it must stay valid until the next Reset
+   void Enter(const DISPID dispid, const char* const name, const unsigned long long ts) { if (m_enabled) Enter(dispid, name, false, ts); }
+   void Enter(const DISPID dispid, const WCHAR* const name, const unsigned long long ts) { if (m_enabled) Enter(dispid, name, true, ts); }
+   void Exit(const unsigned long long ts);
+
+   void LogSummary() const;
+   bool SaveFoldedStacks(const string& path) const;
+
+   static string GetEventName(const DISPID dispid); // e.g. "HitEvents:Hit"
+
+private:
+   constexpr static unsigned int N_BUCKETS = 16; // Call length histogram: [0,2us[, [2us,4us[, ... [16.4ms,32.8ms[, 32.8ms and above
+
+   struct Node
+   {
+      string m_label; // Name of the script handler, e.g. "Bumper1_Hit"
+      unsigned int m_parent = 0;
+      unsigned int m_callCount = 0;
+      unsigned long long m_totalLength = 0; // including the events fired by the handler
+      unsigned long long m_selfLength = 0;
+      unsigned int m_maxLength = 0;
+      unsigned int m_histogram[N_BUCKETS] = {};
+   };
+   struct ChildKey
+   {
+      unsigned int m_parent;
+      DISPID m_dispid;
+      const void* m_name;
+      bool operator==(const ChildKey& other) const { return m_parent == other.m_parent && m_dispid == other.m_dispid && m_name == other.m_name; }
+   };
+   struct ChildKeyHash
+   {
+      size_t operator()(const ChildKey& key) const { return std::hash<const void*>()(key.m_name) ^ ((size_t)key.m_dispid * 0x9E3779B9u) ^ ((size_t)key.m_parent << 20); }
+   };
+   struct Call
+   {
+      unsigned int m_node;
+      unsigned int m_repeat; // nested calls of the same handler (e.g. the player firing a timer, then the timer firing its event)
+      unsigned long long m_start;
+      unsigned long long m_childLength;
+   };
+
+   void Enter(const DISPID dispid, const void* const name, const bool wide, const unsigned long long ts);
+   string GetPath(unsigned int node) const;
+
+   bool m_enabled = false;
+   vector<Node> m_nodes; // call tree, the first node being the root (not a handler)
+   robin_hood::unordered_map<ChildKey, unsigned int, ChildKeyHash> m_children;
+   vector<Call> m_stack;
+};
+
+
 class FrameProfiler
 {
 public:
@@ -33,6 +97,7 @@ public:
       PROFILE_GPU_SUBMIT,  // Time spent to submit the render frame to the GPU
       PROFILE_GPU_FLIP,    // Time spent flipping the swap chain (flush the GPU render queue)
       PROFILE_SLEEP,       // Time spent sleeping per frame (for synchronization)
+      PROFILE_AUDIO,       // Time spent in sound play/stop requests on the game thread
       PROFILE_CUSTOM1,     // Use in conjunction with PROFILE_FUNCTION to perform custom profiling of sub sections of frames
       PROFILE_CUSTOM2,     // Use in conjunction with PROFILE_FUNCTION to perform custom profiling of sub sections of frames
       PROFILE_CUSTOM3,     // Use in conjunction with PROFILE_FUNCTION to perform custom profiling of sub sections of frames
@@ -41,6 +106,10 @@ public:
       PROFILE_INPUT_POLL_PERIOD, // Time spent between 2 input processings.
       PROFILE_INPUT_TO_PRESENT,  // Time spent between the last input taen in account in a frame to the presentation of this frame
                                  // The overall game lag is the sum of this lag with the present to display lag obtained using PresentMon tool
+      PROFILE_AUDIO_PLAYS,       // Number of sound play requests during the frame
+      PROFILE_AUDIO_VOICES,      // Number of active software mixer voices at the end of the frame
+      PROFILE_AUDIO_STEALS,      // Number of software mixer voices stolen during the frame
+      PROFILE_AUDIO_LATENCY,     // Time between a sound play request and the output of its first samples (worst of each frame with played sounds)
       PROFILE_COUNT
    };
 
@@ -52,6 +121,8 @@ public:
       m_processInputTimeStamp = 0;
       m_prepareCount = 0;
       m_prepareTimeStamp = 0;
+      m_soundLatencyCount = 0;
+      m_soundLatencyPrev = 0;
       for (int i = 0; i < N_SAMPLES; i++)
          memset(m_profileData[i], 0, sizeof(m_profileData[0]));
       for (int i = 0; i < PROFILE_COUNT; i++)
@@ -85,6 +156,7 @@ public:
          "Submit Frame:  ", 
          "GPU Flip:      ", 
          "Sleep:         ", 
+         "Audio:         ", 
          "Custom 1:      ", 
          "Custom 2:      ", 
          "Custom 3:      " };
@@ -110,31 +182,7 @@ public:
                         ss.clear();
                         ss << "    . " << std::setw(4) << std::fixed << std::setprecision(1) << (v.second.totalLength * 1e-3) << "ms";
                      }
-                     string name;
-                     switch (v.first)
-                     {
-                     case 1000: name = "GameEvents:KeyDown"; break;
-                     case 1001: name = "GameEvents:KeyUp"; break;
-                     case 1002: name = "GameEvents:Init"; break;
-                     case 1003: name = "GameEvents:MusicDone"; break;
-                     case 1004: name = "GameEvents:Exit"; break;
-                     case 1005: name = "GameEvents:Paused"; break;
-                     case 1006: name = "GameEvents:UnPaused"; break;
-                     case 1007: name = "GameEvents:OptionEvent"; break;
-                     case 1101: name = "SurfaceEvents:Slingshot"; break;
-                     case 1200: name = "FlipperEvents:Collide"; break;
-                     case 1300: name = "TimerEvents:Timer"; break;
-                     case 1301: name = "SpinnerEvents:Spin"; break;
-                     case 1302: name = "TargetEvents:Dropped"; break;
-                     case 1303: name = "TargetEvents:Raised"; break;
-                     case 1320: name = "LightSeqEvents:PlayDone"; break;
-                     case 1400: name = "HitEvents:Hit"; break;
-                     case 1401: name = "HitEvents:Unhit"; break;
-                     case 1402: name = "LimitEvents:EOS"; break;
-                     case 1403: name = "LimitEvents:BOS"; break;
-                     case 1404: name = "AnimateEvents:Animate"; break;
-                     default: name = "DispID["s + std::to_string(v.first) + "]";
-                     }
+                     const string name = ScriptEventProfiler::GetEventName(v.first);
                      ss << " spent in " << std::setw(3) << v.second.callCount << " calls of " << name;
                      if (v.first == 1300)
                      {
@@ -168,7 +216,13 @@ public:
                }
                PLOGI << ss.str();
             }
+         if (m_profileWorstData[i][PROFILE_AUDIO_PLAYS] > 0 || m_profileWorstData[i][PROFILE_AUDIO_STEALS] > 0)
+            PLOGI << "  . Sounds:        " << std::setw(4) << m_profileWorstData[i][PROFILE_AUDIO_PLAYS] << " plays, " << m_profileWorstData[i][PROFILE_AUDIO_VOICES] << " active voices, "
+                  << m_profileWorstData[i][PROFILE_AUDIO_STEALS] << " stolen voices";
       }
+      if (m_soundLatencyCount > 0)
+         PLOGI << "Sound play to output latency: " << std::fixed << std::setprecision(1) << (GetMin(PROFILE_AUDIO_LATENCY) * 1e-3) << "ms min, "
+               << (GetAvg(PROFILE_AUDIO_LATENCY) * 1e-3) << "ms average, " << (GetMax(PROFILE_AUDIO_LATENCY) * 1e-3) << "ms max";
    }
 
    void NewFrame(U32 gametime)
@@ -204,6 +258,8 @@ public:
          }
          for (int i = 0; i < PROFILE_COUNT; i++)
          {
+            if (i == PROFILE_AUDIO_LATENCY) // Event based, aggregated in OnSoundLatency
+               continue;
             unsigned int data = m_profileData[m_profileIndex][i];
             m_profileMinData[i] = min(m_profileMinData[i], data);
             m_profileMaxData[i] = max(m_profileMaxData[i], data);
@@ -219,6 +275,19 @@ public:
       m_frameTimeStamp = m_profileTimeStamp;
    }
 
+   // Per frame counters (not timings)
+   void IncrementCounter(ProfileSection section, unsigned int count = 1)
+   {
+      assert(PROFILE_AUDIO_PLAYS <= section && section < PROFILE_AUDIO_LATENCY);
+      m_profileData[m_profileIndex][section] += count;
+   }
+
+   void SetCounter(ProfileSection section, unsigned int value)
+   {
+      assert(PROFILE_AUDIO_PLAYS <= section && section < PROFILE_AUDIO_LATENCY);
+      m_profileData[m_profileIndex][section] = value;
+   }
+
    void SetProfileSection(ProfileSection section)
    {
       assert(0 <= section && section < PROFILE_COUNT);
@@ -244,10 +313,18 @@ public:
       SetProfileSection(m_profileSectionStack[m_profileSectionStackPos]);
    }
 
+   void EnterScriptSection(DISPID id, const WCHAR* object_name)
+   {
+      EnterProfileSection(PROFILE_SCRIPT);
+      m_scriptEventDispID = id;
+      m_scriptEventProfiler.Enter(id, object_name, m_profileTimeStamp);
+   }
+
    void EnterScriptSection(DISPID id, const char* timer_name = nullptr)
    {
       EnterProfileSection(PROFILE_SCRIPT);
       m_scriptEventDispID = id;
+      m_scriptEventProfiler.Enter(id, timer_name, m_profileTimeStamp);
       // For the time being, just store a list of the timer called during the script profile section
       if (timer_name)
       {
@@ -270,6 +347,7 @@ public:
    {
       unsigned long long profileTimeStamp = m_profileTimeStamp;
       ExitProfileSection();
+      m_scriptEventProfiler.Exit(m_profileTimeStamp);
       EventTick& et = m_scriptEventData[m_scriptEventDispID];
       et.totalLength += (unsigned int)(m_profileTimeStamp - profileTimeStamp);
       if (m_profileSection != PROFILE_SCRIPT)
@@ -281,11 +359,14 @@ public:
       }
    }
 
+   ScriptEventProfiler& GetScriptEventProfiler() { return m_scriptEventProfiler; }
+
    unsigned int Get(ProfileSection section) const
    {
       assert(0 <= section && section < PROFILE_COUNT);
       return section == PROFILE_INPUT_POLL_PERIOD ? m_profileData[m_processInputIndex][PROFILE_INPUT_POLL_PERIOD]
            : section == PROFILE_INPUT_TO_PRESENT  ? m_profileData[m_prepareIndex][PROFILE_INPUT_TO_PRESENT]
+           : section == PROFILE_AUDIO_LATENCY     ? m_soundLatencyPrev
                                                   : m_profileData[m_profileIndex][section];
    }
    
@@ -294,6 +375,7 @@ public:
       assert(0 <= section && section < PROFILE_COUNT);
       return section == PROFILE_INPUT_POLL_PERIOD ? m_profileData[(m_processInputIndex + N_SAMPLES - 1) % N_SAMPLES][PROFILE_INPUT_POLL_PERIOD]
            : section == PROFILE_INPUT_TO_PRESENT  ? m_profileData[(m_prepareIndex + N_SAMPLES - 1) % N_SAMPLES][PROFILE_INPUT_TO_PRESENT]
+           : section == PROFILE_AUDIO_LATENCY     ? m_soundLatencyPrev
                                                   : m_profileData[(m_profileIndex + N_SAMPLES - 1) % N_SAMPLES][section];
    }
    
@@ -314,6 +396,7 @@ public:
       assert(0 <= section && section < PROFILE_COUNT);
       return section == PROFILE_INPUT_POLL_PERIOD ? (m_processInputCount <= 0 ? 0. : ((double)m_profileTotalData[PROFILE_INPUT_POLL_PERIOD] / (double)m_processInputCount))
            : section == PROFILE_INPUT_TO_PRESENT  ? (m_prepareCount <= 0      ? 0. : ((double)m_profileTotalData[PROFILE_INPUT_TO_PRESENT] / (double)m_prepareCount))
+           : section == PROFILE_AUDIO_LATENCY     ? (m_soundLatencyCount <= 0 ? 0. : ((double)m_profileTotalData[PROFILE_AUDIO_LATENCY] / (double)m_soundLatencyCount))
                                                   : (m_frameIndex <= 0        ? 0. : ((double)m_profileTotalData[section] / (double)m_frameIndex));
    }
    
@@ -404,6 +487,15 @@ public:
       m_prepareCount++;
    }
 
+   void OnSoundLatency(unsigned int latency)
+   {
+      m_soundLatencyPrev = latency;
+      m_profileMinData[PROFILE_AUDIO_LATENCY] = min(m_profileMinData[PROFILE_AUDIO_LATENCY], latency);
+      m_profileMaxData[PROFILE_AUDIO_LATENCY] = max(m_profileMaxData[PROFILE_AUDIO_LATENCY], latency);
+      m_profileTotalData[PROFILE_AUDIO_LATENCY] += latency;
+      m_soundLatencyCount++;
+   }
+
 private:
    constexpr static unsigned int N_SAMPLES = 1000; // Number of samples to store. Must be kept quite high to be able to do a 1s sliding average (so at 1000FPS, needs 100 samples)
    constexpr static unsigned int N_WORST = 10; // Number of longest frames to keep detailed profile timing
@@ -425,6 +517,7 @@ private:
    };
    DISPID m_scriptEventDispID = 0;
    robin_hood::unordered_map<DISPID, EventTick> m_scriptEventData;
+   ScriptEventProfiler m_scriptEventProfiler;
 
    // Overall frame
    unsigned int m_frameIndex = -1;
@@ -440,6 +533,10 @@ private:
    unsigned int m_prepareCount = 0;
    unsigned long long m_prepareTimeStamp;
 
+   // Sound play to output latency
+   unsigned int m_soundLatencyCount = 0;
+   unsigned int m_soundLatencyPrev = 0;
+
    // Raw data
    unsigned int m_profileData[N_SAMPLES][PROFILE_COUNT];
    unsigned int m_profileMaxData[PROFILE_COUNT];